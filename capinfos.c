@@ -70,7 +70,9 @@
 #include <glib.h>
 
 #include <wiretap/wtap.h>
+#include <wiretap/libpcap.h>
 
+#include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/crash_info.h>
 #include <wsutil/filesystem.h>
@@ -159,6 +161,19 @@ static gboolean cap_order          = TRUE;  /* Report if packets are in chronolo
 
 static gboolean cap_file_hashes    = TRUE;  /* Calculate file hashes */
 
+/*
+ * Take the capture start and end times from the first and last records
+ * rather than from the earliest and latest time stamps in the file, so
+ * that they can be had without reading the whole file.
+ */
+static gboolean fast_times         = FALSE;
+
+/*
+ * Number of files to process concurrently; the infos are still reported
+ * in the order in which the files were given.
+ */
+static int      num_jobs           = 1;
+
 #define HASH_SIZE_SHA1   20
 #define HASH_SIZE_RMD160 20
 #define HASH_SIZE_MD5    16
@@ -166,11 +181,6 @@ static gboolean cap_file_hashes    = TRUE;  /* Calculate file hashes */
 #define HASH_STR_SIZE (41) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
-
-static gchar file_sha1[HASH_STR_SIZE];
-static gchar file_rmd160[HASH_STR_SIZE];
-static gchar file_md5[HASH_STR_SIZE];
-
 /*
  * If we have at least two packets with time stamps, and they're not in
  * order - i.e., the later packet has a time stamp older than the earlier
@@ -189,6 +199,7 @@ typedef enum {
 
 typedef struct _capture_info {
   const char    *filename;
+  wtap          *wth;                    /* kept open until the infos have been reported */
   guint16        file_type;
   gboolean       iscompressed;
   int            file_encap;
@@ -223,10 +234,64 @@ typedef struct _capture_info {
   GArray        *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
   guint32        pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
   GArray        *idb_info_strings;       /* array of IDB info strings */
+
+  gchar          file_sha1[HASH_STR_SIZE];
+  gchar          file_rmd160[HASH_STR_SIZE];
+  gchar          file_md5[HASH_STR_SIZE];
+
+  GString       *errors;                 /* with -j, messages kept until the file is reported */
 } capture_info;
 
 static char *decimal_point;
 
+/*
+ * With -j, the capture_info of the file a worker thread is scanning, so
+ * that its error messages are kept with the file's infos and printed in
+ * order by report_cap_file() instead of going straight to stderr.
+ */
+#if GLIB_CHECK_VERSION(2,31,0)
+static GPrivate scanning_file = G_PRIVATE_INIT(NULL);
+#else
+static GPrivate *scanning_file = NULL;
+#endif
+
+static capture_info *
+scanning_file_info(void)
+{
+#if GLIB_CHECK_VERSION(2,31,0)
+  return (capture_info *)g_private_get(&scanning_file);
+#else
+  return scanning_file ? (capture_info *)g_private_get(scanning_file) : NULL;
+#endif
+}
+
+static void
+error_message_va(const char *msg_format, va_list ap)
+{
+  capture_info *cf_info = scanning_file_info();
+
+  if (cf_info) {
+    if (!cf_info->errors)
+      cf_info->errors = g_string_new("");
+    g_string_append_vprintf(cf_info->errors, msg_format, ap);
+  } else {
+    vfprintf(stderr, msg_format, ap);
+  }
+}
+
+static void
+error_message(const char *msg_format, ...) G_GNUC_PRINTF(1, 2);
+
+static void
+error_message(const char *msg_format, ...)
+{
+  va_list ap;
+
+  va_start(ap, msg_format);
+  error_message_va(msg_format, ap);
+  va_end(ap);
+}
+
 static void
 enable_all_infos(void)
 {
@@ -619,7 +684,7 @@ print_stats(const gchar *filename, capture_info *cf_info)
     printf     ("Packet size limit:   file hdr: %u bytes\n", cf_info->snaplen);
   else if (cap_snaplen && !cf_info->snap_set)
     printf     ("Packet size limit:   file hdr: (not set)\n");
-  if (cf_info->snaplen_max_inferred > 0) {
+  if (cap_snaplen && cf_info->snaplen_max_inferred > 0) {
     if (cf_info->snaplen_min_inferred == cf_info->snaplen_max_inferred)
       printf     ("Packet size limit:   inferred: %u bytes\n", cf_info->snaplen_min_inferred);
     else
@@ -698,9 +763,9 @@ print_stats(const gchar *filename, capture_info *cf_info)
     }
   }
   if (cap_file_hashes) {
-    printf     ("SHA1:                %s\n", file_sha1);
-    printf     ("RIPEMD160:           %s\n", file_rmd160);
-    printf     ("MD5:                 %s\n", file_md5);
+    printf     ("SHA1:                %s\n", cf_info->file_sha1);
+    printf     ("RIPEMD160:           %s\n", cf_info->file_rmd160);
+    printf     ("MD5:                 %s\n", cf_info->file_md5);
   }
   if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -954,17 +1019,17 @@ print_stats_table(const gchar *filename, capture_info *cf_info)
   if (cap_file_hashes) {
     putsep();
     putquote();
-    printf("%s", file_sha1);
+    printf("%s", cf_info->file_sha1);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_rmd160);
+    printf("%s", cf_info->file_rmd160);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_md5);
+    printf("%s", cf_info->file_md5);
     putquote();
   }
 
@@ -1059,12 +1124,215 @@ cleanup_capture_info(capture_info *cf_info)
   cf_info->idb_info_strings = NULL;
 }
 
+/*
+ * Returns TRUE if the infos to be reported can only be had by reading
+ * every record of the file.
+ */
+static gboolean
+need_all_records(wtap *wth)
+{
+  if (cap_snaplen || cap_packet_count || cap_file_idb || cap_data_size ||
+      cap_order || cap_data_rate_byte || cap_data_rate_bit ||
+      cap_packet_size || cap_packet_rate)
+    return TRUE;
+
+  if (cap_file_encap && wtap_file_encap(wth) == WTAP_ENCAP_PER_PACKET)
+    return TRUE;
+
+  if (cap_start_time || cap_end_time || cap_duration) {
+    if (!fast_times)
+      return TRUE;
+
+    /*
+     * The last record can only be found without reading the ones
+     * before it in uncompressed libpcap files.
+     */
+    if (cap_end_time || cap_duration) {
+      switch (wtap_file_type_subtype(wth)) {
+
+        case WTAP_FILE_TYPE_SUBTYPE_PCAP:
+        case WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC:
+          break;
+
+        default:
+          return TRUE;
+      }
+      if (wtap_iscompressed(wth))
+        return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+#define TAIL_SCAN_WINDOW      (64 * 1024)
+#define TAIL_SCAN_MAX_WINDOW  (16 * 1024 * 1024)
+#define TAIL_SCAN_MIN_RECORDS 4
+
+typedef struct {
+  gboolean  byte_swapped;
+  guint32   frac_limit;   /* 1000000 for microseconds, 1000000000 for nanoseconds */
+  guint32   min_secs;     /* earliest plausible time stamp */
+} pcap_scan_t;
+
+static inline guint32
+pcap_scan_get32(const pcap_scan_t *ps, const guint8 *p)
+{
+  guint32 val;
+
+  memcpy(&val, p, sizeof val);
+  return ps->byte_swapped ? GUINT32_SWAP_LE_BE(val) : val;
+}
+
+/*
+ * Follow the chain of record headers starting at offset off of buf, which
+ * holds the last len bytes of the file. Returns the offset in buf of the
+ * last record of the chain if every header in it is plausible and it ends
+ * exactly at the end of the file, -1 otherwise.
+ */
+static gint64
+pcap_scan_chain(const pcap_scan_t *ps, const guint8 *buf, gint64 len,
+                gint64 off, gboolean at_first_record)
+{
+  gint64  last = -1;
+  guint   records = 0;
+  guint32 ts_sec, ts_frac, incl_len, orig_len;
+
+  while (off + (gint64)sizeof(struct pcaprec_hdr) <= len) {
+    ts_sec   = pcap_scan_get32(ps, buf + off);
+    ts_frac  = pcap_scan_get32(ps, buf + off + 4);
+    incl_len = pcap_scan_get32(ps, buf + off + 8);
+    orig_len = pcap_scan_get32(ps, buf + off + 12);
+    if (ts_sec < ps->min_secs || ts_frac >= ps->frac_limit ||
+        incl_len > WTAP_MAX_PACKET_SIZE_STANDARD || incl_len > orig_len)
+      return -1;
+    last = off;
+    records++;
+    off += sizeof(struct pcaprec_hdr) + incl_len;
+  }
+
+  if (off != len || last < 0)
+    return -1;
+  if (records < TAIL_SCAN_MIN_RECORDS && !at_first_record)
+    return -1;
+  return last;
+}
+
+/*
+ * Get the time stamps of the first and last records of an uncompressed
+ * libpcap file without reading the records in between. The last record
+ * is found by looking, in a window at the end of the file that grows
+ * until one is found, for a chain of plausible record headers that ends
+ * exactly at the end of the file.
+ *
+ * The file must have been opened for random access. Returns FALSE if the
+ * last record couldn't be found, in which case the whole file has to be
+ * read.
+ */
+static gboolean
+pcap_get_first_last_times(wtap *wth, const char *filename,
+                          struct wtap_pkthdr *first, struct wtap_pkthdr *last)
+{
+  struct pcap_hdr file_hdr;
+  pcap_scan_t     ps;
+  Buffer          buf;
+  guint8         *window = NULL;
+  gint64          size, start, len, off, found = -1;
+  gint64          window_size;
+  ssize_t         bytes_read;
+  int             fd;
+  int             err;
+  gchar          *err_info;
+  gboolean        ret = FALSE;
+
+  size = wtap_file_size(wth, &err);
+  if (size <= (gint64)(sizeof file_hdr + sizeof(struct pcaprec_hdr)))
+    return FALSE;
+
+  fd = ws_open(filename, O_RDONLY|O_BINARY, 0000 /* no creation so don't matter */);
+  if (fd == -1)
+    return FALSE;
+  if (ws_read(fd, &file_hdr, sizeof file_hdr) != (ssize_t)sizeof file_hdr)
+    goto done;
+
+  switch (file_hdr.magic) {
+
+    case PCAP_MAGIC:
+    case PCAP_NSEC_MAGIC:
+      ps.byte_swapped = FALSE;
+      break;
+
+    case PCAP_SWAPPED_MAGIC:
+    case PCAP_SWAPPED_NSEC_MAGIC:
+      ps.byte_swapped = TRUE;
+      break;
+
+    default:
+      goto done;
+  }
+  if (file_hdr.magic == PCAP_NSEC_MAGIC || file_hdr.magic == PCAP_SWAPPED_NSEC_MAGIC)
+    ps.frac_limit = 1000000000;
+  else
+    ps.frac_limit = 1000000;
+
+  ws_buffer_init(&buf, 1500);
+  if (!wtap_seek_read(wth, sizeof file_hdr, first, &buf, &err, &err_info)) {
+    g_free(err_info);
+    ws_buffer_free(&buf);
+    goto done;
+  }
+
+  /* Allow for time stamps going backwards a little. */
+  ps.min_secs = first->ts.secs > 86400 ? (guint32)(first->ts.secs - 86400) : 0;
+
+  for (window_size = TAIL_SCAN_WINDOW; ; window_size *= 2) {
+    start = MAX((gint64)sizeof file_hdr, size - window_size);
+    len = size - start;
+    window = (guint8 *)g_realloc(window, (gsize)len);
+    if (ws_lseek64(fd, start, SEEK_SET) != start)
+      break;
+    for (off = 0; off < len; off += bytes_read) {
+      bytes_read = ws_read(fd, window + off, (unsigned int)(len - off));
+      if (bytes_read <= 0)
+        break;
+    }
+    if (off != len)
+      break;
+
+    for (off = 0; off < len && found < 0; off++) {
+      found = pcap_scan_chain(&ps, window, len, off,
+                              start + off == (gint64)sizeof file_hdr);
+    }
+    if (found >= 0 || start == (gint64)sizeof file_hdr ||
+        window_size >= TAIL_SCAN_MAX_WINDOW)
+      break;
+  }
+
+  if (found >= 0) {
+    if (wtap_seek_read(wth, start + found, last, &buf, &err, &err_info))
+      ret = TRUE;
+    else
+      g_free(err_info);
+  }
+  ws_buffer_free(&buf);
+
+done:
+  g_free(window);
+  ws_close(fd);
+  return ret;
+}
+
+/*
+ * Read through the file, filling in cf_info. Returns 0 if the whole file
+ * could be read, 1 otherwise; cf_info->wth is set to NULL if there is
+ * nothing to report.
+ */
 static int
-process_cap_file(wtap *wth, const char *filename)
+process_cap_file(wtap *wth, const char *filename, capture_info *cf_info)
 {
   int                   status = 0;
-  int                   err;
-  gchar                *err_info;
+  int                   err = 0;
+  gchar                *err_info = NULL;
   gint64                size;
   gint64                data_offset;
 
@@ -1073,7 +1341,6 @@ process_cap_file(wtap *wth, const char *filename)
   guint32               snaplen_min_inferred = 0xffffffff;
   guint32               snaplen_max_inferred =          0;
   const struct wtap_pkthdr *phdr;
-  capture_info          cf_info;
   gboolean              have_times = TRUE;
   nstime_t              start_time;
   int                   start_time_tsprec;
@@ -1083,6 +1350,7 @@ process_cap_file(wtap *wth, const char *filename)
   nstime_t              prev_time;
   gboolean              know_order = FALSE;
   order_t               order = IN_ORDER;
+  gboolean              read_all = TRUE;
   guint                 i;
   wtapng_iface_descriptions_t *idb_info;
 
@@ -1096,24 +1364,63 @@ process_cap_file(wtap *wth, const char *filename)
   nstime_set_zero(&cur_time);
   nstime_set_zero(&prev_time);
 
-  cf_info.shb = wtap_file_get_shb(wth);
+  cf_info->filename = filename;
+  cf_info->wth = wth;
+  cf_info->shb = wtap_file_get_shb(wth);
 
-  cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+  cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
   idb_info = wtap_file_get_idb_info(wth);
 
   g_assert(idb_info->interface_data != NULL);
 
-  cf_info.num_interfaces = idb_info->interface_data->len;
-  cf_info.interface_packet_counts  = g_array_sized_new(FALSE, TRUE, sizeof(guint32), cf_info.num_interfaces);
-  g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-  cf_info.pkt_interface_id_unknown = 0;
+  cf_info->num_interfaces = idb_info->interface_data->len;
+  cf_info->interface_packet_counts  = g_array_sized_new(FALSE, TRUE, sizeof(guint32), cf_info->num_interfaces);
+  g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+  cf_info->pkt_interface_id_unknown = 0;
 
   g_free(idb_info);
   idb_info = NULL;
 
+  /*
+   * If none of the infos to be reported need it, don't read through the
+   * whole file; at most the first and last records are looked at.
+   */
+  if (!need_all_records(wth)) {
+    if (cap_end_time || cap_duration) {
+      struct wtap_pkthdr first, last;
+
+      wtap_phdr_init(&first);
+      wtap_phdr_init(&last);
+      if (pcap_get_first_last_times(wth, filename, &first, &last)) {
+        start_time = first.ts;
+        start_time_tsprec = first.pkt_tsprec;
+        stop_time = last.ts;
+        stop_time_tsprec = last.pkt_tsprec;
+        packet = 2;
+        read_all = FALSE;
+      }
+      wtap_phdr_cleanup(&first);
+      wtap_phdr_cleanup(&last);
+    } else {
+      if (cap_start_time && wtap_read(wth, &err, &err_info, &data_offset)) {
+        phdr = wtap_phdr(wth);
+        if (phdr->presence_flags & WTAP_HAS_TS) {
+          start_time = phdr->ts;
+          start_time_tsprec = phdr->pkt_tsprec;
+          stop_time = phdr->ts;
+          stop_time_tsprec = phdr->pkt_tsprec;
+        } else {
+          have_times = FALSE;
+        }
+        packet = 1;
+      }
+      read_all = FALSE;
+    }
+  }
+
   /* Tally up data that we need to parse through the file to find */
-  while (wtap_read(wth, &err, &err_info, &data_offset))  {
+  while (read_all && wtap_read(wth, &err, &err_info, &data_offset))  {
     phdr = wtap_phdr(wth);
     if (phdr->presence_flags & WTAP_HAS_TS) {
       prev_time = cur_time;
@@ -1128,13 +1435,20 @@ process_cap_file(wtap *wth, const char *filename)
       if (nstime_cmp(&cur_time, &prev_time) < 0) {
         order = NOT_IN_ORDER;
       }
-      if (nstime_cmp(&cur_time, &start_time) < 0) {
-        start_time = cur_time;
-        start_time_tsprec = phdr->pkt_tsprec;
-      }
-      if (nstime_cmp(&cur_time, &stop_time) > 0) {
+      if (fast_times) {
+        /* -f: the times of the first and last packets, as when the
+           file isn't read in full */
         stop_time = cur_time;
         stop_time_tsprec = phdr->pkt_tsprec;
+      } else {
+        if (nstime_cmp(&cur_time, &start_time) < 0) {
+          start_time = cur_time;
+          start_time_tsprec = phdr->pkt_tsprec;
+        }
+        if (nstime_cmp(&cur_time, &stop_time) > 0) {
+          stop_time = cur_time;
+          stop_time_tsprec = phdr->pkt_tsprec;
+        }
       }
     } else {
       have_times = FALSE; /* at least one packet has no time stamp */
@@ -1158,16 +1472,16 @@ process_cap_file(wtap *wth, const char *filename)
       }
 
       if ((phdr->pkt_encap > 0) && (phdr->pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-        cf_info.encap_counts[phdr->pkt_encap] += 1;
+        cf_info->encap_counts[phdr->pkt_encap] += 1;
       } else {
-        fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
-                phdr->pkt_encap, packet, filename);
+        error_message("capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
+                      phdr->pkt_encap, packet, filename);
       }
 
       /* Packet interface_id info */
       if (phdr->presence_flags & WTAP_HAS_INTERFACE_ID) {
-        /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-        if (phdr->interface_id >= cf_info.num_interfaces) {
+        /* cf_info->num_interfaces is size, not index, so it's one more than max index */
+        if (phdr->interface_id >= cf_info->num_interfaces) {
           /*
            * OK, re-fetch the number of interfaces, as there might have
            * been an interface that was in the middle of packets, and
@@ -1176,26 +1490,26 @@ process_cap_file(wtap *wth, const char *filename)
            */
           idb_info = wtap_file_get_idb_info(wth);
 
-          cf_info.num_interfaces = idb_info->interface_data->len;
-          g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+          cf_info->num_interfaces = idb_info->interface_data->len;
+          g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
 
           g_free(idb_info);
           idb_info = NULL;
         }
-        if (phdr->interface_id < cf_info.num_interfaces) {
-          g_array_index(cf_info.interface_packet_counts, guint32, phdr->interface_id) += 1;
+        if (phdr->interface_id < cf_info->num_interfaces) {
+          g_array_index(cf_info->interface_packet_counts, guint32, phdr->interface_id) += 1;
         }
         else {
-          cf_info.pkt_interface_id_unknown += 1;
+          cf_info->pkt_interface_id_unknown += 1;
         }
       }
       else {
         /* it's for interface_id 0 */
-        if (cf_info.num_interfaces != 0) {
-          g_array_index(cf_info.interface_packet_counts, guint32, 0) += 1;
+        if (cf_info->num_interfaces != 0) {
+          g_array_index(cf_info->interface_packet_counts, guint32, 0) += 1;
         }
         else {
-          cf_info.pkt_interface_id_unknown += 1;
+          cf_info->pkt_interface_id_unknown += 1;
         }
       }
     }
@@ -1209,29 +1523,30 @@ process_cap_file(wtap *wth, const char *filename)
    */
   idb_info = wtap_file_get_idb_info(wth);
 
-  cf_info.idb_info_strings = g_array_sized_new(FALSE, FALSE, sizeof(gchar*), cf_info.num_interfaces);
-  cf_info.num_interfaces = idb_info->interface_data->len;
-  for (i = 0; i < cf_info.num_interfaces; i++) {
+  cf_info->idb_info_strings = g_array_sized_new(FALSE, FALSE, sizeof(gchar*), cf_info->num_interfaces);
+  cf_info->num_interfaces = idb_info->interface_data->len;
+  for (i = 0; i < cf_info->num_interfaces; i++) {
     const wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
     gchar *s = wtap_get_debug_if_descr(if_descr, 21, "\n");
-    g_array_append_val(cf_info.idb_info_strings, s);
+    g_array_append_val(cf_info->idb_info_strings, s);
   }
 
   g_free(idb_info);
   idb_info = NULL;
 
   if (err != 0) {
-    fprintf(stderr,
+    error_message(
         "capinfos: An error occurred after reading %u packets from \"%s\".\n",
         packet, filename);
     cfile_read_failure_message("capinfos", filename, err, err_info);
     if (err == WTAP_ERR_SHORT_READ) {
         /* Don't give up completely with this one. */
         status = 1;
-        fprintf(stderr,
+        error_message(
           "  (will continue anyway, checksums might be incorrect)\n");
     } else {
-        cleanup_capture_info(&cf_info);
+        cleanup_capture_info(cf_info);
+        cf_info->wth = NULL;
         return 1;
     }
   }
@@ -1239,76 +1554,69 @@ process_cap_file(wtap *wth, const char *filename)
   /* File size */
   size = wtap_file_size(wth, &err);
   if (size == -1) {
-    fprintf(stderr,
+    error_message(
         "capinfos: Can't get size of \"%s\": %s.\n",
         filename, g_strerror(err));
-    cleanup_capture_info(&cf_info);
+    cleanup_capture_info(cf_info);
+    cf_info->wth = NULL;
     return 1;
   }
 
-  cf_info.filesize = size;
+  cf_info->filesize = size;
 
   /* File Type */
-  cf_info.file_type = wtap_file_type_subtype(wth);
-  cf_info.iscompressed = wtap_iscompressed(wth);
+  cf_info->file_type = wtap_file_type_subtype(wth);
+  cf_info->iscompressed = wtap_iscompressed(wth);
 
   /* File Encapsulation */
-  cf_info.file_encap = wtap_file_encap(wth);
+  cf_info->file_encap = wtap_file_encap(wth);
 
-  cf_info.file_tsprec = wtap_file_tsprec(wth);
+  cf_info->file_tsprec = wtap_file_tsprec(wth);
 
   /* Packet size limit (snaplen) */
-  cf_info.snaplen = wtap_snapshot_length(wth);
-  if (cf_info.snaplen > 0)
-    cf_info.snap_set = TRUE;
+  cf_info->snaplen = wtap_snapshot_length(wth);
+  if (cf_info->snaplen > 0)
+    cf_info->snap_set = TRUE;
   else
-    cf_info.snap_set = FALSE;
+    cf_info->snap_set = FALSE;
 
-  cf_info.snaplen_min_inferred = snaplen_min_inferred;
-  cf_info.snaplen_max_inferred = snaplen_max_inferred;
+  cf_info->snaplen_min_inferred = snaplen_min_inferred;
+  cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
   /* # of packets */
-  cf_info.packet_count = packet;
+  cf_info->packet_count = packet;
 
   /* File Times */
-  cf_info.times_known = have_times;
-  cf_info.start_time = start_time;
-  cf_info.start_time_tsprec = start_time_tsprec;
-  cf_info.stop_time = stop_time;
-  cf_info.stop_time_tsprec = stop_time_tsprec;
-  nstime_delta(&cf_info.duration, &stop_time, &start_time);
+  cf_info->times_known = have_times;
+  cf_info->start_time = start_time;
+  cf_info->start_time_tsprec = start_time_tsprec;
+  cf_info->stop_time = stop_time;
+  cf_info->stop_time_tsprec = stop_time_tsprec;
+  nstime_delta(&cf_info->duration, &stop_time, &start_time);
   /* Duration precision is the higher of the start and stop time precisions. */
-  if (cf_info.stop_time_tsprec > cf_info.start_time_tsprec)
-    cf_info.duration_tsprec = cf_info.stop_time_tsprec;
+  if (cf_info->stop_time_tsprec > cf_info->start_time_tsprec)
+    cf_info->duration_tsprec = cf_info->stop_time_tsprec;
   else
-    cf_info.duration_tsprec = cf_info.start_time_tsprec;
-  cf_info.know_order = know_order;
-  cf_info.order = order;
+    cf_info->duration_tsprec = cf_info->start_time_tsprec;
+  cf_info->know_order = know_order;
+  cf_info->order = order;
 
   /* Number of packet bytes */
-  cf_info.packet_bytes = bytes;
+  cf_info->packet_bytes = bytes;
 
-  cf_info.data_rate   = 0.0;
-  cf_info.packet_rate = 0.0;
-  cf_info.packet_size = 0.0;
+  cf_info->data_rate   = 0.0;
+  cf_info->packet_rate = 0.0;
+  cf_info->packet_size = 0.0;
 
   if (packet > 0) {
     double delta_time = nstime_to_sec(&stop_time) - nstime_to_sec(&start_time);
     if (delta_time > 0.0) {
-      cf_info.data_rate   = (double)bytes  / delta_time; /* Data rate per second */
-      cf_info.packet_rate = (double)packet / delta_time; /* packet rate per second */
+      cf_info->data_rate   = (double)bytes  / delta_time; /* Data rate per second */
+      cf_info->packet_rate = (double)packet / delta_time; /* packet rate per second */
     }
-    cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
   }
 
-  if (long_report) {
-    print_stats(filename, &cf_info);
-  } else {
-    print_stats_table(filename, &cf_info);
-  }
-
-  cleanup_capture_info(&cf_info);
-
   return status;
 }
 
@@ -1338,6 +1646,8 @@ print_usage(FILE *output)
   fprintf(output, "  -e display the capture end time\n");
   fprintf(output, "  -o display the capture file chronological status (True/False)\n");
   fprintf(output, "  -S display start and end times as seconds\n");
+  fprintf(output, "  -f take the start and end times from the first and last\n");
+  fprintf(output, "     packets instead of reading the whole file where possible\n");
   fprintf(output, "\n");
   fprintf(output, "Statistic infos:\n");
   fprintf(output, "  -y display average data rate (in bytes/sec)\n");
@@ -1365,6 +1675,7 @@ print_usage(FILE *output)
   fprintf(output, "Miscellaneous:\n");
   fprintf(output, "  -h display this help and exit\n");
   fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
+  fprintf(output, "  -j <jobs> process up to <jobs> files concurrently (default: 1)\n");
   fprintf(output, "  -A generate all infos (default)\n");
   fprintf(output, "  -K disable displaying the capture comment\n");
   fprintf(output, "\n");
@@ -1382,9 +1693,9 @@ print_usage(FILE *output)
 static void
 failure_warning_message(const char *msg_format, va_list ap)
 {
-  fprintf(stderr, "capinfos: ");
-  vfprintf(stderr, msg_format, ap);
-  fprintf(stderr, "\n");
+  error_message("capinfos: ");
+  error_message_va(msg_format, ap);
+  error_message("\n");
 }
 
 /*
@@ -1393,8 +1704,8 @@ failure_warning_message(const char *msg_format, va_list ap)
 static void
 failure_message_cont(const char *msg_format, va_list ap)
 {
-  vfprintf(stderr, msg_format, ap);
-  fprintf(stderr, "\n");
+  error_message_va(msg_format, ap);
+  error_message("\n");
 }
 
 static void
@@ -1406,15 +1717,286 @@ hash_to_str(const unsigned char *hash, size_t length, char *str) {
   }
 }
 
+static void
+hash_open(gcry_md_hd_t *hd, char **hash_buf)
+{
+  *hd = NULL;
+  *hash_buf = NULL;
+
+  if (!cap_file_hashes)
+    return;
+
+  gcry_md_open(hd, GCRY_MD_SHA1, 0);
+  if (*hd) {
+    gcry_md_enable(*hd, GCRY_MD_RMD160);
+    gcry_md_enable(*hd, GCRY_MD_MD5);
+  }
+  *hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
+}
+
+static void
+hash_close(gcry_md_hd_t hd, char *hash_buf)
+{
+  if (hd)
+    gcry_md_close(hd);
+  g_free(hash_buf);
+}
+
+static void
+hash_cap_file(const char *filename, gcry_md_hd_t hd, char *hash_buf, capture_info *cf_info)
+{
+  FILE  *fh;
+  size_t hash_bytes;
+
+  g_strlcpy(cf_info->file_sha1, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(cf_info->file_rmd160, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(cf_info->file_md5, "<unknown>", HASH_STR_SIZE);
+
+  if (!cap_file_hashes)
+    return;
+
+  fh = ws_fopen(filename, "rb");
+  if (fh && hd) {
+    while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
+      gcry_md_write(hd, hash_buf, hash_bytes);
+    }
+    gcry_md_final(hd);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, cf_info->file_sha1);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_RMD160), HASH_SIZE_RMD160, cf_info->file_rmd160);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_MD5), HASH_SIZE_MD5, cf_info->file_md5);
+  }
+  if (fh) fclose(fh);
+  if (hd) gcry_md_reset(hd);
+}
+
+/*
+ * Hash, open and read one file. Returns 0 on success, 1 if the file could
+ * not be read completely and 2 if it could not be opened; cf_info->wth is
+ * NULL if there is nothing to report.
+ */
+static int
+scan_cap_file(const char *filename, gcry_md_hd_t hd, char *hash_buf, capture_info *cf_info)
+{
+  wtap  *wth;
+  int    err;
+  gchar *err_info;
+  int    status;
+
+  memset(cf_info, 0, sizeof *cf_info);
+
+  hash_cap_file(filename, hd, hash_buf, cf_info);
+
+  /* The -f fast path reads the last record of libpcap files at random. */
+  wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, fast_times);
+  if (!wth) {
+    cfile_open_failure_message("capinfos", filename, err, err_info);
+    return 2;
+  }
+
+  status = process_cap_file(wth, filename, cf_info);
+  if (cf_info->wth == NULL)
+    wtap_close(wth);
+
+  return status;
+}
+
+/*
+ * Report the infos of a file scanned by scan_cap_file(); file is its index
+ * in the list of files given. Returns FALSE if no more files should be
+ * processed.
+ */
+static gboolean
+report_cap_file(int file, int status, capture_info *cf_info, int *overall_error_status)
+{
+  if (cf_info->errors) {
+    fputs(cf_info->errors->str, stderr);
+    g_string_free(cf_info->errors, TRUE);
+    cf_info->errors = NULL;
+  }
+
+  if (status == 2) {
+    *overall_error_status = 2; /* remember that an error has occurred */
+    return continue_after_wtap_open_offline_failure;
+  }
+
+  if ((file > 0) && (long_report))
+    printf("\n");
+
+  if (cf_info->wth) {
+    if (long_report) {
+      print_stats(cf_info->filename, cf_info);
+    } else {
+      print_stats_table(cf_info->filename, cf_info);
+    }
+    cleanup_capture_info(cf_info);
+    wtap_close(cf_info->wth);
+    cf_info->wth = NULL;
+  }
+
+  if (status) {
+    *overall_error_status = status;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/*
+ * With -j, worker threads take the files in turn and hash and read them,
+ * while the main thread reports on them in order as they are done. Every
+ * file read but not yet reported on is kept open, so the workers don't
+ * get more than a few files ahead of the reports.
+ */
+typedef struct {
+  capture_info  cf_info;
+  int           status;
+  gboolean      done;
+} capinfos_job_t;
+
+typedef struct {
+  char           **files;
+  int              n_files;
+  capinfos_job_t  *jobs;
+  int              next_file;    /* the next file for a worker to take */
+  int              next_report;  /* the next file to be reported on */
+  int              max_ahead;
+  gboolean         stop;
+  GMutex          *mutex;        /* protects all of the above */
+  GCond           *cond;
+} capinfos_jobs_t;
+
+static gpointer
+capinfos_worker(gpointer data)
+{
+  capinfos_jobs_t *cj = (capinfos_jobs_t *)data;
+  gcry_md_hd_t     hd;
+  char            *hash_buf;
+  int              file;
+  int              status;
+
+  hash_open(&hd, &hash_buf);
+
+  for (;;) {
+    g_mutex_lock(cj->mutex);
+    while (!cj->stop && cj->next_file < cj->n_files &&
+           cj->next_file >= cj->next_report + cj->max_ahead)
+      g_cond_wait(cj->cond, cj->mutex);
+    if (cj->stop || cj->next_file >= cj->n_files) {
+      g_mutex_unlock(cj->mutex);
+      break;
+    }
+    file = cj->next_file++;
+    g_mutex_unlock(cj->mutex);
+
+#if GLIB_CHECK_VERSION(2,31,0)
+    g_private_set(&scanning_file, &cj->jobs[file].cf_info);
+#else
+    g_private_set(scanning_file, &cj->jobs[file].cf_info);
+#endif
+    status = scan_cap_file(cj->files[file], hd, hash_buf, &cj->jobs[file].cf_info);
+#if GLIB_CHECK_VERSION(2,31,0)
+    g_private_set(&scanning_file, NULL);
+#else
+    g_private_set(scanning_file, NULL);
+#endif
+
+    g_mutex_lock(cj->mutex);
+    cj->jobs[file].status = status;
+    cj->jobs[file].done = TRUE;
+    g_cond_broadcast(cj->cond);
+    g_mutex_unlock(cj->mutex);
+  }
+
+  hash_close(hd, hash_buf);
+  return NULL;
+}
+
+static int
+process_cap_files_parallel(char **files, int n_files)
+{
+  capinfos_jobs_t cj;
+  GThread       **threads;
+  int             n_threads = MIN(num_jobs, n_files);
+  int             overall_error_status = 0;
+  gboolean        keep_going = TRUE;
+  int             file, i;
+
+  memset(&cj, 0, sizeof cj);
+  cj.files = files;
+  cj.n_files = n_files;
+  cj.jobs = g_new0(capinfos_job_t, n_files);
+  cj.max_ahead = 2 * n_threads;
+#if GLIB_CHECK_VERSION(2,31,0)
+  cj.mutex = g_new(GMutex, 1);
+  g_mutex_init(cj.mutex);
+  cj.cond = g_new(GCond, 1);
+  g_cond_init(cj.cond);
+#else
+  cj.mutex = g_mutex_new();
+  cj.cond = g_cond_new();
+  if (!scanning_file)
+    scanning_file = g_private_new(NULL);
+#endif
+
+  threads = g_new(GThread *, n_threads);
+  for (i = 0; i < n_threads; i++) {
+#if GLIB_CHECK_VERSION(2,31,0)
+    threads[i] = g_thread_new("capinfos", capinfos_worker, &cj);
+#else
+    threads[i] = g_thread_create(capinfos_worker, &cj, TRUE, NULL);
+#endif
+  }
+
+  for (file = 0; file < n_files && keep_going; file++) {
+    g_mutex_lock(cj.mutex);
+    while (!cj.jobs[file].done)
+      g_cond_wait(cj.cond, cj.mutex);
+    g_mutex_unlock(cj.mutex);
+
+    keep_going = report_cap_file(file, cj.jobs[file].status,
+                                 &cj.jobs[file].cf_info, &overall_error_status);
+
+    g_mutex_lock(cj.mutex);
+    cj.next_report = file + 1;
+    if (!keep_going)
+      cj.stop = TRUE;
+    g_cond_broadcast(cj.cond);
+    g_mutex_unlock(cj.mutex);
+  }
+
+  for (i = 0; i < n_threads; i++)
+    g_thread_join(threads[i]);
+  g_free(threads);
+
+  /* Drop the files read ahead of one that stopped the processing */
+  for (; file < n_files; file++) {
+    if (cj.jobs[file].done && cj.jobs[file].cf_info.wth) {
+      cleanup_capture_info(&cj.jobs[file].cf_info);
+      wtap_close(cj.jobs[file].cf_info.wth);
+    }
+    if (cj.jobs[file].cf_info.errors)
+      g_string_free(cj.jobs[file].cf_info.errors, TRUE);
+  }
+  g_free(cj.jobs);
+
+#if GLIB_CHECK_VERSION(2,31,0)
+  g_mutex_clear(cj.mutex);
+  g_free(cj.mutex);
+  g_cond_clear(cj.cond);
+  g_free(cj.cond);
+#else
+  g_mutex_free(cj.mutex);
+  g_cond_free(cj.cond);
+#endif
+
+  return overall_error_status;
+}
+
 int
 main(int argc, char *argv[])
 {
   GString *comp_info_str;
   GString *runtime_info_str;
   char  *init_progfile_dir_error;
-  wtap  *wth;
-  int    err;
-  gchar *err_info;
   int    opt;
   int    overall_error_status = EXIT_SUCCESS;
   static const struct option long_options[] = {
@@ -1424,10 +2006,8 @@ main(int argc, char *argv[])
   };
 
   int status = 0;
-  FILE  *fh;
   char  *hash_buf = NULL;
   gcry_md_hd_t hd = NULL;
-  size_t hash_bytes;
 
   /* Set the C-language locale to the native environment. */
   setlocale(LC_ALL, "");
@@ -1494,7 +2074,7 @@ main(int argc, char *argv[])
 #endif
 
   /* Process the options */
-  while ((opt = getopt_long(argc, argv, "abcdehiklmoqrstuvxyzABCEFHIKLMNQRST", long_options, NULL)) !=-1) {
+  while ((opt = getopt_long(argc, argv, "abcdefhij:klmoqrstuvxyzABCEFHIKLMNQRST", long_options, NULL)) !=-1) {
 
     switch (opt) {
 
@@ -1600,6 +2180,14 @@ main(int argc, char *argv[])
         continue_after_wtap_open_offline_failure = FALSE;
         break;
 
+      case 'f':
+        fast_times = TRUE;
+        break;
+
+      case 'j':
+        num_jobs = get_positive_int(optarg, "number of jobs");
+        break;
+
       case 'A':
         enable_all_infos();
         break;
@@ -1686,61 +2274,29 @@ main(int argc, char *argv[])
 
   if (cap_file_hashes) {
     gcry_check_version(NULL);
-    gcry_md_open(&hd, GCRY_MD_SHA1, 0);
-    if (hd) {
-      gcry_md_enable(hd, GCRY_MD_RMD160);
-      gcry_md_enable(hd, GCRY_MD_MD5);
-    }
-    hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
   }
 
   overall_error_status = 0;
 
-  for (opt = optind; opt < argc; opt++) {
-
-    g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_rmd160, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_md5, "<unknown>", HASH_STR_SIZE);
-
-    if (cap_file_hashes) {
-      fh = ws_fopen(argv[opt], "rb");
-      if (fh && hd) {
-        while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
-          gcry_md_write(hd, hash_buf, hash_bytes);
-        }
-        gcry_md_final(hd);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_RMD160), HASH_SIZE_RMD160, file_rmd160);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_MD5), HASH_SIZE_MD5, file_md5);
-      }
-      if (fh) fclose(fh);
-      if (hd) gcry_md_reset(hd);
-    }
-
-    wth = wtap_open_offline(argv[opt], WTAP_TYPE_AUTO, &err, &err_info, FALSE);
-
-    if (!wth) {
-      cfile_open_failure_message("capinfos", argv[opt], err, err_info);
-      overall_error_status = 2; /* remember that an error has occurred */
-      if (!continue_after_wtap_open_offline_failure)
-        goto exit;
-    }
+  if (num_jobs > 1 && (argc - optind) > 1) {
+#if !GLIB_CHECK_VERSION(2,31,0)
+    g_thread_init(NULL);
+#endif
+    overall_error_status = process_cap_files_parallel(&argv[optind], argc - optind);
+  } else {
+    hash_open(&hd, &hash_buf);
 
-    if (wth) {
-      if ((opt > optind) && (long_report))
-        printf("\n");
-      status = process_cap_file(wth, argv[opt]);
+    for (opt = optind; opt < argc; opt++) {
+      capture_info cf_info;
 
-      wtap_close(wth);
-      if (status) {
-        overall_error_status = status;
-        goto exit;
-      }
+      status = scan_cap_file(argv[opt], hd, hash_buf, &cf_info);
+      if (!report_cap_file(opt - optind, status, &cf_info, &overall_error_status))
+        break;
     }
   }
 
 exit:
-  g_free(hash_buf);
+  hash_close(hd, hash_buf);
   wtap_cleanup();
   free_progdirs();
 #ifdef HAVE_PLUGINS
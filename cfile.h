@@ -63,6 +63,29 @@ typedef struct {
 } modified_frame_data;
 #endif
 
+/*
+ * Running totals of the frames, kept up to date as frames are read,
+ * filtered and marked so that the summary doesn't have to go through all
+ * of them.  The numbers of marked and ignored frames are in capture_file
+ * itself.  Times are in seconds.
+ */
+typedef struct {
+  gboolean     valid;                /* FALSE if they have to be recomputed */
+  guint64      bytes;                /* Bytes in all frames */
+  guint32      count_ts;             /* Frames with a time stamp */
+  double       start_time;           /* Earliest time stamp */
+  double       stop_time;            /* Latest time stamp */
+  guint32      filtered_count;       /* Frames that passed the display filter */
+  guint64      filtered_bytes;
+  guint32      filtered_count_ts;
+  double       filtered_start;
+  double       filtered_stop;
+  guint64      marked_bytes;
+  guint32      marked_count_ts;
+  double       marked_start;
+  double       marked_stop;
+} frame_tally_t;
+
 typedef struct _capture_file {
   epan_t      *epan;
   file_state   state;                /* Current state of capture file */
@@ -84,6 +107,7 @@ typedef struct _capture_file {
   guint32      marked_count;         /* Number of marked frames */
   guint32      ignored_count;        /* Number of ignored frames */
   guint32      ref_time_count;       /* Number of time referenced frames */
+  frame_tally_t frame_tally;         /* Running totals for the summary */
   gboolean     drops_known;          /* TRUE if we know how many packets were dropped */
   guint32      drops;                /* Dropped packets */
   nstime_t     elapsed_time;         /* Elapsed time */
@@ -107,9 +131,13 @@ typedef struct _capture_file {
   search_charset_t scs_type;         /* Character set for text search */
   search_direction dir;              /* Direction in which to do searches */
   gboolean     search_in_progress;   /* TRUE if user just clicked OK in the Find dialog or hit <control>N/B */
+  struct _cf_search_index *search_index; /* Index of the frame data for searches, if any */
+  struct _find_dfilter_cache *find_dfilter_cache; /* Results of the last display filter search */
   /* packet data */
   struct wtap_pkthdr phdr;           /* Packet header */
   Buffer       buf;                  /* Packet data */
+  struct _cf_record_cache *record_cache; /* Recently read records */
+  struct _tail_state *tail_state;    /* State kept between updates of a live capture */
   /* frames */
   frame_data_sequence *frames;       /* Sequence of frames, if we're keeping that information */
   guint32      first_displayed;      /* Frame number of first frame displayed */
@@ -247,6 +247,57 @@ size_t codec_decode(codec_handle_t codec, void *context, const void *input, size
     return (codec->decode_fn)(context, input, inputSizeBytes, output, outputSizeBytes);
 }
 
+size_t codec_decode_batch(codec_handle_t codec, void *context, codec_payload_t *payloads, size_t payload_count, GByteArray *output)
+{
+    size_t total = 0;
+    size_t in_len = 0, in_count = 0;
+    size_t base = output->len, max_len;
+    size_t i;
+
+    for (i = 0; i < payload_count; i++) {
+        if (payloads[i].data && payloads[i].data_len > 0) {
+            in_len += payloads[i].data_len;
+            in_count++;
+        }
+    }
+
+    /*
+     * Size the buffer once for the whole batch. The codec's estimate for
+     * all of the input, plus its fixed allowance for each further payload,
+     * covers the sum of the per-payload estimates.
+     */
+    max_len = 0;
+    if (codec && in_count > 0) {
+        max_len = (codec->decode_fn)(context, NULL, in_len, NULL, NULL) +
+            (in_count - 1) * (codec->decode_fn)(context, NULL, 0, NULL, NULL);
+        g_byte_array_set_size(output, (guint)(base + max_len));
+    }
+
+    for (i = 0; i < payload_count; i++) {
+        codec_payload_t *payload = &payloads[i];
+        size_t out_len, decoded_len;
+
+        payload->decoded_offset = base + total;
+        payload->decoded_len = 0;
+        if (max_len == 0 || !payload->data || payload->data_len == 0)
+            continue;
+
+        /* Decode in place after the samples of the previous payloads */
+        out_len = max_len - total;
+        decoded_len = (codec->decode_fn)(context, payload->data, payload->data_len,
+                output->data + payload->decoded_offset, &out_len);
+        if (decoded_len > max_len - total)
+            decoded_len = max_len - total;
+
+        payload->decoded_len = decoded_len;
+        total += decoded_len;
+    }
+
+    g_byte_array_set_size(output, (guint)(base + total));
+
+    return total;
+}
+
 /**
  * Get compile-time information for libraries used by libwscodecs.
  */
@@ -68,6 +68,37 @@ WS_DLL_PUBLIC unsigned codec_get_frequency(codec_handle_t codec, void *context);
 WS_DLL_PUBLIC size_t codec_decode(codec_handle_t codec, void *context, const void *input,
         size_t inputSizeBytes, void *output, size_t *outputSizeBytes);
 
+/** A payload to decode with codec_decode_batch(). */
+typedef struct codec_payload {
+    const void *data;           /**< Encoded payload */
+    size_t data_len;            /**< Length of the encoded payload in bytes */
+    size_t decoded_offset;      /**< Set to the offset of the decoded samples in the output */
+    size_t decoded_len;         /**< Set to the length of the decoded samples in bytes */
+} codec_payload_t;
+
+/**
+ * Decode a sequence of payloads of the same stream, appending the samples
+ * to a single output buffer. The output can be reused across calls (e.g.
+ * after g_byte_array_set_size(output, 0)) so that decoding doesn't need
+ * an allocation per payload.
+ *
+ * The output is sized once for the whole batch from the codec's size
+ * estimate (its decode function called with a NULL output), so that
+ * estimate for n bytes plus the one for 0 bytes must cover the estimates
+ * for any split of the n bytes into two payloads. This holds for codecs
+ * whose estimate is linear in the input length, rounded down, or constant.
+ *
+ * @param codec The codec to use.
+ * @param context The codec context of the stream, from codec_init().
+ * @param payloads The payloads to decode, in stream order. The decoded_*
+ * members are filled in.
+ * @param payload_count The number of payloads.
+ * @param output The buffer the samples are appended to.
+ * @return The total number of decoded bytes.
+ */
+WS_DLL_PUBLIC size_t codec_decode_batch(codec_handle_t codec, void *context,
+        codec_payload_t *payloads, size_t payload_count, GByteArray *output);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,192 @@
+/* codecs_test.c
+ * Tests for the batch decoding of codec payloads
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <codecs/codecs.h>
+
+#define PAYLOAD_COUNT   8
+#define PERF_PAYLOADS   10000
+#define PERF_PAYLOAD_LEN 160    /* 20 ms of G.711 */
+#define PERF_LOOPS      50
+
+static guint8 *
+payload_data(size_t len, guint8 seed)
+{
+    guint8 *data = (guint8 *)g_malloc(len ? len : 1);
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        data[i] = (guint8)(seed + i * 7);
+    }
+    return data;
+}
+
+/* The samples of each payload must be those codec_decode() gives for it
+ * alone, laid out back to back; empty payloads decode to nothing. */
+static void
+codecs_test_batch(const char *name)
+{
+    static const size_t lengths[PAYLOAD_COUNT] = { 160, 0, 1, 80, 0, 240, 17, 160 };
+    codec_payload_t payloads[PAYLOAD_COUNT];
+    codec_handle_t codec;
+    void *context;
+    GByteArray *output;
+    size_t i, total, offset;
+
+    codec = find_codec(name);
+    g_assert(codec);
+    context = codec_init(codec);
+
+    for (i = 0; i < PAYLOAD_COUNT; i++) {
+        /* A missing payload is skipped like an empty one */
+        payloads[i].data = (i == 4) ? NULL : payload_data(lengths[i], (guint8)i);
+        payloads[i].data_len = lengths[i];
+    }
+
+    output = g_byte_array_new();
+    g_byte_array_append(output, (const guint8 *)"xy", 2);
+    total = codec_decode_batch(codec, context, payloads, PAYLOAD_COUNT, output);
+    g_assert_cmpuint(output->len, ==, 2 + total);
+    g_assert(memcmp(output->data, "xy", 2) == 0);
+
+    for (i = 0, offset = 2; i < PAYLOAD_COUNT; i++) {
+        size_t len = 0;
+        void *samples = NULL;
+
+        if (payloads[i].data && lengths[i] > 0) {
+            len = codec_decode(codec, context, payloads[i].data, lengths[i], NULL, NULL);
+            samples = g_malloc(len);
+            len = codec_decode(codec, context, payloads[i].data, lengths[i], samples, &len);
+        }
+        g_assert_cmpuint(payloads[i].decoded_offset, ==, offset);
+        g_assert_cmpuint(payloads[i].decoded_len, ==, len);
+        if (len > 0)
+            g_assert(memcmp(output->data + offset, samples, len) == 0);
+        offset += len;
+        g_free(samples);
+        g_free((void *)payloads[i].data);
+    }
+    g_assert_cmpuint(offset, ==, output->len);
+
+    /* Nothing to decode leaves the buffer alone */
+    g_assert_cmpuint(codec_decode_batch(codec, context, payloads, 0, output), ==, 0);
+    g_assert_cmpuint(output->len, ==, offset);
+
+    g_byte_array_free(output, TRUE);
+    codec_release(codec, context);
+}
+
+static void
+codecs_test_batch_g711u(void)
+{
+    codecs_test_batch("g711U");
+}
+
+static void
+codecs_test_batch_g711a(void)
+{
+    codecs_test_batch("g711A");
+}
+
+/* Decoding a stream's payloads in one batch, against sizing and
+ * allocating the output of each payload on its own. */
+static void
+codecs_test_batch_perf(void)
+{
+    codec_payload_t *payloads = g_new(codec_payload_t, PERF_PAYLOADS);
+    codec_handle_t codec = find_codec("g711U");
+    void *context = codec_init(codec);
+    GByteArray *output = g_byte_array_new();
+    guint8 *data = payload_data(PERF_PAYLOAD_LEN, 0);
+    double elapsed;
+    size_t i;
+    int loop;
+
+    for (i = 0; i < PERF_PAYLOADS; i++) {
+        payloads[i].data = data;
+        payloads[i].data_len = PERF_PAYLOAD_LEN;
+    }
+
+    g_test_timer_start();
+    for (loop = 0; loop < PERF_LOOPS; loop++) {
+        for (i = 0; i < PERF_PAYLOADS; i++) {
+            size_t len = codec_decode(codec, context, data, PERF_PAYLOAD_LEN, NULL, NULL);
+            void *samples = g_malloc(len);
+
+            codec_decode(codec, context, data, PERF_PAYLOAD_LEN, samples, &len);
+            g_free(samples);
+        }
+    }
+    elapsed = g_test_timer_elapsed();
+    g_test_minimized_result(elapsed, "codec_decode, %d payloads: %.3f ms",
+            PERF_PAYLOADS * PERF_LOOPS, elapsed * 1000);
+
+    g_test_timer_start();
+    for (loop = 0; loop < PERF_LOOPS; loop++) {
+        g_byte_array_set_size(output, 0);
+        codec_decode_batch(codec, context, payloads, PERF_PAYLOADS, output);
+    }
+    elapsed = g_test_timer_elapsed();
+    g_test_minimized_result(elapsed, "codec_decode_batch, %d payloads: %.3f ms",
+            PERF_PAYLOADS * PERF_LOOPS, elapsed * 1000);
+    g_assert_cmpuint(output->len, ==, PERF_PAYLOADS * PERF_PAYLOAD_LEN * 2);
+
+    g_byte_array_free(output, TRUE);
+    g_free(data);
+    g_free(payloads);
+    codec_release(codec, context);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    register_all_codecs();
+
+    g_test_add_func("/codecs/batch/g711u", codecs_test_batch_g711u);
+    g_test_add_func("/codecs/batch/g711a", codecs_test_batch_g711a);
+
+    if (g_test_perf()) {
+        g_test_add_func("/codecs/batch/perf", codecs_test_batch_perf);
+    }
+
+    return g_test_run();
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -58,6 +58,7 @@
 #include <wiretap/wtap.h>
 
 #include "epan/etypes.h"
+#include "epan/ipproto.h"
 
 #ifndef HAVE_GETOPT_LONG
 #include "wsutil/wsgetopt.h"
@@ -587,6 +588,284 @@ remove_vlan_info(const struct wtap_pkthdr *phdr, guint8* fd, guint32* len) {
     }
 }
 
+/*
+ * Flow hashing for -f: a minimal parser of the link, network and transport
+ * headers, just enough to find the addresses, protocol and ports of a
+ * packet without using the dissectors. Packets of tunnels (GRE, IP in IP
+ * and VXLAN) are hashed on their innermost flow.
+ */
+#define FLOW_MAX_DEPTH    4     /* nested tunnels looked into */
+#define VXLAN_PORT        4789
+#define VXLAN_HDR_SIZE    8
+
+typedef struct _flow_key_t {
+    guint   addr_len;           /* 4 or 16 for IP, 6 for Ethernet */
+    guint8  src[16];
+    guint8  dst[16];
+    guint16 src_port;
+    guint16 dst_port;
+    guint8  proto;
+} flow_key_t;
+
+static gboolean flow_parse_ether(const guint8 *pd, guint32 len, flow_key_t *key, int depth);
+
+static gboolean
+flow_parse_ip(const guint8 *pd, guint32 len, flow_key_t *key, int depth)
+{
+    flow_key_t inner;
+    gboolean   have_ports = TRUE;
+    gboolean   have_inner = FALSE;
+    guint32    hlen;
+    guint16    flags;
+    guint8     proto, next;
+
+    if (len < 1 || depth > FLOW_MAX_DEPTH)
+        return FALSE;
+
+    switch (pd[0] >> 4) {
+    case 4:
+        hlen = (pd[0] & 0x0f) * 4;
+        if (len < 20 || hlen < 20 || hlen > len)
+            return FALSE;
+        key->addr_len = 4;
+        memcpy(key->src, pd + 12, 4);
+        memcpy(key->dst, pd + 16, 4);
+        proto = pd[9];
+        /* Only the first fragment has the ports; leave them out for all
+         * fragments so that they end up together. */
+        if (pntoh16(pd + 6) & 0x3fff)
+            have_ports = FALSE;
+        break;
+
+    case 6:
+        hlen = 40;
+        if (len < hlen)
+            return FALSE;
+        key->addr_len = 16;
+        memcpy(key->src, pd + 8, 16);
+        memcpy(key->dst, pd + 24, 16);
+        proto = pd[6];
+        /* Skip the extension headers */
+        while (have_ports) {
+            if (proto != IP_PROTO_HOPOPTS && proto != IP_PROTO_ROUTING &&
+                proto != IP_PROTO_DSTOPTS && proto != IP_PROTO_AH &&
+                proto != IP_PROTO_FRAGMENT)
+                break;
+            if (hlen + 8 > len) {
+                have_ports = FALSE;
+                break;
+            }
+            next = pd[hlen];
+            if (proto == IP_PROTO_FRAGMENT) {
+                if (pntoh16(pd + hlen + 2) & 0xfff9) /* offset or more fragments */
+                    have_ports = FALSE;
+                hlen += 8;
+            } else if (proto == IP_PROTO_AH) {
+                hlen += (pd[hlen + 1] + 2) * 4;
+            } else {
+                hlen += (pd[hlen + 1] + 1) * 8;
+            }
+            proto = next;
+        }
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    key->proto = proto;
+    key->src_port = key->dst_port = 0;
+    if (!have_ports || hlen > len)
+        return TRUE;
+    pd += hlen;
+    len -= hlen;
+
+    memset(&inner, 0, sizeof inner);
+    switch (proto) {
+    case IP_PROTO_TCP:
+    case IP_PROTO_UDP:
+    case IP_PROTO_SCTP:
+        if (len < 4)
+            break;
+        key->src_port = pntoh16(pd);
+        key->dst_port = pntoh16(pd + 2);
+        if (proto == IP_PROTO_UDP && key->dst_port == VXLAN_PORT &&
+            len >= 8 + VXLAN_HDR_SIZE)
+            have_inner = flow_parse_ether(pd + 8 + VXLAN_HDR_SIZE,
+                                          len - 8 - VXLAN_HDR_SIZE, &inner, depth + 1);
+        break;
+
+    case IP_PROTO_IPIP:
+    case IP_PROTO_IPV6:
+        have_inner = flow_parse_ip(pd, len, &inner, depth + 1);
+        break;
+
+    case IP_PROTO_GRE:
+        /* Version 0 only, and no source routing */
+        if (len < 4)
+            break;
+        flags = pntoh16(pd);
+        if ((flags & 0x4007) != 0)
+            break;
+        hlen = 4;
+        if (flags & 0x8000)     /* checksum */
+            hlen += 4;
+        if (flags & 0x2000)     /* key */
+            hlen += 4;
+        if (flags & 0x1000)     /* sequence number */
+            hlen += 4;
+        if (hlen > len)
+            break;
+        switch (pntoh16(pd + 2)) {
+        case ETHERTYPE_IP:
+        case ETHERTYPE_IPv6:
+            have_inner = flow_parse_ip(pd + hlen, len - hlen, &inner, depth + 1);
+            break;
+        case ETHERTYPE_ETHBRIDGE:
+            have_inner = flow_parse_ether(pd + hlen, len - hlen, &inner, depth + 1);
+            break;
+        }
+        break;
+    }
+
+    if (have_inner)
+        *key = inner;
+    return TRUE;
+}
+
+static gboolean
+flow_parse_ethertype(guint16 type, const guint8 *pd, guint32 len, flow_key_t *key, int depth)
+{
+    for (;;) {
+        switch (type) {
+        case ETHERTYPE_VLAN:
+        case ETHERTYPE_IEEE_802_1AD:
+        case ETHERTYPE_QINQ_OLD:
+            if (len < 4)
+                return FALSE;
+            type = pntoh16(pd + 2);
+            pd += 4;
+            len -= 4;
+            break;
+
+        case ETHERTYPE_MPLS:
+        case ETHERTYPE_MPLS_MULTI:
+            /* Pop the label stack; the payload is taken to be IP if it
+             * looks like it. */
+            do {
+                if (len < 4)
+                    return FALSE;
+                pd += 4;
+                len -= 4;
+            } while (!(pd[-2] & 0x01));
+            return flow_parse_ip(pd, len, key, depth);
+
+        case ETHERTYPE_IP:
+        case ETHERTYPE_IPv6:
+            return flow_parse_ip(pd, len, key, depth);
+
+        default:
+            return FALSE;
+        }
+    }
+}
+
+static gboolean
+flow_parse_ether(const guint8 *pd, guint32 len, flow_key_t *key, int depth)
+{
+    if (len < 14)
+        return FALSE;
+
+    if (flow_parse_ethertype(pntoh16(pd + 12), pd + 14, len - 14, key, depth))
+        return TRUE;
+
+    /* Not IP; keep the traffic between two stations together */
+    memset(key, 0, sizeof *key);
+    key->addr_len = 6;
+    memcpy(key->src, pd + 6, 6);
+    memcpy(key->dst, pd, 6);
+    return TRUE;
+}
+
+static guint32
+flow_hash_bytes(guint32 hash, const guint8 *p, guint len)
+{
+    /* FNV-1a */
+    while (len--) {
+        hash ^= *p++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/*
+ * Returns a hash of the flow of a packet that is the same for both
+ * directions of the flow, or 0 if the packet couldn't be parsed.
+ */
+static guint32
+flow_hash(const struct wtap_pkthdr *phdr, const guint8 *pd)
+{
+    flow_key_t     key;
+    const guint8  *lo_addr, *hi_addr;
+    guint16        ports[2];
+    guint32        hash = 2166136261U;
+    gboolean       ok;
+    int            cmp;
+
+    memset(&key, 0, sizeof key);
+
+    switch (phdr->pkt_encap) {
+    case WTAP_ENCAP_ETHERNET:
+        ok = flow_parse_ether(pd, phdr->caplen, &key, 0);
+        break;
+    case WTAP_ENCAP_SLL:
+        ok = phdr->caplen >= 16 &&
+             flow_parse_ethertype(pntoh16(pd + LINUX_SLL_OFFSETP), pd + 16, phdr->caplen - 16, &key, 0);
+        break;
+    case WTAP_ENCAP_NULL:
+    case WTAP_ENCAP_LOOP:
+        /* 4 bytes of address family, in one byte order or the other */
+        ok = phdr->caplen >= 4 && flow_parse_ip(pd + 4, phdr->caplen - 4, &key, 0);
+        break;
+    case WTAP_ENCAP_RAW_IP:
+    case WTAP_ENCAP_RAW_IP4:
+    case WTAP_ENCAP_RAW_IP6:
+        ok = flow_parse_ip(pd, phdr->caplen, &key, 0);
+        break;
+    default:
+        ok = FALSE;
+        break;
+    }
+    if (!ok)
+        return 0;
+
+    /* Put the endpoints in a canonical order so that both directions of
+     * the flow give the same hash. */
+    cmp = memcmp(key.src, key.dst, key.addr_len);
+    if (cmp < 0 || (cmp == 0 && key.src_port <= key.dst_port)) {
+        lo_addr = key.src;
+        hi_addr = key.dst;
+        ports[0] = key.src_port;
+        ports[1] = key.dst_port;
+    } else {
+        lo_addr = key.dst;
+        hi_addr = key.src;
+        ports[0] = key.dst_port;
+        ports[1] = key.src_port;
+    }
+
+    hash = flow_hash_bytes(hash, lo_addr, key.addr_len);
+    hash = flow_hash_bytes(hash, hi_addr, key.addr_len);
+    hash = flow_hash_bytes(hash, (const guint8 *)ports, sizeof ports);
+    hash = flow_hash_bytes(hash, &key.proto, 1);
+
+    /* Mix the high bits into the low ones, which pick the file */
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    return hash;
+}
+
 static gboolean
 is_duplicate(guint8* fd, guint32 len) {
     int i;
@@ -818,6 +1097,9 @@ print_usage(FILE *output)
     fprintf(output, "  -i <seconds per file>  split the packet output to different files based on\n");
     fprintf(output, "                         uniform time intervals with a maximum of\n");
     fprintf(output, "                         <seconds per file> each.\n");
+    fprintf(output, "  -f <number of files>   split the packet output to <number of files> files,\n");
+    fprintf(output, "                         keeping all packets of a flow (both directions of a\n");
+    fprintf(output, "                         TCP connection, for example) in the same file.\n");
     fprintf(output, "  -F <capture type>      set the output file type; default is pcapng. An empty\n");
     fprintf(output, "                         \"-F\" option will list the file types.\n");
     fprintf(output, "  -T <encap type>        set the output file encapsulation type; default is the\n");
@@ -984,6 +1266,10 @@ main(int argc, char *argv[])
     guint8       *buf;
     guint32       read_count         = 0;
     guint32       split_packet_count = 0;
+    guint32       split_flow_count   = 0;
+    wtap_dumper **flow_pdh           = NULL;
+    gchar       **flow_filenames     = NULL;
+    guint32       flow_idx           = 0;
     int           written_count      = 0;
     char         *filename           = NULL;
     gboolean      ts_okay;
@@ -1062,7 +1348,7 @@ main(int argc, char *argv[])
 #endif
 
     /* Process the options */
-    while ((opt = getopt_long(argc, argv, "a:A:B:c:C:dD:E:F:hi:I:Lo:rs:S:t:T:vVw:", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "a:A:B:c:C:dD:E:f:F:hi:I:Lo:rs:S:t:T:vVw:", long_options, NULL)) != -1) {
         switch (opt) {
         case 0x8100:
         {
@@ -1200,6 +1486,10 @@ main(int argc, char *argv[])
             srand( (unsigned int) (time(NULL) + ws_getpid()) );
             break;
 
+        case 'f':
+            split_flow_count = get_nonzero_guint32(optarg, "number of files");
+            break;
+
         case 'F':
             out_file_type_subtype = wtap_short_string_to_file_type_subtype(optarg);
             if (out_file_type_subtype < 0) {
@@ -1348,6 +1638,13 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (split_flow_count != 0 && (split_packet_count != 0 || secs_per_block != 0)) {
+        fprintf(stderr, "editcap: can't split on flows and on packet count or time interval\n");
+        fprintf(stderr, "editcap: at the same time\n");
+        ret = INVALID_OPTION;
+        goto clean_exit;
+    }
+
     wth = wtap_open_offline(argv[optind], WTAP_TYPE_AUTO, &read_err, &read_err_info, FALSE);
 
     if (!wth) {
@@ -1401,7 +1698,7 @@ main(int argc, char *argv[])
 
             /* Extra actions for the first packet */
             if (read_count == 1) {
-                if (split_packet_count != 0 || secs_per_block != 0) {
+                if (split_packet_count != 0 || secs_per_block != 0 || split_flow_count != 0) {
                     if (!fileset_extract_prefix_suffix(argv[optind+1], &fprefix, &fsuffix)) {
                         ret = CANT_EXTRACT_PREFIX;
                         goto clean_exit;
@@ -1429,11 +1726,42 @@ main(int argc, char *argv[])
                     ret = INVALID_FILE;
                     goto clean_exit;
                 }
+
+                /*
+                 * When splitting on flows, all of the output files are
+                 * kept open, the first one being the one just opened.
+                 */
+                if (split_flow_count != 0) {
+                    flow_pdh = g_new0(wtap_dumper *, split_flow_count);
+                    flow_filenames = g_new0(gchar *, split_flow_count);
+                    flow_pdh[0] = pdh;
+                    flow_filenames[0] = filename;
+                    for (flow_idx = 1; flow_idx < split_flow_count; flow_idx++) {
+                        flow_filenames[flow_idx] = fileset_get_filename_by_pattern(block_cnt++, phdr, fprefix, fsuffix);
+                        flow_pdh[flow_idx] = editcap_dump_open(flow_filenames[flow_idx],
+                                                               snaplen ? MIN(snaplen, wtap_snapshot_length(wth)) : wtap_snapshot_length(wth),
+                                                               shb_hdrs, idb_inf, nrb_hdrs, &write_err);
+                        if (flow_pdh[flow_idx] == NULL) {
+                            cfile_dump_open_failure_message("editcap", flow_filenames[flow_idx],
+                                                            write_err,
+                                                            out_file_type_subtype);
+                            ret = INVALID_FILE;
+                            goto clean_exit;
+                        }
+                    }
+                }
             } /* first packet only handling */
 
 
             buf = wtap_buf_ptr(wth);
 
+            /* Pick the output file by the flow, before the packet is changed */
+            if (split_flow_count != 0) {
+                flow_idx = flow_hash(phdr, buf) % split_flow_count;
+                pdh = flow_pdh[flow_idx];
+                filename = flow_filenames[flow_idx];
+            }
+
             /*
              * Not all packets have time stamps. Only process the time
              * stamp if we have one.
@@ -1823,12 +2151,24 @@ main(int argc, char *argv[])
             }
         }
 
-        if (!wtap_dump_close(pdh, &write_err)) {
-            cfile_close_failure_message(filename, write_err);
-            ret = WRITE_ERROR;
-            goto clean_exit;
+        if (flow_pdh != NULL) {
+            for (flow_idx = 0; flow_idx < split_flow_count; flow_idx++) {
+                pdh = flow_pdh[flow_idx];
+                flow_pdh[flow_idx] = NULL;
+                if (!wtap_dump_close(pdh, &write_err)) {
+                    cfile_close_failure_message(flow_filenames[flow_idx], write_err);
+                    ret = WRITE_ERROR;
+                    goto clean_exit;
+                }
+            }
+        } else {
+            if (!wtap_dump_close(pdh, &write_err)) {
+                cfile_close_failure_message(filename, write_err);
+                ret = WRITE_ERROR;
+                goto clean_exit;
+            }
+            g_free(filename);
         }
-        g_free(filename);
 
         if (frames_user_comments) {
             g_tree_destroy(frames_user_comments);
@@ -1848,6 +2188,12 @@ main(int argc, char *argv[])
     }
 
 clean_exit:
+    if (flow_filenames != NULL) {
+        for (flow_idx = 0; flow_idx < split_flow_count; flow_idx++)
+            g_free(flow_filenames[flow_idx]);
+        g_free(flow_filenames);
+    }
+    g_free(flow_pdh);
     wtap_block_array_free(shb_hdrs);
     wtap_block_array_free(nrb_hdrs);
     g_free(idb_inf);
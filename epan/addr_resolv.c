@@ -122,29 +122,7 @@
 #define ENAME_ENTERPRISES "enterprises.tsv"
 
 #define HASHETHSIZE      2048
-#define HASHHOSTSIZE     2048
 #define HASHIPXNETSIZE    256
-#define SUBNETLENGTHSIZE   32  /*1-32 inc.*/
-
-/* hash table used for IPv4 lookup */
-
-#define HASH_IPV4_ADDRESS(addr) (g_htonl(addr) & (HASHHOSTSIZE - 1))
-
-
-typedef struct sub_net_hashipv4 {
-    guint             addr;
-    /* XXX: No longer needed?*/
-    guint8            flags;          /* B0 dummy_entry, B1 resolve, B2 If the address is used in the trace */
-    struct sub_net_hashipv4   *next;
-    gchar             name[MAXNAMELEN];
-} sub_net_hashipv4_t;
-
-/* Array of entries of subnets of different lengths */
-typedef struct {
-    gsize        mask_length;      /*1-32*/
-    guint32      mask;             /* e.g. 255.255.255.*/
-    sub_net_hashipv4_t** subnet_addresses; /* Hash table of subnet addresses */
-} subnet_length_entry_t;
 
 
 /* hash table used for IPX network lookup */
@@ -190,6 +168,20 @@ struct hashmanuf {
     char              resolved_name[MAXNAMELEN];
 };
 
+/* Direct-indexed manufacturer table. The 24-bit OUI is split into a 16-bit
+ * page index and an 8-bit slot; pages are only allocated for OUI ranges
+ * that are actually used. The "refined" bitmap marks OUIs that have
+ * well-known-address entries with a mask of 24 bits or more (MA-M and MA-S
+ * assignments, multicast ranges, ...), so that resolving a MAC address only
+ * probes the well-known-address table for those. */
+#define MANUF_OUI_PAGES         (1 << 16)
+#define MANUF_OUI_PAGE_SIZE     (1 << 8)
+
+typedef struct {
+    hashmanuf_t      *entries[MANUF_OUI_PAGE_SIZE];
+    guint8            refined[MANUF_OUI_PAGE_SIZE / 8];
+} manuf_oui_page_t;
+
 /* internal ethernet type */
 typedef struct _ether
 {
@@ -240,12 +232,18 @@ struct cb_serv_data {
 };
 
 static wmem_map_t *manuf_hashtable = NULL;
+static manuf_oui_page_t **manuf_oui_table = NULL;
 static wmem_map_t *wka_hashtable = NULL;
 static wmem_map_t *eth_hashtable = NULL;
 static wmem_map_t *serv_port_hashtable = NULL;
 static GHashTable *enterprises_hashtable = NULL;
 
-static subnet_length_entry_t subnet_length_entries[SUBNETLENGTHSIZE]; /* Ordered array of entries */
+/* Subnets from the subnets files, in longest-prefix-match trees keyed by
+ * the address in network byte order. Both live in subnet_scope, which is
+ * destroyed on cleanup. */
+static wmem_allocator_t *subnet_scope = NULL;
+static wmem_prefix_tree_t *subnet_tree_ipv4 = NULL;
+static wmem_prefix_tree_t *subnet_tree_ipv6 = NULL;
 static gboolean have_subnet_entry = FALSE;
 
 static gboolean new_resolved_objects = FALSE;
@@ -426,7 +424,9 @@ fgetline(char **buf, int *size, FILE *fp)
  *  Local function definitions
  */
 static subnet_entry_t subnet_lookup(const guint32 addr);
+static const gchar *subnet_lookup6(const guint8 *addr, guint *mask_length);
 static void subnet_entry_set(guint32 subnet_addr, const guint8 mask_length, const gchar* name);
+static void subnet_entry_set6(const struct e_in6_addr *subnet_addr, const guint8 mask_length, const gchar* name);
 
 
 static void
@@ -819,13 +819,41 @@ fill_dummy_ip4(const guint addr, hashipv4_t* volatile tp)
 }
 
 
-/* Fill in an IP6 structure with the string form of the address.
+/* Fill in an IP6 structure with info from subnets file or just with the
+ * string form of the address.
  */
 static void
 fill_dummy_ip6(hashipv6_t* volatile tp)
 {
+    const gchar *subnet_name;
+    guint mask_length;
+
     /* Overwrite if we get async DNS reply */
-    g_strlcpy(tp->name, tp->ip6, MAXNAMELEN);
+
+    /* Do we have a subnet for this address? */
+    subnet_name = subnet_lookup6(tp->addr, &mask_length);
+    if (subnet_name != NULL) {
+        /* Print name, a dot, then the host part of the address in
+         * compressed form, e.g. "lab.::1" or "lab.0:0:1::1" */
+        struct e_in6_addr host_addr;
+        gchar buffer[WS_INET6_ADDRSTRLEN];
+        guint i;
+
+        memcpy(host_addr.bytes, tp->addr, sizeof host_addr.bytes);
+        for (i = 0; i < 16; i++) {
+            if (mask_length >= 8) {
+                host_addr.bytes[i] = 0;
+                mask_length -= 8;
+            } else {
+                host_addr.bytes[i] &= 0xFF >> mask_length;
+                mask_length = 0;
+            }
+        }
+        ip6_to_str_buf(&host_addr, buffer, sizeof(buffer));
+        g_snprintf(tp->name, MAXNAMELEN, "%s.%s", subnet_name, buffer);
+    } else {
+        g_strlcpy(tp->name, tp->ip6, MAXNAMELEN);
+    }
 }
 
 #ifdef HAVE_C_ARES
@@ -1194,6 +1222,50 @@ get_ethbyaddr(const guint8 *addr)
 
 } /* get_ethbyaddr */
 
+static manuf_oui_page_t *
+manuf_oui_page(const guint32 oui, const gboolean create)
+{
+    manuf_oui_page_t *page = manuf_oui_table[oui >> 8];
+
+    if (page == NULL && create) {
+        page = wmem_new0(wmem_epan_scope(), manuf_oui_page_t);
+        manuf_oui_table[oui >> 8] = page;
+    }
+
+    return page;
+}
+
+static hashmanuf_t *
+manuf_oui_lookup(const guint32 oui)
+{
+    manuf_oui_page_t *page = manuf_oui_table[oui >> 8];
+
+    return page ? page->entries[oui & 0xFF] : NULL;
+}
+
+static void
+manuf_oui_set_refined(const guint8 *addr)
+{
+    guint32 oui = (addr[0] << 16) | (addr[1] << 8) | addr[2];
+    manuf_oui_page_t *page = manuf_oui_page(oui, TRUE);
+
+    page->refined[(oui & 0xFF) >> 3] |= 1 << (oui & 0x07);
+}
+
+/* Returns TRUE if there are well-known-address entries with a mask of 24
+ * bits or more within the OUI of this address. */
+static gboolean
+manuf_oui_is_refined(const guint8 *addr)
+{
+    manuf_oui_page_t *page;
+
+    if (manuf_oui_table == NULL)
+        return TRUE;
+
+    page = manuf_oui_table[(addr[0] << 8) | addr[1]];
+    return page != NULL && (page->refined[addr[2] >> 3] & (1 << (addr[2] & 0x07)));
+}
+
 static hashmanuf_t *
 manuf_hash_new_entry(const guint8 *addr, char* name)
 {
@@ -1220,14 +1292,22 @@ manuf_hash_new_entry(const guint8 *addr, char* name)
     *endp = '\0';
 
     wmem_map_insert(manuf_hashtable, manuf_key, manuf_value);
+    /* Only OUIs with a name get a slot in the direct-indexed table, so
+     * that lookups of unknown OUIs don't allocate pages for them. */
+    if (name != NULL)
+        manuf_oui_page(*manuf_key, TRUE)->entries[*manuf_key & 0xFF] = manuf_value;
     return manuf_value;
 }
 
 static void
-wka_hash_new_entry(const guint8 *addr, char* name)
+wka_hash_new_entry(const guint8 *addr, const unsigned int mask, char* name)
 {
     guint8 *wka_key;
 
+    if (mask >= 24) {
+        manuf_oui_set_refined(addr);
+    }
+
     wka_key = (guint8 *)wmem_alloc(wmem_epan_scope(), 6);
     memcpy(wka_key, addr, 6);
 
@@ -1251,7 +1331,7 @@ add_manuf_name(const guint8 *addr, unsigned int mask, gchar *name)
 
     default:
         /* This is a range of well-known addresses; add it to the well-known-address table */
-        wka_hash_new_entry(addr, name);
+        wka_hash_new_entry(addr, mask, name);
         break;
     }
 } /* add_manuf_name */
@@ -1259,22 +1339,15 @@ add_manuf_name(const guint8 *addr, unsigned int mask, gchar *name)
 static hashmanuf_t *
 manuf_name_lookup(const guint8 *addr)
 {
-    gint32       manuf_key = 0;
-    guint8       oct;
+    guint32      manuf_key;
+    int          unresolved_key;
     hashmanuf_t  *manuf_value;
 
     /* manuf needs only the 3 most significant octets of the ethernet address */
-    manuf_key = addr[0];
-    manuf_key = manuf_key<<8;
-    oct = addr[1];
-    manuf_key = manuf_key | oct;
-    manuf_key = manuf_key<<8;
-    oct = addr[2];
-    manuf_key = manuf_key | oct;
-
+    manuf_key = (addr[0] << 16) | (addr[1] << 8) | addr[2];
 
     /* first try to find a "perfect match" */
-    manuf_value = (hashmanuf_t*)wmem_map_lookup(manuf_hashtable, &manuf_key);
+    manuf_value = manuf_oui_lookup(manuf_key);
     if (manuf_value != NULL) {
         return manuf_value;
     }
@@ -1286,12 +1359,19 @@ manuf_name_lookup(const guint8 *addr)
      * 0x02 locally administered bit */
     if ((manuf_key & 0x00010000) != 0) {
         manuf_key &= 0x00FEFFFF;
-        manuf_value = (hashmanuf_t*)wmem_map_lookup(manuf_hashtable, &manuf_key);
+        manuf_value = manuf_oui_lookup(manuf_key);
         if (manuf_value != NULL) {
             return manuf_value;
         }
     }
 
+    /* Have we already failed to resolve this one? */
+    unresolved_key = (int)((addr[0] << 16) | (addr[1] << 8) | addr[2]);
+    manuf_value = (hashmanuf_t *)wmem_map_lookup(manuf_hashtable, &unresolved_key);
+    if (manuf_value != NULL) {
+        return manuf_value;
+    }
+
     /* Add the address as a hex string */
     return manuf_hash_new_entry(addr, NULL);
 
@@ -1361,6 +1441,7 @@ initialize_ethers(void)
     /* hash table initialization */
     wka_hashtable   = wmem_map_new(wmem_epan_scope(), eth_addr_hash, eth_addr_cmp);
     manuf_hashtable = wmem_map_new(wmem_epan_scope(), g_int_hash, g_int_equal);
+    manuf_oui_table = wmem_alloc0_array(wmem_epan_scope(), manuf_oui_page_t *, MANUF_OUI_PAGES);
     eth_hashtable   = wmem_map_new(wmem_epan_scope(), eth_addr_hash, eth_addr_cmp);
 
     /* Compute the pathname of the ethers file. */
@@ -1428,39 +1509,42 @@ eth_addr_resolve(hashether_t *tp) {
         address       ether_addr;
 
         /* Unknown name.  Try looking for it in the well-known-address
-           tables for well-known address ranges smaller than 2^24. */
-        mask = 7;
-        do {
-            /* Only the topmost 5 bytes participate fully */
-            if ((name = wka_name_lookup(addr, mask+40)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x",
-                        name, addr[5] & (0xFF >> mask));
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-        } while (mask--);
-
-        mask = 7;
-        do {
-            /* Only the topmost 4 bytes participate fully */
-            if ((name = wka_name_lookup(addr, mask+32)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x",
-                        name, addr[4] & (0xFF >> mask), addr[5]);
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-        } while (mask--);
-
-        mask = 7;
-        do {
-            /* Only the topmost 3 bytes participate fully */
-            if ((name = wka_name_lookup(addr, mask+24)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x:%02x",
-                        name, addr[3] & (0xFF >> mask), addr[4], addr[5]);
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-        } while (mask--);
+           tables for well-known address ranges smaller than 2^24, if
+           there are any within this OUI. */
+        if (manuf_oui_is_refined(addr)) {
+            mask = 7;
+            do {
+                /* Only the topmost 5 bytes participate fully */
+                if ((name = wka_name_lookup(addr, mask+40)) != NULL) {
+                    g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x",
+                            name, addr[5] & (0xFF >> mask));
+                    tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
+                    return tp;
+                }
+            } while (mask--);
+
+            mask = 7;
+            do {
+                /* Only the topmost 4 bytes participate fully */
+                if ((name = wka_name_lookup(addr, mask+32)) != NULL) {
+                    g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x",
+                            name, addr[4] & (0xFF >> mask), addr[5]);
+                    tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
+                    return tp;
+                }
+            } while (mask--);
+
+            mask = 7;
+            do {
+                /* Only the topmost 3 bytes participate fully */
+                if ((name = wka_name_lookup(addr, mask+24)) != NULL) {
+                    g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x:%02x",
+                            name, addr[3] & (0xFF >> mask), addr[4], addr[5]);
+                    tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
+                    return tp;
+                }
+            } while (mask--);
+        }
 
         /* Now try looking in the manufacturer table. */
         manuf_value = manuf_name_lookup(addr);
@@ -2069,15 +2153,13 @@ get_addrinfo_list(void)
  * <line> = <comment> | <entry> | <whitespace>
  * <comment> = <whitespace>#<any>
  * <entry> = <subnet_definition> <whitespace> <subnet_name> [<comment>|<whitespace><any>]
- * <subnet_definition> = <ipv4_address> / <subnet_mask_length>
- * <ipv4_address> is a full address; it will be masked to get the subnet-ID.
- * <subnet_mask_length> is a decimal 1-31
+ * <subnet_definition> = <ip_address> / <subnet_mask_length>
+ * <ip_address> is a full IPv4 or IPv6 address; it will be masked to get the subnet-ID.
+ * <subnet_mask_length> is a decimal 1-32 (IPv4) or 1-128 (IPv6)
  * <subnet_name> is a string containing no whitespace.
  * <whitespace> = (space | tab)+
  * Any malformed entries are ignored.
  * Any trailing data after the subnet_name is ignored.
- *
- * XXX Support IPv6
  */
 static gboolean
 read_subnets_file (const char *subnetspath)
@@ -2086,7 +2168,9 @@ read_subnets_file (const char *subnetspath)
     char *line = NULL;
     int size = 0;
     gchar *cp, *cp2;
-    guint32 host_addr; /* IPv4 ONLY */
+    guint32 host_addr;
+    struct e_in6_addr host_addr6;
+    gboolean is_ipv6;
     guint8 mask_length;
 
     if ((hf = ws_fopen(subnetspath, "r")) == NULL)
@@ -2100,7 +2184,7 @@ read_subnets_file (const char *subnetspath)
             continue; /* no tokens in the line */
 
 
-        /* Expected format is <IP4 address>/<subnet length> */
+        /* Expected format is <IP address>/<subnet length> */
         cp2 = strchr(cp, '/');
         if (NULL == cp2) {
             /* No length */
@@ -2109,19 +2193,27 @@ read_subnets_file (const char *subnetspath)
         *cp2 = '\0'; /* Cut token */
         ++cp2    ;
 
-        /* Check if this is a valid IPv4 address */
-        if (!str_to_ip(cp, &host_addr)) {
+        /* Check if this is a valid IPv4 or IPv6 address */
+        if (str_to_ip(cp, &host_addr)) {
+            is_ipv6 = FALSE;
+        } else if (str_to_ip6(cp, &host_addr6)) {
+            is_ipv6 = TRUE;
+        } else {
             continue; /* no */
         }
 
-        if (!ws_strtou8(cp2, NULL, &mask_length) || mask_length == 0 || mask_length > 32) {
+        if (!ws_strtou8(cp2, NULL, &mask_length) || mask_length == 0 ||
+                mask_length > (is_ipv6 ? 128 : 32)) {
             continue; /* invalid mask length */
         }
 
         if ((cp = strtok(NULL, " \t")) == NULL)
             continue; /* no subnet name */
 
-        subnet_entry_set(host_addr, mask_length, cp);
+        if (is_ipv6)
+            subnet_entry_set6(&host_addr6, mask_length, cp);
+        else
+            subnet_entry_set(host_addr, mask_length, cp);
     }
     wmem_free(wmem_epan_scope(), line);
 
@@ -2133,40 +2225,18 @@ static subnet_entry_t
 subnet_lookup(const guint32 addr)
 {
     subnet_entry_t subnet_entry;
-    guint32 i;
-
-    /* Search mask lengths linearly, longest first */
-
-    i = SUBNETLENGTHSIZE;
-    while(have_subnet_entry && i > 0) {
-        guint32 masked_addr;
-        subnet_length_entry_t* length_entry;
-
-        /* Note that we run from 31 (length 32)  to 0 (length 1)  */
-        --i;
-        g_assert(i < SUBNETLENGTHSIZE);
-
-
-        length_entry = &subnet_length_entries[i];
-
-        if (NULL != length_entry->subnet_addresses) {
-            sub_net_hashipv4_t * tp;
-            guint32 hash_idx;
-
-            masked_addr = addr & length_entry->mask;
-            hash_idx = HASH_IPV4_ADDRESS(masked_addr);
-
-            tp = length_entry->subnet_addresses[hash_idx];
-            while(tp != NULL && tp->addr != masked_addr) {
-                tp = tp->next;
-            }
-
-            if (NULL != tp) {
-                subnet_entry.mask = length_entry->mask;
-                subnet_entry.mask_length = i + 1; /* Length is offset + 1 */
-                subnet_entry.name = tp->name;
-                return subnet_entry;
-            }
+    const gchar *name;
+    guint mask_length;
+
+    /* The tree hands back the longest matching prefix in a single descent */
+    if (have_subnet_entry && subnet_tree_ipv4 != NULL) {
+        name = (const gchar *)wmem_prefix_tree_lookup(subnet_tree_ipv4,
+                (const guint8 *)&addr, &mask_length);
+        if (name != NULL) {
+            subnet_entry.mask = g_htonl(ip_get_subnet_mask(mask_length));
+            subnet_entry.mask_length = mask_length;
+            subnet_entry.name = name;
+            return subnet_entry;
         }
     }
 
@@ -2177,6 +2247,15 @@ subnet_lookup(const guint32 addr)
     return subnet_entry;
 }
 
+static const gchar *
+subnet_lookup6(const guint8 *addr, guint *mask_length)
+{
+    if (!have_subnet_entry || subnet_tree_ipv6 == NULL)
+        return NULL;
+
+    return (const gchar *)wmem_prefix_tree_lookup(subnet_tree_ipv6, addr, mask_length);
+}
+
 /* Add a subnet-definition - name pair to the set.
  * The definition is taken by masking the address passed in with the mask of the
  * given length.
@@ -2184,43 +2263,37 @@ subnet_lookup(const guint32 addr)
 static void
 subnet_entry_set(guint32 subnet_addr, const guint8 mask_length, const gchar* name)
 {
-    subnet_length_entry_t* entry;
-    sub_net_hashipv4_t * tp;
-    gsize hash_idx;
-
     g_assert(mask_length > 0 && mask_length <= 32);
 
-    entry = &subnet_length_entries[mask_length - 1];
-
-    subnet_addr &= entry->mask;
-
-    hash_idx = HASH_IPV4_ADDRESS(subnet_addr);
+    if (NULL == subnet_tree_ipv4) {
+        subnet_tree_ipv4 = wmem_prefix_tree_new(subnet_scope, 4);
+    }
 
-    if (NULL == entry->subnet_addresses) {
-        entry->subnet_addresses = (sub_net_hashipv4_t**)wmem_alloc0(wmem_epan_scope(), sizeof(sub_net_hashipv4_t*) * HASHHOSTSIZE);
+    if (wmem_prefix_tree_lookup_exact(subnet_tree_ipv4, (const guint8 *)&subnet_addr, mask_length)) {
+        return; /* XXX provide warning that an address was repeated? */
     }
 
-    if (NULL != (tp = entry->subnet_addresses[hash_idx])) {
-        sub_net_hashipv4_t * new_tp;
+    /* The tree masks the address itself */
+    wmem_prefix_tree_insert(subnet_tree_ipv4, (const guint8 *)&subnet_addr, mask_length,
+            wmem_strndup(subnet_scope, name, MAXNAMELEN - 1));
+    have_subnet_entry = TRUE;
+}
 
-        while (tp->next) {
-            if (tp->addr == subnet_addr) {
-                return; /* XXX provide warning that an address was repeated? */
-            } else {
-                tp = tp->next;
-            }
-        }
+static void
+subnet_entry_set6(const struct e_in6_addr *subnet_addr, const guint8 mask_length, const gchar* name)
+{
+    g_assert(mask_length > 0 && mask_length <= 128);
 
-        new_tp = wmem_new(wmem_epan_scope(), sub_net_hashipv4_t);
-        tp->next = new_tp;
-        tp = new_tp;
-    } else {
-        tp = entry->subnet_addresses[hash_idx] = wmem_new(wmem_epan_scope(), sub_net_hashipv4_t);
+    if (NULL == subnet_tree_ipv6) {
+        subnet_tree_ipv6 = wmem_prefix_tree_new(subnet_scope, 16);
+    }
+
+    if (wmem_prefix_tree_lookup_exact(subnet_tree_ipv6, subnet_addr->bytes, mask_length)) {
+        return; /* XXX provide warning that an address was repeated? */
     }
 
-    tp->next = NULL;
-    tp->addr = subnet_addr;
-    g_strlcpy(tp->name, name, MAXNAMELEN); /* This is longer than subnet names can actually be */
+    wmem_prefix_tree_insert(subnet_tree_ipv6, subnet_addr->bytes, mask_length,
+            wmem_strndup(subnet_scope, name, MAXNAMELEN - 1));
     have_subnet_entry = TRUE;
 }
 
@@ -2228,15 +2301,10 @@ static void
 subnet_name_lookup_init(void)
 {
     gchar* subnetspath;
-    guint32 i;
-
-    for(i = 0; i < SUBNETLENGTHSIZE; ++i) {
-        guint32 length = i + 1;
 
-        subnet_length_entries[i].subnet_addresses  = NULL;
-        subnet_length_entries[i].mask_length  = length;
-        subnet_length_entries[i].mask = g_htonl(ip_get_subnet_mask(length));
-    }
+    subnet_scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    subnet_tree_ipv4 = NULL;
+    subnet_tree_ipv6 = NULL;
 
     /* Check profile directory before personal configuration */
     subnetspath = get_persconffile_path(ENAME_SUBNETS, TRUE);
@@ -2769,9 +2837,6 @@ host_name_lookup_init(void)
 void
 host_name_lookup_cleanup(void)
 {
-    guint32 i, j;
-    sub_net_hashipv4_t *entry, *next_entry;
-
     _host_name_lookup_cleanup();
 
     ipxnet_hash_table = NULL;
@@ -2779,19 +2844,12 @@ host_name_lookup_cleanup(void)
     ipv6_hash_table = NULL;
     ss7pc_hash_table = NULL;
 
-    for(i = 0; i < SUBNETLENGTHSIZE; ++i) {
-        if (subnet_length_entries[i].subnet_addresses != NULL) {
-            for (j = 0; j < HASHHOSTSIZE; j++) {
-                for (entry = subnet_length_entries[i].subnet_addresses[j];
-                     entry != NULL; entry = next_entry) {
-                    next_entry = entry->next;
-                    wmem_free(wmem_epan_scope(), entry);
-                }
-            }
-            wmem_free(wmem_epan_scope(), subnet_length_entries[i].subnet_addresses);
-            subnet_length_entries[i].subnet_addresses = NULL;
-        }
+    if (subnet_scope != NULL) {
+        wmem_destroy_allocator(subnet_scope);
+        subnet_scope = NULL;
     }
+    subnet_tree_ipv4 = NULL;
+    subnet_tree_ipv6 = NULL;
 
     have_subnet_entry = FALSE;
     new_resolved_objects = FALSE;
@@ -3018,19 +3076,12 @@ const gchar *
 get_manuf_name_if_known(const guint8 *addr)
 {
     hashmanuf_t *manuf_value;
-    int manuf_key;
-    guint8 oct;
+    guint32 manuf_key;
 
     /* manuf needs only the 3 most significant octets of the ethernet address */
-    manuf_key = addr[0];
-    manuf_key = manuf_key<<8;
-    oct = addr[1];
-    manuf_key = manuf_key | oct;
-    manuf_key = manuf_key<<8;
-    oct = addr[2];
-    manuf_key = manuf_key | oct;
-
-    manuf_value = (hashmanuf_t *)wmem_map_lookup(manuf_hashtable, &manuf_key);
+    manuf_key = (addr[0] << 16) | (addr[1] << 8) | addr[2];
+
+    manuf_value = manuf_oui_lookup(manuf_key);
     if ((manuf_value == NULL) || (manuf_value->status == HASHETHER_STATUS_UNRESOLVED)) {
         return NULL;
     }
@@ -3044,7 +3095,11 @@ uint_get_manuf_name_if_known(const guint manuf_key)
 {
     hashmanuf_t *manuf_value;
 
-    manuf_value = (hashmanuf_t *)wmem_map_lookup(manuf_hashtable, &manuf_key);
+    if (manuf_key > 0xFFFFFF) {
+        return NULL;
+    }
+
+    manuf_value = manuf_oui_lookup(manuf_key);
     if ((manuf_value == NULL) || (manuf_value->status == HASHETHER_STATUS_UNRESOLVED)) {
         return NULL;
     }
@@ -43,6 +43,7 @@
 #endif
 
 #include "wsutil/file_util.h"
+#include "wmem/wmem.h"
 #include "app_mem_usage.h"
 
 #define MAX_COMPONENTS 16
@@ -152,6 +153,45 @@ linux_get_rss_mem_used_by_app(void)
 
 /* XXX, BSD 4.3: getrusage() -> ru_ixrss ? */
 
+/* Memory held by the global wmem scopes */
+
+static const struct {
+	const char *name;
+	wmem_allocator_t *(*scope)(void);
+} wmem_scopes[] = {
+	{ "Packet scope", wmem_packet_scope },
+	{ "File scope",   wmem_file_scope },
+	{ "Epan scope",   wmem_epan_scope },
+};
+
+static gsize
+wmem_scope_get_mem(guint idx)
+{
+	wmem_allocator_stats_t stats;
+
+	wmem_allocator_get_stats(wmem_scopes[idx].scope(), &stats);
+
+	return stats.chunk_bytes;
+}
+
+static gsize
+packet_scope_get_mem(void)
+{
+	return wmem_scope_get_mem(0);
+}
+
+static gsize
+file_scope_get_mem(void)
+{
+	return wmem_scope_get_mem(1);
+}
+
+static gsize
+epan_scope_get_mem(void)
+{
+	return wmem_scope_get_mem(2);
+}
+
 #ifdef get_total_mem_used_by_app
 static const ws_mem_usage_t total_usage = { "Total", get_total_mem_used_by_app, NULL };
 #endif
@@ -160,6 +200,10 @@ static const ws_mem_usage_t total_usage = { "Total", get_total_mem_used_by_app,
 static const ws_mem_usage_t rss_usage = { "RSS", get_rss_mem_used_by_app, NULL };
 #endif
 
+static const ws_mem_usage_t packet_scope_usage = { "Packet scope", packet_scope_get_mem, NULL };
+static const ws_mem_usage_t file_scope_usage = { "File scope", file_scope_get_mem, NULL };
+static const ws_mem_usage_t epan_scope_usage = { "Epan scope", epan_scope_get_mem, NULL };
+
 static const ws_mem_usage_t *memory_components[MAX_COMPONENTS] = {
 #ifdef get_total_mem_used_by_app
 	&total_usage,
@@ -167,9 +211,12 @@ static const ws_mem_usage_t *memory_components[MAX_COMPONENTS] = {
 #ifdef get_rss_mem_used_by_app
 	&rss_usage,
 #endif
+	&packet_scope_usage,
+	&file_scope_usage,
+	&epan_scope_usage,
 };
 
-static guint memory_register_num = 0
+static guint memory_register_num = 3
 #ifdef get_total_mem_used_by_app
 	+ 1
 #endif
@@ -201,6 +248,18 @@ memory_usage_get(guint idx, gsize *value)
 	return memory_components[idx]->name;
 }
 
+const char *
+memory_usage_get_scope_stats(guint idx, wmem_allocator_stats_t *stats)
+{
+	if (idx >= G_N_ELEMENTS(wmem_scopes))
+		return NULL;
+
+	if (stats)
+		wmem_allocator_get_stats(wmem_scopes[idx].scope(), stats);
+
+	return wmem_scopes[idx].name;
+}
+
 void
 memory_usage_gc(void)
 {
@@ -24,6 +24,8 @@
 
 #include "ws_symbol_export.h"
 
+#include <epan/wmem/wmem.h>
+
 typedef struct {
 	const char *name;
 	gsize (*fetch)(void);
@@ -37,4 +39,8 @@ WS_DLL_PUBLIC void memory_usage_gc(void);
 
 WS_DLL_PUBLIC const char *memory_usage_get(guint idx, gsize *value);
 
+/* Get the allocator statistics of the idx-th global wmem scope (packet,
+ * file, epan). Returns the name of the scope, or NULL past the last one. */
+WS_DLL_PUBLIC const char *memory_usage_get_scope_stats(guint idx, wmem_allocator_stats_t *stats);
+
 #endif /* APP_MEM_USAGE_H */
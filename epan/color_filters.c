@@ -64,6 +64,9 @@ static gboolean filters_enabled = TRUE;
  */
 static gboolean tmp_colors_set = FALSE;
 
+/* Bumped whenever the active filters change */
+static guint color_filters_changes = 0;
+
 /* Create a new filter */
 color_filter_t *
 color_filter_new(const gchar *name,          /* The name of the filter to create */
@@ -180,6 +183,7 @@ color_filters_set_tmp(guint8 filt_nr, const gchar *filter, gboolean disabled, gc
                 colorf->filter_text = g_strdup(tmpfilter);
                 colorf->c_colorfilter = compiled_filter;
                 colorf->disabled = ((i!=filt_nr) ? TRUE : disabled);
+                color_filters_changes++;
                 /* Remember that there are now temporary coloring filters set */
                 if( filter )
                     tmp_colors_set = TRUE;
@@ -299,6 +303,8 @@ color_filters_get(gchar** err_msg, color_filter_add_cb_func add_cb)
     FILE     *f;
     int       ret;
 
+    color_filters_changes++;
+
     /* start the list with the temporary colorizing rules */
     color_filters_add_tmp(&color_filter_list);
 
@@ -447,6 +453,7 @@ color_filters_apply(GSList *tmp_cfl, GSList *edit_cfl, gchar** err_msg)
     gboolean ret = TRUE;
 
     *err_msg = NULL;
+    color_filters_changes++;
 
     /* "move" old entries to the deleted list
      * we must keep them until the dissection no longer needs them */
@@ -489,6 +496,12 @@ tmp_color_filters_used(void)
     return tmp_colors_set;
 }
 
+guint
+color_filters_generation(void)
+{
+    return color_filters_changes;
+}
+
 /* prepare the epan_dissect_t for the filter */
 static void
 prime_edt(gpointer data, gpointer user_data)
@@ -82,6 +82,13 @@ WS_DLL_PUBLIC gboolean color_filters_used(void);
  */
 WS_DLL_PUBLIC gboolean tmp_color_filters_used(void);
 
+/** Get a number which changes whenever the active color filters do,
+ * so that results which depend on the coloring can be thrown away.
+ *
+ * @return the current generation of the color filters
+ */
+WS_DLL_PUBLIC guint color_filters_generation(void);
+
 /** Set the filter string of a temporary color filter
  *
  * @param filt_nr a number 1-10 pointing to a temporary color
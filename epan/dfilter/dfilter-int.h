@@ -38,6 +38,7 @@ struct epan_dfilter {
 	int		*interesting_fields;
 	int		num_interesting_fields;
 	GPtrArray	*deprecated;
+	gchar		*expanded_text;
 };
 
 typedef struct {
@@ -162,6 +162,7 @@ dfilter_free(dfilter_t *df)
 
 	g_free(df->registers);
 	g_free(df->attempted_load);
+	g_free(df->expanded_text);
 	g_free(df);
 }
 
@@ -368,6 +369,9 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		/* Add any deprecated items */
 		dfilter->deprecated = deprecated;
 
+		/* Keep the text for callers caching results per filter */
+		dfilter->expanded_text = g_strdup(expanded_text);
+
 		/* And give it to the user. */
 		*dfp = dfilter;
 	}
@@ -444,6 +448,12 @@ dfilter_deprecated_tokens(dfilter_t *df) {
 	return NULL;
 }
 
+const gchar *
+dfilter_text(const dfilter_t *df)
+{
+	return df->expanded_text;
+}
+
 void
 dfilter_dump(dfilter_t *df)
 {
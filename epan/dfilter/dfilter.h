@@ -88,6 +88,11 @@ WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
 
+/* Return the text of the filter, with macros expanded */
+WS_DLL_PUBLIC
+const gchar *
+dfilter_text(const dfilter_t *df);
+
 /* Print bytecode of dfilter to stdout */
 WS_DLL_PUBLIC
 void
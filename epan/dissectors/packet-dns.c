@@ -1132,6 +1132,86 @@ qname_labels_count(const guchar* name, guint name_len)
     return labels;
 }
 
+/*
+ * Per-message cache of decoded names.
+ *
+ * Compression pointers in a message usually point at a handful of common
+ * suffixes (the zone name, the owner of an RRset, ...), so every name that
+ * is decoded successfully records the decoded suffix starting at each of its
+ * labels. A later name that points at one of those labels, or that starts
+ * there, then copies the cached suffix instead of following the pointer
+ * chain again. Entries are keyed by the tvb, the start of the DNS message
+ * (the base for pointers) and the offset, and live in packet scope.
+ */
+typedef struct {
+  const tvbuff_t *tvb;
+  int             dns_data_offset;
+  int             offset;
+} dns_name_cache_key_t;
+
+typedef struct {
+  const guchar *name;      /* decoded suffix, not NUL-terminated */
+  guint         name_len;
+  int           consumed;  /* bytes used in place from the offset, or -1 if unknown */
+} dns_name_cache_entry_t;
+
+static wmem_map_t *dns_name_cache = NULL;
+
+/* Maximum number of labels of one name whose suffixes are cached */
+#define DNS_NAME_CACHE_MAX_LABELS 64
+
+static guint
+dns_name_cache_hash(gconstpointer k)
+{
+  const dns_name_cache_key_t *key = (const dns_name_cache_key_t *)k;
+
+  return g_direct_hash(key->tvb) ^ ((guint)key->dns_data_offset << 16) ^ (guint)key->offset;
+}
+
+static gboolean
+dns_name_cache_equal(gconstpointer k1, gconstpointer k2)
+{
+  const dns_name_cache_key_t *key1 = (const dns_name_cache_key_t *)k1;
+  const dns_name_cache_key_t *key2 = (const dns_name_cache_key_t *)k2;
+
+  return key1->tvb == key2->tvb && key1->dns_data_offset == key2->dns_data_offset &&
+         key1->offset == key2->offset;
+}
+
+static const dns_name_cache_entry_t *
+dns_name_cache_lookup(tvbuff_t *tvb, int dns_data_offset, int offset)
+{
+  dns_name_cache_key_t key;
+
+  key.tvb = tvb;
+  key.dns_data_offset = dns_data_offset;
+  key.offset = offset;
+  return (const dns_name_cache_entry_t *)wmem_map_lookup(dns_name_cache, &key);
+}
+
+static void
+dns_name_cache_insert(tvbuff_t *tvb, int dns_data_offset, int offset,
+    const guchar *name, guint name_len, int consumed)
+{
+  dns_name_cache_key_t   *key;
+  dns_name_cache_entry_t *entry;
+
+  key = wmem_new(wmem_packet_scope(), dns_name_cache_key_t);
+  key->tvb = tvb;
+  key->dns_data_offset = dns_data_offset;
+  key->offset = offset;
+  if (wmem_map_lookup(dns_name_cache, key) != NULL) {
+    wmem_free(wmem_packet_scope(), key);
+    return;
+  }
+
+  entry = wmem_new(wmem_packet_scope(), dns_name_cache_entry_t);
+  entry->name = name;
+  entry->name_len = name_len;
+  entry->consumed = consumed;
+  wmem_map_insert(dns_name_cache, key, entry);
+}
+
 /* This function returns the number of bytes consumed and the expanded string
  * in *name.
  * The string is allocated with wmem_packet_scope scope and does not need to be freed.
@@ -1142,21 +1222,48 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
     const guchar **name, guint* name_len)
 {
   int     start_offset    = offset;
+  guchar  buf[MAXDNAME];
   guchar *np;
+  guchar *name_buf;
   int     len             = -1;
   int     pointers_count  = 0;
   int     component_len;
   int     indir_offset;
   int     maxname;
+  const dns_name_cache_entry_t *cached;
+  /* Label offsets, the position of their suffix in buf and whether they
+     precede the first pointer, for the cache */
+  int     label_offsets[DNS_NAME_CACHE_MAX_LABELS];
+  guint   label_positions[DNS_NAME_CACHE_MAX_LABELS];
+  gboolean label_in_place[DNS_NAME_CACHE_MAX_LABELS];
+  int     label_count     = 0;
+  /* The cache is only used for unbounded names, with no extended labels */
+  gboolean cacheable      = (max_len == 0 && dns_name_cache != NULL);
+  int     i;
 
   const int min_len = 1;        /* Minimum length of encoded name (for root) */
         /* If we're about to return a value (probably negative) which is less
          * than the minimum length, we're looking at bad data and we're liable
          * to put the dissector into a loop.  Instead we throw an exception */
 
+  if (cacheable) {
+    cached = dns_name_cache_lookup(tvb, dns_data_offset, offset);
+    if (cached != NULL && cached->consumed >= 0) {
+      len = cached->consumed;
+      *name_len = cached->name_len;
+      name_buf = (guchar *)wmem_alloc(wmem_packet_scope(), cached->name_len + 1);
+      memcpy(name_buf, cached->name, cached->name_len);
+      name_buf[cached->name_len] = '\0';
+      *name = name_buf;
+      if ((len < min_len) || (len > min_len && *name_len == 0)) {
+        THROW(ReportedBoundsError);
+      }
+      return len;
+    }
+  }
+
   maxname=MAXDNAME;
-  np=(guchar *)wmem_alloc(wmem_packet_scope(), maxname);
-  *name=np;
+  np=buf;
   (*name_len) = 0;
 
   maxname--;   /* reserve space for the trailing '\0' */
@@ -1173,7 +1280,7 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
 
       case 0x00:
         /* Label */
-        if (np != *name) {
+        if (np != buf) {
           /* Not the first component - put in a '.'. */
           if (maxname > 0) {
             *np++ = '.';
@@ -1181,6 +1288,12 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
             maxname--;
           }
         }
+        if (cacheable && label_count < DNS_NAME_CACHE_MAX_LABELS) {
+          label_offsets[label_count] = offset - 1;
+          label_positions[label_count] = *name_len;
+          label_in_place[label_count] = (len < 0);
+          label_count++;
+        }
         while (component_len > 0) {
           if (max_len && offset - start_offset > max_len - 1) {
             THROW(ReportedBoundsError);
@@ -1197,6 +1310,7 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
 
       case 0x40:
         /* Extended label (RFC 2673) */
+        cacheable = FALSE;
         switch (component_len & 0x3f) {
 
           case 0x01:
@@ -1213,12 +1327,15 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
             if (maxname > 0) {
               print_len = g_snprintf(np, maxname + 1, "\\[x");
               if (print_len <= maxname) {
-                np      += print_len;
-                maxname -= print_len;
+                np        += print_len;
+                maxname   -= print_len;
+                *name_len += print_len;
               } else {
-                /* Nothing printed, as there's no room.
-                   Suppress all subsequent printing. */
-                maxname = 0;
+                /* Only part of it fit; keep that much and
+                   suppress all subsequent printing. */
+                np        += maxname;
+                *name_len += maxname;
+                maxname    = 0;
               }
             }
             while (label_len--) {
@@ -1226,12 +1343,15 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
                 print_len = g_snprintf(np, maxname + 1, "%02x",
                                        tvb_get_guint8(tvb, offset));
                 if (print_len <= maxname) {
-                  np      += print_len;
-                  maxname -= print_len;
+                  np        += print_len;
+                  maxname   -= print_len;
+                  *name_len += print_len;
                 } else {
-                  /* Nothing printed, as there's no room.
-                     Suppress all subsequent printing. */
-                  maxname = 0;
+                  /* Only part of it fit; keep that much and
+                     suppress all subsequent printing. */
+                  np        += maxname;
+                  *name_len += maxname;
+                  maxname    = 0;
                 }
               }
               offset++;
@@ -1239,12 +1359,15 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
             if (maxname > 0) {
               print_len = g_snprintf(np, maxname + 1, "/%d]", bit_count);
               if (print_len <= maxname) {
-                np      += print_len;
-                maxname -= print_len;
+                np        += print_len;
+                maxname   -= print_len;
+                *name_len += print_len;
               } else {
-                /* Nothing printed, as there's no room.
-                   Suppress all subsequent printing. */
-                maxname = 0;
+                /* Only part of it fit; keep that much and
+                   suppress all subsequent printing. */
+                np        += maxname;
+                *name_len += maxname;
+                maxname    = 0;
               }
             }
           }
@@ -1294,11 +1417,28 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
         }
 
         offset = indir_offset;
+
+        /* If the rest of the name was already decoded, append it */
+        if (cacheable) {
+          cached = dns_name_cache_lookup(tvb, dns_data_offset, indir_offset);
+          if (cached != NULL && cached->name_len + (np != buf ? 1 : 0) <= (guint)maxname) {
+            if (np != buf && cached->name_len > 0) {
+              *np++ = '.';
+              (*name_len)++;
+              maxname--;
+            }
+            memcpy(np, cached->name, cached->name_len);
+            np        += cached->name_len;
+            *name_len += cached->name_len;
+            maxname   -= cached->name_len;
+            goto done;
+          }
+        }
         break;   /* now continue processing from there */
     }
   }
 
-  *np = '\0';
+done:
   /* If "len" is negative, we haven't seen a pointer, and thus haven't
      set the length, so set it. */
   if (len < 0) {
@@ -1307,6 +1447,22 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
   if ((len < min_len) || (len > min_len && *name_len == 0)) {
     THROW(ReportedBoundsError);
   }
+
+  /* Only allocate what the name actually needs */
+  name_buf = (guchar *)wmem_alloc(wmem_packet_scope(), *name_len + 1);
+  memcpy(name_buf, buf, *name_len);
+  name_buf[*name_len] = '\0';
+  *name = name_buf;
+
+  /* Remember the suffix at each label, unless the name was truncated */
+  if (cacheable && maxname > 0) {
+    for (i = 0; i < label_count; i++) {
+      /* Labels before the first pointer are in place in the name */
+      dns_name_cache_insert(tvb, dns_data_offset, label_offsets[i],
+          name_buf + label_positions[i], *name_len - label_positions[i],
+          label_in_place[i] ? len - (label_offsets[i] - start_offset) : -1);
+    }
+  }
   return len;
 }
 
@@ -5626,6 +5782,9 @@ proto_register_dns(void)
   dns_handle = register_dissector("dns", dissect_dns, proto_dns);
 
   dns_tap = register_tap("dns");
+
+  dns_name_cache = wmem_map_new_autoreset(wmem_epan_scope(), wmem_packet_scope(),
+      dns_name_cache_hash, dns_name_cache_equal);
 }
 
 /*
@@ -1871,82 +1871,135 @@ static dissector_handle_t bssgp_handle;
 static dissector_table_t bssap_pdu_type_table;
 guint32 gtp_session_count;
 
+/* GTP session tracking.
+ *
+ * Control messages announce <address, TEID> tuples (F-TEIDs, GSN addresses)
+ * which later messages are matched against to find their session. The
+ * tuples are kept in a hash map keyed by the binary address and TEID; each
+ * key holds a chain of announcements, newest first. Every announcement is
+ * also linked from the frame that made it, and every session keeps the list
+ * of its frames, so that dropping the information of a frame or of a whole
+ * session never needs a scan of all the tracked state.
+ */
+
 /* Relation between frame -> session */
-GHashTable* session_table;
+static wmem_map_t *session_table;
+/* Relation between session -> frames (wmem_array_t of guint32) */
+static wmem_map_t *session_frames;
 /* Relation between <teid,ip> -> frame */
-wmem_tree_t* frame_tree;
+static wmem_map_t *teid_table;
+/* Relation between frame -> the <teid,ip> announcements it made */
+static wmem_map_t *teid_frame_table;
+
+#define GTP_TEID_KEY_ADDR_LEN 16
+
+typedef struct gtp_teid_key {
+    guint32 teid;
+    guint32 addr_type;
+    guint32 addr_len;
+    guint8  addr[GTP_TEID_KEY_ADDR_LEN];
+} gtp_teid_key_t;
 
 typedef struct gtp_info {
     guint32 teid;
     guint32 frame;
+    gtp_teid_key_t  *key;
+    struct gtp_info *next_in_key;   /* older announcement of the same tuple */
+    struct gtp_info *next_in_frame; /* other tuple announced by the same frame */
 } gtp_info_t;
 
+static guint
+gtp_teid_key_hash(gconstpointer k)
+{
+    const gtp_teid_key_t *key = (const gtp_teid_key_t *)k;
+
+    return wmem_strong_hash((const guint8 *)key->addr, key->addr_len) ^ key->teid;
+}
+
+static gboolean
+gtp_teid_key_equal(gconstpointer k1, gconstpointer k2)
+{
+    const gtp_teid_key_t *key1 = (const gtp_teid_key_t *)k1;
+    const gtp_teid_key_t *key2 = (const gtp_teid_key_t *)k2;
+
+    return key1->teid == key2->teid && key1->addr_type == key2->addr_type &&
+           key1->addr_len == key2->addr_len &&
+           memcmp(key1->addr, key2->addr, key1->addr_len) == 0;
+}
+
+/* Fills in a tuple key; returns FALSE for addresses that cannot be tracked */
+static gboolean
+gtp_teid_key_set(gtp_teid_key_t *key, const address *ip, guint32 teid)
+{
+    if (ip->len <= 0 || ip->len > GTP_TEID_KEY_ADDR_LEN)
+        return FALSE;
+
+    key->teid = teid;
+    key->addr_type = ip->type;
+    key->addr_len = ip->len;
+    memcpy(key->addr, ip->data, ip->len);
+    return TRUE;
+}
+
 /* GTP Session funcs*/
 guint32
 get_frame(address ip, guint32 teid, guint32 *frame) {
-    gboolean found = FALSE;
-    wmem_list_frame_t *elem;
+    gtp_teid_key_t key;
     gtp_info_t *info;
-    wmem_list_t *info_list;
-    gchar *ip_str;
-
-    /* First we get the teid list*/
-    ip_str = address_to_str(wmem_packet_scope(), &ip);
-    info_list = (wmem_list_t*)wmem_tree_lookup_string(frame_tree, ip_str, 0);
-    if (info_list != NULL) {
-        elem = wmem_list_head(info_list);
-        while (!found && elem) {
-            info = (gtp_info_t*)wmem_list_frame_data(elem);
-            if (teid == info->teid) {
-                *frame = info->frame;
-                return 1;
-            }
-            elem = wmem_list_frame_next(elem);
-        }
-    }
-    return 0;
-}
 
-static void
-call_foreach_ip(const void *key _U_, void *value, void *data){
-    wmem_list_frame_t * elem;
-    wmem_list_t *info_list = (wmem_list_t *)value;
-    gtp_info_t *info;
-    guint32* frame = (guint32*)data;
-
-    /* We loop over the <teid, frame> list */
-    elem = wmem_list_head(info_list);
-    while (elem) {
-        info = (gtp_info_t*)wmem_list_frame_data(elem);
-        if (info->frame == *frame) {
-            wmem_list_frame_t * del = elem;
-            /* proceed to next request */
-            elem = wmem_list_frame_next(elem);
-            /* If we find the frame we remove its information from the list */
-            wmem_list_remove_frame(info_list, del);
-            wmem_free(wmem_file_scope(), info);
-        }
-        else {
-            elem = wmem_list_frame_next(elem);
-        }
+    if (!gtp_teid_key_set(&key, &ip, teid))
+        return 0;
+
+    info = (gtp_info_t *)wmem_map_lookup(teid_table, &key);
+    if (info != NULL) {
+        *frame = info->frame;
+        return 1;
     }
+    return 0;
 }
 
 void
 remove_frame_info(guint32 *f) {
-    /* For each ip node */
-    wmem_tree_foreach(frame_tree, (wmem_foreach_func)call_foreach_ip, (void *)f);
+    gtp_info_t *info, *head, *prev;
+
+    /* We remove every <teid, ip> announced by the frame */
+    for (info = (gtp_info_t *)wmem_map_remove(teid_frame_table, GUINT_TO_POINTER(*f));
+         info != NULL; info = info->next_in_frame) {
+        head = (gtp_info_t *)wmem_map_lookup(teid_table, info->key);
+        if (head == info) {
+            if (info->next_in_key) {
+                wmem_map_insert(teid_table, info->key, info->next_in_key);
+            } else {
+                wmem_map_remove(teid_table, info->key);
+            }
+        } else {
+            for (prev = head; prev != NULL; prev = prev->next_in_key) {
+                if (prev->next_in_key == info) {
+                    prev->next_in_key = info->next_in_key;
+                    break;
+                }
+            }
+        }
+    }
 }
 
 void
 add_gtp_session(guint32 frame, guint32 session) {
-    guint32 *f, *session_count;
+    wmem_array_t *frames;
+
+    wmem_map_insert(session_table, GUINT_TO_POINTER(frame), GUINT_TO_POINTER(session));
 
-    f = wmem_new0(wmem_file_scope(), guint32);
-    session_count = wmem_new0(wmem_file_scope(), guint32);
-    *f = frame;
-    *session_count = session;
-    g_hash_table_insert(session_table, f, session_count);
+    frames = (wmem_array_t *)wmem_map_lookup(session_frames, GUINT_TO_POINTER(session));
+    if (frames == NULL) {
+        frames = wmem_array_new(wmem_file_scope(), sizeof(guint32));
+        wmem_map_insert(session_frames, GUINT_TO_POINTER(session), frames);
+    }
+    wmem_array_append_one(frames, frame);
+}
+
+guint32
+get_gtp_session(guint32 frame) {
+    return GPOINTER_TO_UINT(wmem_map_lookup(session_table, GUINT_TO_POINTER(frame)));
 }
 
 gboolean
@@ -1979,67 +2032,56 @@ ip_exists(address ip, wmem_list_t *ip_list) {
     return found;
 }
 
-static gboolean
-info_exists(gtp_info_t *wanted, wmem_list_t *info_list) {
-    wmem_list_frame_t *elem;
-    gtp_info_t *info;
-    gboolean found;
-    found = FALSE;
-    elem = wmem_list_head(info_list);
-    while (!found && elem) {
-        info = (gtp_info_t*)wmem_list_frame_data(elem);
-        found = wanted->teid == info->teid;
-        elem = wmem_list_frame_next(elem);
-    }
-    return found;
-}
-
 void
 fill_map(wmem_list_t *teid_list, wmem_list_t *ip_list, guint32 frame) {
     wmem_list_frame_t *elem_ip, *elem_teid;
-    gtp_info_t *gtp_info;
-    wmem_list_t * info_list; /* List of <teids,frames>*/
-    guint32 *f, *session, *fr, *session_count;
-    GHashTableIter iter;
-    guint32 teid;
-    gchar *ip;
+    wmem_array_t *frames;
+    gtp_info_t *gtp_info, *head;
+    gtp_teid_key_t key, *new_key;
+    guint32 session, fr, i;
 
     elem_ip = wmem_list_head(ip_list);
     while (elem_ip) {
-        ip = address_to_str(wmem_file_scope(), (address*)wmem_list_frame_data(elem_ip));
-        /* We check if a teid list exists for this ip */
-        info_list = (wmem_list_t*)wmem_tree_lookup_string(frame_tree, ip, 0);
-        if (info_list == NULL) {
-            info_list = wmem_list_new(wmem_file_scope());
-        }
         /* We loop over the teid list */
         elem_teid = wmem_list_head(teid_list);
         while (elem_teid) {
-            teid = *(guint32*)wmem_list_frame_data(elem_teid);
-            f = wmem_new0(wmem_file_scope(), guint32);
-            *f = frame;
-            gtp_info = wmem_new0(wmem_file_scope(), gtp_info_t);
-            gtp_info->teid = teid;
-            gtp_info->frame = *f;
-            if (info_exists(gtp_info, info_list)) {
+            if (!gtp_teid_key_set(&key, (address*)wmem_list_frame_data(elem_ip),
+                                  *(guint32*)wmem_list_frame_data(elem_teid))) {
+                break;
+            }
+            if (wmem_map_lookup(teid_table, &key) != NULL) {
                 /* If the teid and ip already existed, that means that we need to remove old info about that session */
                 /* We look for its session ID */
-                session = (guint32 *)g_hash_table_lookup(session_table, f);
+                session = get_gtp_session(frame);
                 if (session) {
-                    g_hash_table_iter_init(&iter, session_table);
-                    while (g_hash_table_iter_next(&iter, (gpointer*)&fr, (gpointer*)&session_count)) {
-                        /* If the msg has the same session ID and it's not the upd req we have to remove its info */
-                        if (*session_count == *session) {
-                            /* If it's the session we are looking for, we remove all the frame information */
-                            remove_frame_info(fr);
-                        }
+                    /* If it's the session we are looking for, we remove all the frame information */
+                    frames = (wmem_array_t *)wmem_map_lookup(session_frames, GUINT_TO_POINTER(session));
+                    for (i = 0; frames && i < wmem_array_get_count(frames); i++) {
+                        fr = *(guint32 *)wmem_array_index(frames, i);
+                        remove_frame_info(&fr);
                     }
                 }
             }
-            wmem_list_prepend(info_list, gtp_info);
+
+            /* The removal above may have dropped the whole chain */
+            head = (gtp_info_t *)wmem_map_lookup(teid_table, &key);
+            if (head != NULL) {
+                new_key = head->key;
+            } else {
+                new_key = (gtp_teid_key_t *)wmem_memdup(wmem_file_scope(), &key, sizeof key);
+            }
+
+            gtp_info = wmem_new0(wmem_file_scope(), gtp_info_t);
+            gtp_info->teid = key.teid;
+            gtp_info->frame = frame;
+            gtp_info->key = new_key;
+            gtp_info->next_in_key = head;
+            gtp_info->next_in_frame = (gtp_info_t *)wmem_map_lookup(teid_frame_table, GUINT_TO_POINTER(frame));
+            wmem_map_insert(teid_table, new_key, gtp_info);
+            wmem_map_insert(teid_frame_table, GUINT_TO_POINTER(frame), gtp_info);
+
             elem_teid = wmem_list_frame_next(elem_teid);
         }
-        wmem_tree_insert_string(frame_tree, ip, info_list, 0);
         elem_ip = wmem_list_frame_next(elem_ip);
     }
 }
@@ -3415,7 +3457,7 @@ static gtp_msg_hash_t *
 gtp_match_response(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, gint seq_nr, guint msgtype, gtp_conv_info_t *gtp_info, guint8 last_cause)
 {
     gtp_msg_hash_t   gcr, *gcrp = NULL;
-    guint32 *session;
+    guint32 session;
     gcr.seq_nr=seq_nr;
 
     switch (msgtype) {
@@ -3520,11 +3562,11 @@ gtp_match_response(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, gint
                 if (!PINFO_FD_VISITED(pinfo) && gtp_version == 1) {
                     /* GTP session */
                     /* If it does not have any session assigned yet */
-                    session = (guint32 *)g_hash_table_lookup(session_table, &pinfo->num);
+                    session = get_gtp_session(pinfo->num);
                     if (!session) {
-                        session = (guint32 *)g_hash_table_lookup(session_table, &gcrp->req_frame);
-                        if (session != NULL) {
-                            add_gtp_session(pinfo->num, *session);
+                        session = get_gtp_session(gcrp->req_frame);
+                        if (session != 0) {
+                            add_gtp_session(pinfo->num, session);
                         }
                     }
 
@@ -8380,14 +8422,14 @@ decode_gtp_unknown(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree *
 static void
 track_gtp_session(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, gtp_hdr_t * gtp_hdr, wmem_list_t *teid_list, wmem_list_t *ip_list, guint32 last_teid, address last_ip)
 {
-    guint32 *session, frame_teid_cp;
+    guint32 session, frame_teid_cp;
     proto_item *it;
 
     /* GTP session */
     if (tree) {
-        session = (guint32*)g_hash_table_lookup(session_table, &pinfo->num);
+        session = get_gtp_session(pinfo->num);
         if (session) {
-            it = proto_tree_add_uint(tree, hf_gtp_session, tvb, 0, 0, *session);
+            it = proto_tree_add_uint(tree, hf_gtp_session, tvb, 0, 0, session);
             PROTO_ITEM_SET_GENERATED(it);
         }
     }
@@ -8395,7 +8437,7 @@ track_gtp_session(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, gtp_hd
 
     if (!PINFO_FD_VISITED(pinfo) && gtp_version == 1) {
         /* If the message does not have any session ID */
-        session = (guint32*)g_hash_table_lookup(session_table, &pinfo->num);
+        session = get_gtp_session(pinfo->num);
         if (!session) {
             /* If the message is not a CPDPCRES, CPDPCREQ, UPDPREQ, UPDPRES then we remove its information from teid and ip lists */
             if ((gtp_hdr->message != GTP_MSG_CREATE_PDP_RESP && gtp_hdr->message != GTP_MSG_CREATE_PDP_REQ && gtp_hdr->message != GTP_MSG_UPDATE_PDP_RESP
@@ -8413,10 +8455,10 @@ track_gtp_session(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, gtp_hd
                 /* If this is an error indication then we have to check the session id that belongs to the message with the same data teid and ip */
                 if (gtp_hdr->message == GTP_MSG_ERR_IND) {
                     if (get_frame(last_ip, last_teid, &frame_teid_cp) == 1) {
-                        session = (guint32*)g_hash_table_lookup(session_table, &frame_teid_cp);
-                        if (session != NULL) {
+                        session = get_gtp_session(frame_teid_cp);
+                        if (session != 0) {
                             /* We add the corresponding session to the session list*/
-                            add_gtp_session(pinfo->num, *session);
+                            add_gtp_session(pinfo->num, session);
                         }
                     }
                 }
@@ -8429,10 +8471,10 @@ track_gtp_session(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, gtp_hd
                     copy_address(&gsn_address, dst_address);
                     if ((get_frame(gsn_address, (guint32)gtp_hdr->teid, &frame_teid_cp) == 1)) {
                         /* Then we have to set its session ID */
-                        session = (guint32*)g_hash_table_lookup(session_table, &frame_teid_cp);
-                        if (session != NULL) {
+                        session = get_gtp_session(frame_teid_cp);
+                        if (session != 0) {
                             /* We add the corresponding session to the list so that when a response came we can associate its session ID*/
-                            add_gtp_session(pinfo->num, *session);
+                            add_gtp_session(pinfo->num, session);
                         }
                     }
                 }
@@ -8949,8 +8991,6 @@ static void
 gtp_init(void)
 {
     gtp_session_count = 1;
-    session_table = g_hash_table_new(g_int_hash, g_int_equal);
-    frame_tree = wmem_tree_new(wmem_file_scope());
 }
 
 static void
@@ -8973,11 +9013,6 @@ gtp_cleanup(void)
 
     /* Free up state attached to the gtp session structures */
     gtp_info_items = NULL;
-
-    if (session_table != NULL) {
-        g_hash_table_destroy(session_table);
-    }
-    session_table = NULL;
 }
 
 void
@@ -10169,6 +10204,12 @@ proto_register_gtp(void)
 
     register_init_routine(gtp_init);
     register_cleanup_routine(gtp_cleanup);
+
+    session_table = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
+    session_frames = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
+    teid_table = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), gtp_teid_key_hash, gtp_teid_key_equal);
+    teid_frame_table = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
+
     gtp_tap = register_tap("gtp");
     gtpv1_tap = register_tap("gtpv1");
 
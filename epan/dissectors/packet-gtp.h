@@ -158,18 +158,15 @@ typedef struct session_args {
     guint8 last_cause;
 } session_args_t;
 
-/* Relation between frame -> session */
-extern GHashTable* session_table;
-
-/* Relation between <teid,ip> -> frame */
-extern wmem_tree_t* frame_tree;
-
 guint32 get_frame(address ip, guint32 teid, guint32 *frame);
 
 void remove_frame_info(guint32 *f);
 
 void add_gtp_session(guint32 frame, guint32 session);
 
+/* Returns the session ID of a frame, or 0 if it has none */
+guint32 get_gtp_session(guint32 frame);
+
 gboolean teid_exists(guint32 teid, wmem_list_t *teid_list);
 
 gboolean ip_exists(address ip, wmem_list_t *ip_list);
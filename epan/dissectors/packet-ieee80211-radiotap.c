@@ -26,6 +26,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <string.h>
 
 #include <epan/packet.h>
 #include <epan/capture_dissectors.h>
@@ -662,6 +663,123 @@ capture_radiotap(const guchar * pd, int offset, int len, capture_packet_info_t *
 	return call_capture_dissector(ieee80211_cap_handle, pd, offset + it_len, len, cpinfo, pseudo_header);
 }
 
+/*
+ * Field layout cache.
+ *
+ * Where the fields of the radiotap namespace sit in the header only depends
+ * on the present bitmaps (alignment is relative to the start of the header),
+ * so the walk done by the iterator is recorded once per distinct set of
+ * present words and replayed for the following packets. Headers using vendor
+ * namespaces are not cached, as their layout also depends on the skip length
+ * carried in the data.
+ */
+#define RADIOTAP_LAYOUT_MAX_WORDS	8
+#define RADIOTAP_LAYOUT_MAX_FIELDS	128
+#define RADIOTAP_LAYOUT_MAX_ENTRIES	1024
+
+typedef struct {
+	guint8  index;		/* IEEE80211_RADIOTAP_* */
+	guint8  size;
+	guint16 offset;		/* from the start of the header */
+} radiotap_layout_field_t;
+
+typedef struct {
+	/* key */
+	guint32  present[RADIOTAP_LAYOUT_MAX_WORDS];
+	guint    n_present;
+	gboolean bit14_fcs;
+	/* header length the iterator needed to walk all fields */
+	guint    min_length;
+	guint    n_fields;
+	radiotap_layout_field_t *fields;
+} radiotap_layout_t;
+
+static wmem_map_t *radiotap_layouts = NULL;
+
+static guint
+radiotap_layout_hash(gconstpointer k)
+{
+	const radiotap_layout_t *key = (const radiotap_layout_t *)k;
+	guint hash = key->bit14_fcs;
+	guint i;
+
+	for (i = 0; i < key->n_present; i++)
+		hash = hash * 31 + key->present[i];
+	return hash;
+}
+
+static gboolean
+radiotap_layout_equal(gconstpointer k1, gconstpointer k2)
+{
+	const radiotap_layout_t *key1 = (const radiotap_layout_t *)k1;
+	const radiotap_layout_t *key2 = (const radiotap_layout_t *)k2;
+
+	return key1->n_present == key2->n_present &&
+	    key1->bit14_fcs == key2->bit14_fcs &&
+	    memcmp(key1->present, key2->present, key1->n_present * sizeof(guint32)) == 0;
+}
+
+/*
+ * Returns the cached field layout for this header, recording it with a copy
+ * of the (initialized) iterator if it isn't known yet. Returns NULL if the
+ * header can't use a cached layout; the caller then walks the iterator.
+ */
+static const radiotap_layout_t *
+radiotap_get_layout(const guint8 *data, guint length,
+		    const struct ieee80211_radiotap_iterator *iter)
+{
+	radiotap_layout_t key, *layout;
+	radiotap_layout_field_t fields[RADIOTAP_LAYOUT_MAX_FIELDS];
+	struct ieee80211_radiotap_iterator walk;
+	guint32 present;
+	guint n_fields = 0;
+	int err;
+
+	/* collect the present words */
+	key.n_present = 0;
+	key.bit14_fcs = radiotap_bit14_fcs;
+	do {
+		if (key.n_present == RADIOTAP_LAYOUT_MAX_WORDS)
+			return NULL;
+		present = pletoh32(data + 4 + 4 * key.n_present);
+		if (present & BIT(IEEE80211_RADIOTAP_VENDOR_NAMESPACE))
+			return NULL;
+		key.present[key.n_present++] = present;
+	} while (present & BIT(IEEE80211_RADIOTAP_EXT));
+
+	layout = (radiotap_layout_t *)wmem_map_lookup(radiotap_layouts, &key);
+	if (layout)
+		return (length >= layout->min_length) ? layout : NULL;
+
+	if (wmem_map_size(radiotap_layouts) >= RADIOTAP_LAYOUT_MAX_ENTRIES)
+		return NULL;
+
+	/* first header with these present words: record the walk */
+	walk = *iter;
+	while (!(err = ieee80211_radiotap_iterator_next(&walk))) {
+		if (n_fields == RADIOTAP_LAYOUT_MAX_FIELDS || !walk.is_radiotap_ns)
+			return NULL;
+		fields[n_fields].index  = (guint8)walk.this_arg_index;
+		fields[n_fields].size   = (guint8)walk.this_arg_size;
+		fields[n_fields].offset = (guint16)(walk.this_arg - data);
+		n_fields++;
+	}
+	if (err != -ENOENT) {
+		/* not enough data; leave it to the iterator to report */
+		return NULL;
+	}
+
+	layout = wmem_new(wmem_epan_scope(), radiotap_layout_t);
+	*layout = key;
+	layout->min_length = (guint)(walk._arg - data);
+	layout->n_fields = n_fields;
+	layout->fields = (radiotap_layout_field_t *)wmem_memdup(wmem_epan_scope(),
+	    fields, n_fields * sizeof(radiotap_layout_field_t));
+	wmem_map_insert(radiotap_layouts, layout, layout);
+
+	return layout;
+}
+
 static int
 dissect_radiotap(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void* unused_data _U_)
 {
@@ -694,6 +812,10 @@ dissect_radiotap(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void* u
 	struct _radiotap_info              *radiotap_info;
 	static struct _radiotap_info        rtp_info_arr;
 	struct ieee80211_radiotap_iterator  iter;
+	const radiotap_layout_t *layout;
+	guint       field_num         = 0;
+	int         this_arg_index;
+	int         this_arg_size;
 	struct ieee_802_11_phdr phdr;
 
 	/* our non-standard overrides */
@@ -755,6 +877,8 @@ dissect_radiotap(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void* u
 	iter.overrides = overrides;
 	iter.n_overrides = n_overrides;
 
+	layout = radiotap_get_layout((const guint8 *)data, length, &iter);
+
 	/* Add the "present flags" bitmaps. */
 	if (tree) {
 		guchar	 *bmap_start	      = (guchar *)data + 4;
@@ -904,10 +1028,24 @@ dissect_radiotap(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void* u
 		}
 	}
 
-	while (!(err = ieee80211_radiotap_iterator_next(&iter))) {
-		offset = (int)((guchar *) iter.this_arg - (guchar *) data);
+	for (;;) {
+		if (layout) {
+			/* replay the cached walk */
+			if (field_num == layout->n_fields)
+				break;
+			this_arg_index = layout->fields[field_num].index;
+			this_arg_size  = layout->fields[field_num].size;
+			offset         = layout->fields[field_num].offset;
+			field_num++;
+		} else {
+			if ((err = ieee80211_radiotap_iterator_next(&iter)))
+				break;
+			this_arg_index = iter.this_arg_index;
+			this_arg_size  = iter.this_arg_size;
+			offset = (int)((guchar *) iter.this_arg - (guchar *) data);
+		}
 
-		if (iter.this_arg_index == IEEE80211_RADIOTAP_VENDOR_NAMESPACE
+		if (this_arg_index == IEEE80211_RADIOTAP_VENDOR_NAMESPACE
 		    && tree) {
 			proto_tree *vt, *ven_tree = NULL;
 			const gchar *manuf_name;
@@ -919,7 +1057,7 @@ dissect_radiotap(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void* u
 			vt = proto_tree_add_bytes_format_value(radiotap_tree,
 							 hf_radiotap_vendor_ns,
 							 tvb, offset,
-							 iter.this_arg_size,
+							 this_arg_size,
 							 NULL,
 							 "%s-%d",
 							 manuf_name, subns);
@@ -933,14 +1071,14 @@ dissect_radiotap(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void* u
 			proto_tree_add_item(ven_tree, hf_radiotap_ven_skip, tvb,
 					    offset + 4, 2, ENC_LITTLE_ENDIAN);
 			proto_tree_add_item(ven_tree, hf_radiotap_ven_data, tvb,
-					    offset + 6, iter.this_arg_size - 6,
+					    offset + 6, this_arg_size - 6,
 					    ENC_NA);
 		}
 
-		if (!iter.is_radiotap_ns)
+		if (!layout && !iter.is_radiotap_ns)
 			continue;
 
-		switch (iter.this_arg_index) {
+		switch (this_arg_index) {
 
 		case IEEE80211_RADIOTAP_TSFT:
 			radiotap_info->tsft = tvb_get_letoh64(tvb, offset);
@@ -2839,6 +2977,8 @@ void proto_register_radiotap(void)
 	expert_register_field_array(expert_radiotap, ei, array_length(ei));
 	register_dissector("radiotap", dissect_radiotap, proto_radiotap);
 
+	radiotap_layouts = wmem_map_new(wmem_epan_scope(), radiotap_layout_hash, radiotap_layout_equal);
+
 	radiotap_tap = register_tap("radiotap");
 
 	radiotap_module = prefs_register_protocol(proto_radiotap, NULL);
@@ -13511,6 +13511,18 @@ dissect_frame_control(proto_tree *tree, tvbuff_t *tvb, guint32 option_flags,
   flags = FCF_FLAGS(fcf);
   frame_type_subtype = COMPOSE_FRAME_TYPE(fcf);
 
+  if (!tree) {
+    /*
+     * Nothing to add to a tree; only keep the side effects of the retry
+     * flag (expert info and the tap statistics).
+     */
+    if ((IS_FRAME_EXTENSION(fcf) == 0) && IS_RETRY(flags)) {
+      expert_add_info(pinfo, NULL, &ei_ieee80211_fc_retry);
+      wlan_stats.fc_retry = 1;
+    }
+    return;
+  }
+
   /* Swap offset... */
   if(option_flags & IEEE80211_COMMON_OPT_BROKEN_FC)
   {
@@ -17399,7 +17411,8 @@ dissect_ieee80211_common(tvbuff_t *tvb, packet_info *pinfo,
   hdr_tree = proto_item_add_subtree(ti, ett_80211);
 
   dissect_frame_control(hdr_tree, tvb, option_flags, 0, pinfo);
-  dissect_durid(hdr_tree, tvb, frame_type_subtype, 2);
+  if (tree)
+    dissect_durid(hdr_tree, tvb, frame_type_subtype, 2);
 
   switch (phdr->fcs_len)
     {
@@ -18327,6 +18340,14 @@ dissect_ieee80211_common(tvbuff_t *tvb, packet_info *pinfo,
       break;
 
     case DATA_FRAME:
+      /*
+       * Whether the body is an A-MSDU matters for the dissection of the
+       * payload, so work it out even if we're not building a tree.
+       */
+      if ((option_flags & IEEE80211_COMMON_OPT_NORMAL_QOS) && DATA_FRAME_IS_QOS(frame_type_subtype) &&
+          !DATA_FRAME_IS_NULL(frame_type_subtype))
+        is_amsdu = QOS_AMSDU_PRESENT(qos_control);
+
       if ((option_flags & IEEE80211_COMMON_OPT_NORMAL_QOS) && tree && DATA_FRAME_IS_QOS(frame_type_subtype))
       {
         proto_item *qos_fields, *qos_ti;
@@ -18362,7 +18383,6 @@ dissect_ieee80211_common(tvbuff_t *tvb, packet_info *pinfo,
         if (flags & FLAG_FROM_DS) {
           if (!DATA_FRAME_IS_NULL(frame_type_subtype)) {
             proto_tree_add_item(qos_tree, hf_ieee80211_qos_amsdu_present, tvb, qosoff, 2, ENC_LITTLE_ENDIAN);
-            is_amsdu = QOS_AMSDU_PRESENT(qos_control);
           }
           if (DATA_FRAME_IS_CF_POLL(frame_type_subtype)) {
             /* txop limit */
@@ -18403,7 +18423,6 @@ dissect_ieee80211_common(tvbuff_t *tvb, packet_info *pinfo,
         } else {
           if (!DATA_FRAME_IS_NULL(frame_type_subtype)) {
             proto_tree_add_item(qos_tree, hf_ieee80211_qos_amsdu_present, tvb, qosoff, 2, ENC_LITTLE_ENDIAN);
-            is_amsdu = QOS_AMSDU_PRESENT(qos_control);
           }
           if (qos_eosp) {
             /* queue size */
@@ -18911,23 +18930,27 @@ dissect_ieee80211_common(tvbuff_t *tvb, packet_info *pinfo,
            */
           msdu_length = tvb_get_ntohs(next_tvb, msdu_offset+12);
 
-          parent_item = proto_tree_add_item(mpdu_tree, hf_ieee80211_amsdu_subframe, next_tvb,
-                            msdu_offset, roundup2(msdu_offset+14+msdu_length, 4), ENC_NA);
-          proto_item_append_text(parent_item, " #%u", i);
-          subframe_tree = proto_item_add_subtree(parent_item, ett_msdu_aggregation_subframe_tree);
-          i += 1;
-
-          proto_tree_add_item(subframe_tree, hf_ieee80211_addr_da, next_tvb, msdu_offset, 6, ENC_NA);
-          resolve_name = tvb_get_ether_name(tvb, msdu_offset);
-          hidden_item = proto_tree_add_string(hdr_tree, hf_ieee80211_addr_da_resolved, tvb, msdu_offset, 6,
-            resolve_name);
-          PROTO_ITEM_SET_HIDDEN(hidden_item);
-          proto_tree_add_item(subframe_tree, hf_ieee80211_addr_sa, next_tvb, msdu_offset+6, 6, ENC_NA);
-          resolve_name = tvb_get_ether_name(tvb, msdu_offset+6);
-          hidden_item = proto_tree_add_string(hdr_tree, hf_ieee80211_addr_sa_resolved, tvb, msdu_offset+6, 6,
-            resolve_name);
-          PROTO_ITEM_SET_HIDDEN(hidden_item);
-          proto_tree_add_item(subframe_tree, hf_ieee80211_amsdu_length, next_tvb, msdu_offset+12, 2, ENC_BIG_ENDIAN);
+          /* Resolving the addresses is only worth it if there's a tree. */
+          subframe_tree = NULL;
+          if (tree) {
+            parent_item = proto_tree_add_item(mpdu_tree, hf_ieee80211_amsdu_subframe, next_tvb,
+                              msdu_offset, roundup2(msdu_offset+14+msdu_length, 4), ENC_NA);
+            proto_item_append_text(parent_item, " #%u", i);
+            subframe_tree = proto_item_add_subtree(parent_item, ett_msdu_aggregation_subframe_tree);
+            i += 1;
+
+            proto_tree_add_item(subframe_tree, hf_ieee80211_addr_da, next_tvb, msdu_offset, 6, ENC_NA);
+            resolve_name = tvb_get_ether_name(tvb, msdu_offset);
+            hidden_item = proto_tree_add_string(hdr_tree, hf_ieee80211_addr_da_resolved, tvb, msdu_offset, 6,
+              resolve_name);
+            PROTO_ITEM_SET_HIDDEN(hidden_item);
+            proto_tree_add_item(subframe_tree, hf_ieee80211_addr_sa, next_tvb, msdu_offset+6, 6, ENC_NA);
+            resolve_name = tvb_get_ether_name(tvb, msdu_offset+6);
+            hidden_item = proto_tree_add_string(hdr_tree, hf_ieee80211_addr_sa_resolved, tvb, msdu_offset+6, 6,
+              resolve_name);
+            PROTO_ITEM_SET_HIDDEN(hidden_item);
+            proto_tree_add_item(subframe_tree, hf_ieee80211_amsdu_length, next_tvb, msdu_offset+12, 2, ENC_BIG_ENDIAN);
+          }
 
           msdu_offset += 14;
           msdu_tvb = tvb_new_subset_length(next_tvb, msdu_offset, msdu_length);
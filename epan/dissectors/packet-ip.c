@@ -76,6 +76,9 @@ static gboolean g_ip_dscp_actif = TRUE;
 /* Defragment fragmented IP datagrams */
 static gboolean ip_defragment = TRUE;
 
+/* Drop incomplete IP datagrams after this many seconds (0 = never) */
+static guint ip_reassembly_timeout = 30;
+
 /* Place IP summary in proto tree */
 static gboolean ip_summary_in_tree = TRUE;
 
@@ -2455,6 +2458,12 @@ dissect_ip_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
     return TRUE;
 }
 
+static void
+apply_ip_prefs(void)
+{
+  reassembly_table_set_timeout(&ip_reassembly_table, ip_reassembly_timeout);
+}
+
 void
 proto_register_ip(void)
 {
@@ -2970,7 +2979,7 @@ proto_register_ip(void)
   register_capture_dissector_table("ip.proto", "IP protocol");
 
   /* Register configuration options */
-  ip_module = prefs_register_protocol(proto_ip, NULL);
+  ip_module = prefs_register_protocol(proto_ip, apply_ip_prefs);
   prefs_register_bool_preference(ip_module, "decode_tos_as_diffserv",
     "Decode IPv4 TOS field as DiffServ field",
     "Whether the IPv4 type-of-service field should be decoded as a "
@@ -2978,6 +2987,11 @@ proto_register_ip(void)
   prefs_register_bool_preference(ip_module, "defragment",
     "Reassemble fragmented IPv4 datagrams",
     "Whether fragmented IPv4 datagrams should be reassembled", &ip_defragment);
+  prefs_register_uint_preference(ip_module, "reassembly_timeout",
+    "Reassembly timeout (seconds)",
+    "Incomplete IPv4 datagrams are discarded once their first fragment is "
+    "older than this, as an IP stack would do (0 to keep them forever)",
+    10, &ip_reassembly_timeout);
   prefs_register_bool_preference(ip_module, "summary_in_tree",
     "Show IPv4 summary in protocol tree",
     "Whether the IPv4 summary line should be shown in the protocol tree",
@@ -3006,7 +3020,7 @@ proto_register_ip(void)
 
   ip_handle = register_dissector("ip", dissect_ip, proto_ip);
   reassembly_table_register(&ip_reassembly_table,
-                        &addresses_reassembly_table_functions);
+                        &ip_reassembly_table_functions);
   ip_tap = register_tap("ip");
 
   register_decode_as(&ip_da);
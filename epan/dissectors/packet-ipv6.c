@@ -508,6 +508,9 @@ static dissector_table_t ip_dissector_table;
 /* Reassemble fragmented datagrams */
 static gboolean ipv6_reassemble = TRUE;
 
+/* Drop incomplete IPv6 datagrams after this many seconds (0 = never) */
+static guint ipv6_reassembly_timeout = 60;
+
 /* Place IPv6 summary in proto tree */
 static gboolean ipv6_summary_in_tree = TRUE;
 
@@ -2424,6 +2427,12 @@ ipv6_dissect_next(guint nxt, tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree
     call_data_dissector(tvb, pinfo, tree);
 }
 
+static void
+apply_ipv6_prefs(void)
+{
+    reassembly_table_set_timeout(&ipv6_reassembly_table, ipv6_reassembly_timeout);
+}
+
 void
 proto_register_ipv6(void)
 {
@@ -3474,11 +3483,16 @@ proto_register_ipv6(void)
     proto_register_subtree_array(ett_ipv6_dstopts, array_length(ett_ipv6_dstopts));
 
     /* Register configuration options */
-    ipv6_module = prefs_register_protocol(proto_ipv6, NULL);
+    ipv6_module = prefs_register_protocol(proto_ipv6, apply_ipv6_prefs);
     prefs_register_bool_preference(ipv6_module, "defragment",
                                    "Reassemble fragmented IPv6 datagrams",
                                    "Whether fragmented IPv6 datagrams should be reassembled",
                                    &ipv6_reassemble);
+    prefs_register_uint_preference(ipv6_module, "reassembly_timeout",
+                                   "Reassembly timeout (seconds)",
+                                   "Incomplete IPv6 datagrams are discarded once their first fragment is older "
+                                   "than this, as an IPv6 stack would do (RFC 8200 uses 60 seconds; 0 to keep them forever)",
+                                   10, &ipv6_reassembly_timeout);
     prefs_register_bool_preference(ipv6_module, "summary_in_tree",
                                    "Show IPv6 summary in protocol tree",
                                    "Whether the IPv6 summary line should be shown in the protocol tree",
@@ -3513,7 +3527,7 @@ proto_register_ipv6(void)
 
     ipv6_handle = register_dissector("ipv6", dissect_ipv6, proto_ipv6);
     reassembly_table_register(&ipv6_reassembly_table,
-                          &addresses_reassembly_table_functions);
+                          &ip_reassembly_table_functions);
     ip6_hdr_tap = register_tap("ipv6");
     ipv6_ws_tap = register_tap("ipv6_ws");
 
@@ -259,45 +259,25 @@ static const fragment_items mp2t_msg_frag_items = {
  *    |
  *    +-> mp2t_analysis_data
  *          |
- *          +-> pid_table (RB tree) (key: pid)
+ *          +-> pid_table (array, index: pid)
  *          |     |
- *          |     +-> pid_analysis_data (per pid)
+ *          |     +-> pid_analysis_data (per pid, created on first use)
  *          |     +-> pid_analysis_data
  *          |     +-> pid_analysis_data
  *          |
- *          +-> frame_table (RB tree) (key: pinfo->num)
+ *          +-> frame_table (map, key: pinfo->num)
  *                |
  *                +-> frame_analysis_data (only created if drop detected)
  *                      |
- *                      +-> ts_table (RB tree)
+ *                      +-> ts_table (array)
  *                            |
  *                            +-> ts_analysis_data (per TS subframe)
  *                            +-> ts_analysis_data
  *                            +-> ts_analysis_data
  */
 
-typedef struct mp2t_analysis_data {
-
-    /* This structure contains a tree containing data for the
-     * individual pid's, this is only used when packets are
-     * processed sequentially.
-     */
-    wmem_tree_t    *pid_table;
-
-    /* When detecting a CC drop, store that information for the
-     * given frame.  This info is needed, when clicking around in
-     * wireshark, as the pid table data only makes sense during
-     * sequential processing. The flag pinfo->fd->flags.visited is
-     * used to tell the difference.
-     *
-     */
-    wmem_tree_t    *frame_table;
-
-    /* Total counters per conversation / multicast stream */
-    guint32 total_skips;
-    guint32 total_discontinuity;
-
-} mp2t_analysis_data_t;
+/* Number of distinct (13 bit) PID values */
+#define MP2T_PID_COUNT   8192
 
 enum pid_payload_type {
     pid_pload_unknown,
@@ -308,6 +288,7 @@ enum pid_payload_type {
 };
 
 typedef struct subpacket_analysis_data {
+    guint32     offset;        /* of the TS payload within the frame */
     guint32     frag_cur_pos;
     guint32     frag_tot_len;
     gboolean    fragmentation;
@@ -316,8 +297,10 @@ typedef struct subpacket_analysis_data {
 
 typedef struct packet_analysis_data {
 
-    /* Contain information for each MPEG2-TS packet in the current big packet */
-    wmem_tree_t *subpacket_table;
+    /* Contain information for each MPEG2-TS packet in the current big
+     * packet, sorted by offset.
+     */
+    wmem_array_t *subpacket_table;
 } packet_analysis_data_t;
 
 /* Analysis TS frame info needed during sequential processing */
@@ -336,6 +319,7 @@ typedef struct pid_analysis_data {
 /* Analysis info stored for a TS frame */
 typedef struct ts_analysis_data {
     guint16  pid;
+    gint8    cc;           /* CC number of this TS packet */
     gint8    cc_prev;      /* Previous CC number */
     guint8   skips;          /* Skips between Ccs max 14 */
 } ts_analysis_data_t;
@@ -344,12 +328,38 @@ typedef struct ts_analysis_data {
 typedef struct frame_analysis_data {
 
     /* As each frame has several pid's, thus need a pid data
-     * structure per TS frame.
+     * structure per TS frame. Only TS packets with drops are
+     * stored, so this is usually very short.
      */
-    wmem_tree_t    *ts_table;
+    wmem_array_t   *ts_table;
 
 } frame_analysis_data_t;
 
+typedef struct mp2t_analysis_data {
+
+    /* This array contains the data for the individual pid's,
+     * indexed by pid, this is only used when packets are
+     * processed sequentially.
+     */
+    pid_analysis_data_t **pid_table;
+
+    /* When detecting a CC drop, store that information for the
+     * given frame.  This info is needed, when clicking around in
+     * wireshark, as the pid table data only makes sense during
+     * sequential processing. The flag pinfo->fd->flags.visited is
+     * used to tell the difference.
+     *
+     * Only the frames with drops are in the map, so it stays small
+     * however many frames of other conversations are interleaved.
+     */
+    wmem_map_t     *frame_table;
+
+    /* Total counters per conversation / multicast stream */
+    guint32 total_skips;
+    guint32 total_discontinuity;
+
+} mp2t_analysis_data_t;
+
 static mp2t_analysis_data_t *
 init_mp2t_conversation_data(void)
 {
@@ -357,9 +367,9 @@ init_mp2t_conversation_data(void)
 
     mp2t_data = wmem_new0(wmem_file_scope(), struct mp2t_analysis_data);
 
-    mp2t_data->pid_table = wmem_tree_new(wmem_file_scope());
+    mp2t_data->pid_table = wmem_alloc0_array(wmem_file_scope(), pid_analysis_data_t *, MP2T_PID_COUNT);
 
-    mp2t_data->frame_table = wmem_tree_new(wmem_file_scope());
+    mp2t_data->frame_table = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
 
     mp2t_data->total_skips = 0;
     mp2t_data->total_discontinuity = 0;
@@ -387,10 +397,10 @@ init_frame_analysis_data(mp2t_analysis_data_t *mp2t_data, packet_info *pinfo)
     frame_analysis_data_t *frame_analysis_data_p;
 
     frame_analysis_data_p = wmem_new0(wmem_file_scope(), struct frame_analysis_data);
-    frame_analysis_data_p->ts_table = wmem_tree_new(wmem_file_scope());
-    /* Insert into mp2t tree */
-    wmem_tree_insert32(mp2t_data->frame_table, pinfo->num,
-            (void *)frame_analysis_data_p);
+    frame_analysis_data_p->ts_table = wmem_array_new(wmem_file_scope(), sizeof(ts_analysis_data_t));
+
+    /* Insert into frame table */
+    wmem_map_insert(mp2t_data->frame_table, GUINT_TO_POINTER(pinfo->num), frame_analysis_data_p);
 
     return frame_analysis_data_p;
 }
@@ -399,9 +409,7 @@ init_frame_analysis_data(mp2t_analysis_data_t *mp2t_data, packet_info *pinfo)
 static frame_analysis_data_t *
 get_frame_analysis_data(mp2t_analysis_data_t *mp2t_data, packet_info *pinfo)
 {
-    frame_analysis_data_t *frame_analysis_data_p;
-    frame_analysis_data_p = (frame_analysis_data_t *)wmem_tree_lookup32(mp2t_data->frame_table, pinfo->num);
-    return frame_analysis_data_p;
+    return (frame_analysis_data_t *)wmem_map_lookup(mp2t_data->frame_table, GUINT_TO_POINTER(pinfo->num));
 }
 
 static pid_analysis_data_t *
@@ -409,18 +417,59 @@ get_pid_analysis(mp2t_analysis_data_t *mp2t_data, guint32 pid)
 {
     pid_analysis_data_t  *pid_data;
 
-    pid_data = (pid_analysis_data_t *)wmem_tree_lookup32(mp2t_data->pid_table, pid);
+    pid_data = mp2t_data->pid_table[pid & (MP2T_PID_COUNT - 1)];
     if (!pid_data) {
         pid_data          = wmem_new0(wmem_file_scope(), struct pid_analysis_data);
         pid_data->cc_prev = -1;
         pid_data->pid     = pid;
         pid_data->frag_id = (pid << (32 - 13)) | 0x1;
 
-        wmem_tree_insert32(mp2t_data->pid_table, pid, (void *)pid_data);
+        mp2t_data->pid_table[pid & (MP2T_PID_COUNT - 1)] = pid_data;
     }
     return pid_data;
 }
 
+/* Binary search of the saved state of the TS packet at the given offset */
+static subpacket_analysis_data_t *
+get_subpacket_analysis(packet_analysis_data_t *pdata, guint32 offset)
+{
+    subpacket_analysis_data_t *spdata;
+    guint                      low, high, mid;
+
+    spdata = (subpacket_analysis_data_t *)wmem_array_get_raw(pdata->subpacket_table);
+    low = 0;
+    high = wmem_array_get_count(pdata->subpacket_table);
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (spdata[mid].offset == offset)
+            return &spdata[mid];
+        if (spdata[mid].offset < offset)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return NULL;
+}
+
+static void
+add_subpacket_analysis(packet_analysis_data_t *pdata, const subpacket_analysis_data_t *new_spdata)
+{
+    subpacket_analysis_data_t *spdata;
+    guint                      i;
+
+    /* TS packets are normally processed in offset order, so this is
+     * an append; keep the table sorted otherwise.
+     */
+    wmem_array_append(pdata->subpacket_table, new_spdata, 1);
+    spdata = (subpacket_analysis_data_t *)wmem_array_get_raw(pdata->subpacket_table);
+    i = wmem_array_get_count(pdata->subpacket_table) - 1;
+    while (i > 0 && spdata[i - 1].offset > new_spdata->offset) {
+        spdata[i] = spdata[i - 1];
+        i--;
+    }
+    spdata[i] = *new_spdata;
+}
+
 /* Structure to handle packets, spanned across
  * multiple MPEG packets
  */
@@ -638,21 +687,23 @@ mp2t_process_fragmented_payload(tvbuff_t *tvb, gint offset, guint remaining_len,
         pdata = (packet_analysis_data_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_mp2t, 0);
         if (!pdata) {
             pdata = wmem_new0(wmem_file_scope(), packet_analysis_data_t);
-            pdata->subpacket_table = wmem_tree_new(wmem_file_scope());
+            pdata->subpacket_table = wmem_array_new(wmem_file_scope(), sizeof(subpacket_analysis_data_t));
             p_add_proto_data(wmem_file_scope(), pinfo, proto_mp2t, 0, pdata);
 
         } else {
-            spdata = (subpacket_analysis_data_t *)wmem_tree_lookup32(pdata->subpacket_table, offset);
+            spdata = get_subpacket_analysis(pdata, offset);
         }
 
         if (!spdata) {
-            spdata = wmem_new0(wmem_file_scope(), subpacket_analysis_data_t);
+            subpacket_analysis_data_t new_spdata;
+
             /* Save the info into pdata from pid_analysis */
-            spdata->frag_cur_pos = frag_cur_pos;
-            spdata->frag_tot_len = frag_tot_len;
-            spdata->fragmentation = fragmentation;
-            spdata->frag_id = frag_id;
-            wmem_tree_insert32(pdata->subpacket_table, offset, (void *)spdata);
+            new_spdata.offset = offset;
+            new_spdata.frag_cur_pos = frag_cur_pos;
+            new_spdata.frag_tot_len = frag_tot_len;
+            new_spdata.fragmentation = fragmentation;
+            new_spdata.frag_id = frag_id;
+            add_subpacket_analysis(pdata, &new_spdata);
         }
     } else {
         /* Get saved values */
@@ -662,7 +713,7 @@ mp2t_process_fragmented_payload(tvbuff_t *tvb, gint offset, guint remaining_len,
             return;
         }
 
-        spdata = (subpacket_analysis_data_t *)wmem_tree_lookup32(pdata->subpacket_table, offset);
+        spdata = get_subpacket_analysis(pdata, offset);
         if (!spdata) {
             /* Occurs for the first sub packets in the capture which cannot be reassembled */
             return;
@@ -838,8 +889,6 @@ calc_skips(gint32 curr, gint32 prev)
     return res;
 }
 
-#define KEY(pid, cc) ((pid << 4)|cc)
-
 static guint32
 detect_cc_drops(tvbuff_t *tvb, proto_tree *tree, packet_info *pinfo,
         guint32 pid, gint32 cc_curr, mp2t_analysis_data_t *mp2t_data)
@@ -847,6 +896,7 @@ detect_cc_drops(tvbuff_t *tvb, proto_tree *tree, packet_info *pinfo,
     gint32 cc_prev = -1;
     pid_analysis_data_t   *pid_data              = NULL;
     ts_analysis_data_t    *ts_data               = NULL;
+    ts_analysis_data_t     ts_new;
     frame_analysis_data_t *frame_analysis_data_p = NULL;
     proto_item            *flags_item;
 
@@ -895,12 +945,11 @@ detect_cc_drops(tvbuff_t *tvb, proto_tree *tree, packet_info *pinfo,
         /* Create and store a new TS frame pid_data object.
            This indicate that we have a drop
          */
-        ts_data = wmem_new0(wmem_file_scope(), struct ts_analysis_data);
-        ts_data->cc_prev = cc_prev;
-        ts_data->pid = pid;
-        ts_data->skips = skips;
-        wmem_tree_insert32(frame_analysis_data_p->ts_table, KEY(pid, cc_curr),
-                 (void *)ts_data);
+        ts_new.pid = pid;
+        ts_new.cc = cc_curr;
+        ts_new.cc_prev = cc_prev;
+        ts_new.skips = skips;
+        wmem_array_append_one(frame_analysis_data_p->ts_table, ts_new);
     }
 
     /* See if we stored info about drops */
@@ -911,8 +960,15 @@ detect_cc_drops(tvbuff_t *tvb, proto_tree *tree, packet_info *pinfo,
         if (!frame_analysis_data_p)
             return 0; /* No stored frame data -> no drops*/
         else {
-            ts_data = (struct ts_analysis_data *)wmem_tree_lookup32(frame_analysis_data_p->ts_table,
-                           KEY(pid, cc_curr));
+            guint i;
+
+            /* Latest entry wins if a pid/cc pair repeats within a frame */
+            for (i = wmem_array_get_count(frame_analysis_data_p->ts_table); i > 0; i--) {
+                ts_data = (ts_analysis_data_t *)wmem_array_index(frame_analysis_data_p->ts_table, i - 1);
+                if (ts_data->pid == pid && ts_data->cc == cc_curr)
+                    break;
+                ts_data = NULL;
+            }
 
             if (ts_data) {
                 if (ts_data->skips > 0) {
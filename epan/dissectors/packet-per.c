@@ -131,6 +131,82 @@ static const true_false_string tfs_optional_field_bit = {
 
 #define BYTE_ALIGN_OFFSET(offset) if(offset&0x07){offset=(offset&0xfffffff8)+8;}
 
+/* Bit reader used for runs of sub-octet fields (restricted character strings,
+ * short bit strings). The bytes covering the whole run are fetched with a
+ * single tvb_get_ptr() (so that a truncated run throws up front, as the per
+ * bit reads would have) and are then shifted into a 64 bit word, MSB first,
+ * which is refilled a byte at a time as it drains.
+ */
+typedef struct {
+	const guint8 *data;	/* next byte to load into the word */
+	const guint8 *end;
+	guint64 word;		/* cached bits, left justified */
+	int cached;		/* number of valid bits in word */
+} per_bit_reader_t;
+
+static void
+per_bit_reader_init(per_bit_reader_t *reader, tvbuff_t *tvb, guint32 bit_offset, guint32 no_of_bits)
+{
+	guint32 skip = bit_offset & 0x07;
+	gint length = (gint)((skip + no_of_bits + 7) >> 3);
+
+	/* callers never start an empty run */
+	DISSECTOR_ASSERT(no_of_bits > 0);
+
+	reader->data = tvb_get_ptr(tvb, bit_offset >> 3, length);
+	reader->end = reader->data + length;
+	reader->word = 0;
+	reader->cached = 0;
+	if (skip) {
+		reader->word = ((guint64)*reader->data++) << (56 + skip);
+		reader->cached = 8 - skip;
+	}
+}
+
+/* Returns the next no_of_bits (at most 32) bits of the run */
+static inline guint32
+per_bit_reader_get_bits(per_bit_reader_t *reader, int no_of_bits)
+{
+	guint32 val;
+
+	if (no_of_bits == 0)
+		return 0;
+	if (reader->cached < no_of_bits) {
+		while ((reader->cached <= 56) && (reader->data < reader->end)) {
+			reader->word |= ((guint64)*reader->data++) << (56 - reader->cached);
+			reader->cached += 8;
+		}
+	}
+	val = (guint32)(reader->word >> (64 - no_of_bits));
+	reader->word <<= no_of_bits;
+	reader->cached -= no_of_bits;
+	return val;
+}
+
+/* Reads an unsigned big endian value of up to 32 bits, taking whole octets
+ * directly when the field is octet aligned (the common case in ALIGNED PER)
+ * instead of going through the generic bit extraction.
+ */
+static inline guint32
+per_get_bits32(tvbuff_t *tvb, guint32 offset, int no_of_bits)
+{
+	if ((offset & 0x07) == 0) {
+		switch (no_of_bits) {
+		case 8:
+			return tvb_get_guint8(tvb, offset >> 3);
+		case 16:
+			return tvb_get_ntohs(tvb, offset >> 3);
+		case 24:
+			return tvb_get_ntoh24(tvb, offset >> 3);
+		case 32:
+			return tvb_get_ntohl(tvb, offset >> 3);
+		default:
+			break;
+		}
+	}
+	return tvb_get_bits32(tvb, offset, no_of_bits, ENC_BIG_ENDIAN);
+}
+
 #define SEQ_MAX_COMPONENTS 128
 
 static void per_check_value(guint32 value, guint32 min_len, guint32 max_len, asn1_ctx_t *actx, proto_item *item, gboolean is_signed)
@@ -313,6 +389,28 @@ dissect_per_length_determinant(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx _
 		BYTE_ALIGN_OFFSET(offset);
 		byte=tvb_get_guint8(tvb, offset>>3);
 		offset+=8;
+	}else if(!display_internal_per_fields){
+		/* Same decoding as below, without building the bit display string
+		 * that is only shown with the internal PER fields.
+		 */
+		byte=tvb_get_bits8(tvb, offset, 8);
+		if(((byte&0xc0)==0xc0)&&(!is_fragmented)){
+			offset+=2;
+			*length = 0;
+			dissect_per_not_decoded_yet(tree, actx->pinfo, tvb, "10.9 Unconstrained");
+			return offset;
+		}
+		offset+=8;
+		if((byte&0xc0)==0x80){
+			*length=((byte&0x3f)<<8)|tvb_get_bits8(tvb, offset, 8);
+			offset+=8;
+			if(hf_index!=-1){
+				pi = proto_tree_add_uint(tree, hf_index, tvb, (offset>>3)-2, 2, *length);
+				PROTO_ITEM_SET_HIDDEN(pi);
+			}
+			return offset;
+		}
+		/* single octet and fragment count forms are handled below */
 	}else{
 		char *str;
 		guint32 val;
@@ -459,7 +557,7 @@ dissect_per_length_determinant(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx _
 static guint32
 dissect_per_normally_small_nonnegative_whole_number(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx, proto_tree *tree, int hf_index, guint32 *length)
 {
-	gboolean small_number, length_bit;
+	gboolean small_number;
 	guint32 len, length_determinant;
 	proto_item *pi;
 
@@ -471,16 +569,9 @@ DEBUG_ENTRY("dissect_per_normally_small_nonnegative_whole_number");
 	offset=dissect_per_boolean(tvb, offset, actx, tree, hf_per_small_number_bit, &small_number);
 	if (!display_internal_per_fields) PROTO_ITEM_SET_HIDDEN(actx->created_item);
 	if(!small_number){
-		int i;
 		/* 10.6.1 */
-		*length=0;
-		for(i=0;i<6;i++){
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &length_bit);
-			*length<<=1;
-			if (length_bit) {
-				*length|=1;
-			}
-		}
+		*length=tvb_get_bits8(tvb, offset, 6);
+		offset+=6;
 		if(hf_index!=-1){
 			pi = proto_tree_add_uint(tree, hf_index, tvb, (offset-6)>>3, (offset%8<6)?2:1, *length);
 			if (!display_internal_per_fields) PROTO_ITEM_SET_HIDDEN(pi);
@@ -495,20 +586,11 @@ DEBUG_ENTRY("dissect_per_normally_small_nonnegative_whole_number");
 			*length = 0;
 			break;
 		case 1:
-			*length = tvb_get_bits8(tvb, offset, 8);
-			offset += 8;
-			break;
 		case 2:
-			*length = tvb_get_bits16(tvb, offset, 16, ENC_BIG_ENDIAN);
-			offset += 16;
-			break;
 		case 3:
-			*length = tvb_get_bits32(tvb, offset, 24, ENC_BIG_ENDIAN);
-			offset += 24;
-			break;
 		case 4:
-			*length = tvb_get_bits32(tvb, offset, 32, ENC_BIG_ENDIAN);
-			offset += 32;
+			*length = per_get_bits32(tvb, offset, 8*length_determinant);
+			offset += 8*length_determinant;
 			break;
 		default:
 			dissect_per_not_decoded_yet(tree, actx->pinfo, tvb, "too long integer(per_normally_small_nonnegative_whole_number)");
@@ -622,6 +704,7 @@ dissect_per_restricted_character_string_sorted(tvbuff_t *tvb, guint32 offset, as
 	guint char_pos;
 	int bits_per_char;
 	guint32 old_offset;
+	per_bit_reader_t reader;
 
 DEBUG_ENTRY("dissect_per_restricted_character_string");
 
@@ -732,16 +815,14 @@ DEBUG_ENTRY("dissect_per_restricted_character_string");
 
 	buf = (guint8 *)wmem_alloc(actx->pinfo->pool, length+1);
 	old_offset=offset;
+	if(length){
+		per_bit_reader_init(&reader, tvb, offset, length*bits_per_char);
+		offset+=length*bits_per_char;
+	}
 	for(char_pos=0;char_pos<length;char_pos++){
 		guchar val;
-		int i;
-		gboolean bit;
 
-		val=0;
-		for(i=0;i<bits_per_char;i++){
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &bit);
-			val=(val<<1)|bit;
-		}
+		val=(guchar)per_bit_reader_get_bits(&reader, bits_per_char);
 		if(use_canonical_order == FALSE){
 			buf[char_pos]=val;
 		} else {
@@ -1333,7 +1414,7 @@ DEBUG_ENTRY("dissect_per_constrained_integer");
 
 		val_start = (offset)>>3;
 		val_length = length;
-		val = (guint32)tvb_get_bits64(tvb,offset,num_bits, ENC_BIG_ENDIAN);
+		val = per_get_bits32(tvb, offset, num_bits);
 
 		if (display_internal_per_fields){
 			str = decode_bits_in_field((offset&0x07),num_bits,val);
@@ -1360,11 +1441,8 @@ DEBUG_ENTRY("dissect_per_constrained_integer");
 
 		/* in the aligned case, align to byte boundary */
 		BYTE_ALIGN_OFFSET(offset);
-		val=tvb_get_guint8(tvb, offset>>3);
-		val<<=8;
-		offset+=8;
-		val|=tvb_get_guint8(tvb, offset>>3);
-		offset+=8;
+		val=tvb_get_ntohs(tvb, offset>>3);
+		offset+=16;
 
 		val_start = (offset>>3)-2; val_length = 2;
 		val+=min;
@@ -1558,11 +1636,8 @@ DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 
 		/* in the aligned case, align to byte boundary */
 		BYTE_ALIGN_OFFSET(offset);
-		val=tvb_get_guint8(tvb, offset>>3);
-		val<<=8;
-		offset+=8;
-		val|=tvb_get_guint8(tvb, offset>>3);
-		offset+=8;
+		val=tvb_get_ntohs(tvb, offset>>3);
+		offset+=16;
 
 		val_start = (offset>>3)-2; val_length = 2;
 		val+=min;
@@ -2107,33 +2182,19 @@ static tvbuff_t *dissect_per_bit_string_display(tvbuff_t *tvb, guint32 offset, a
 			proto_item_append_text(actx->created_item, ", %u LSB pad bits", pad_length);
 		}
 
-		if (length<=64) { /* if read into 64 bits also handle length <= 24, 40, 48, 56 bits */
-			if (length<=8) {
-				value = tvb_get_bits8(out_tvb, 0, length);
-			}else if (length<=16) {
-				value = tvb_get_bits16(out_tvb, 0, length, ENC_BIG_ENDIAN);
-			}else if (length<=24) { /* first read 16 and then the remaining bits */
-				value = tvb_get_bits16(out_tvb, 0, 16, ENC_BIG_ENDIAN);
-				value <<= 8 - pad_length;
-				value |= tvb_get_bits8(out_tvb, 16, length - 16);
-			}else if (length<=32) {
-				value = tvb_get_bits32(out_tvb, 0, length, ENC_BIG_ENDIAN);
-			}else if (length<=40) { /* first read 32 and then the remaining bits */
-				value = tvb_get_bits32(out_tvb, 0, 32, ENC_BIG_ENDIAN);
-				value <<= 8 - pad_length;
-				value |= tvb_get_bits8(out_tvb, 32, length - 32);
-			}else if (length<=48) { /* first read 32 and then the remaining bits */
-				value = tvb_get_bits32(out_tvb, 0, 32, ENC_BIG_ENDIAN);
-				value <<= 16 - pad_length;
-				value |= tvb_get_bits16(out_tvb, 32, length - 32, ENC_BIG_ENDIAN);
-			}else if (length<=56) { /* first read 32 and 16 then the remaining bits */
-				value = tvb_get_bits32(out_tvb, 0, 32, ENC_BIG_ENDIAN);
-				value <<= 16;
-				value |= tvb_get_bits16(out_tvb, 32, 16, ENC_BIG_ENDIAN);
-				value <<= 8 - pad_length;
-				value |= tvb_get_bits8(out_tvb, 48, length - 48);
-			}else {
-				value = tvb_get_bits64(out_tvb, 0, length, ENC_BIG_ENDIAN);
+		if (length<=64) {
+			value = 0;
+			if (length) {
+				per_bit_reader_t reader;
+
+				per_bit_reader_init(&reader, out_tvb, 0, length);
+				if (length>32) {
+					value = per_bit_reader_get_bits(&reader, length-32);
+					value <<= 32;
+					value |= per_bit_reader_get_bits(&reader, 32);
+				} else {
+					value = per_bit_reader_get_bits(&reader, length);
+				}
 			}
 			proto_item_append_text(actx->created_item, ", %s decimal value %" G_GINT64_MODIFIER "u",
 				decode_bits_in_field(0, length, value), value);
@@ -973,27 +973,6 @@ smb2_saved_info_hash_unmatched(gconstpointer k)
 	return hash;
 }
 
-/* matched smb_saved_info structures.
-   For matched smb_saved_info structures we store the smb_saved_info
-   structure using the msg_id field.
-*/
-static gint
-smb2_saved_info_equal_matched(gconstpointer k1, gconstpointer k2)
-{
-	const smb2_saved_info_t *key1 = (const smb2_saved_info_t *)k1;
-	const smb2_saved_info_t *key2 = (const smb2_saved_info_t *)k2;
-	return key1->msg_id == key2->msg_id;
-}
-static guint
-smb2_saved_info_hash_matched(gconstpointer k)
-{
-	const smb2_saved_info_t *key = (const smb2_saved_info_t *)k;
-	guint32 hash;
-
-	hash = (guint32) (key->msg_id&0xffffffff);
-	return hash;
-}
-
 /* For Tids of a specific conversation.
    This keeps track of tid->sharename mappings and other information about the
    tid.
@@ -1090,23 +1069,52 @@ smb2_fid_info_hash(gconstpointer k)
 	return hash;
 }
 
-/* Callback for destroying the glib hash tables associated with a conversation
- * struct. */
-static gboolean
-smb2_conv_destroy(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
-	          void *user_data)
+/* Reads and writes mostly come in runs on the same file, so check the file
+ * found last before going to the fid table.
+ */
+static smb2_fid_info_t *
+smb2_fid_lookup(smb2_conv_info_t *conv, const smb2_fid_info_t *key)
 {
-	smb2_conv_info_t *conv = (smb2_conv_info_t *)user_data;
+	smb2_fid_info_t *sfi = conv->last_file;
 
-	g_hash_table_destroy(conv->matched);
-	g_hash_table_destroy(conv->unmatched);
-	g_hash_table_destroy(conv->fids);
-	g_hash_table_destroy(conv->sesids);
-	g_hash_table_destroy(conv->files);
+	if (sfi && smb2_fid_info_equal(sfi, key)) {
+		return sfi;
+	}
 
-	/* This conversation is gone, return FALSE to indicate we don't
-	 * want to be called again for this conversation. */
-	return FALSE;
+	sfi = (smb2_fid_info_t *)wmem_map_lookup(conv->fids, key);
+	if (sfi) {
+		conv->last_file = sfi;
+	}
+	return sfi;
+}
+
+/* Requests still unanswered once this many newer message IDs have been seen
+ * on the conversation are assumed to have lost their response and are
+ * dropped from the unmatched table (they stay attached to their frame).
+ */
+#define SMB2_UNMATCHED_WINDOW	65536
+
+static void
+smb2_purge_unmatched(smb2_conv_info_t *conv, guint64 msg_id)
+{
+	wmem_list_t *keys;
+	wmem_list_frame_t *frame;
+	smb2_saved_info_t *ssi;
+
+	if (wmem_map_size(conv->unmatched) < conv->unmatched_limit) {
+		return;
+	}
+
+	keys = wmem_map_get_keys(wmem_packet_scope(), conv->unmatched);
+	for (frame = wmem_list_head(keys); frame; frame = wmem_list_frame_next(frame)) {
+		ssi = (smb2_saved_info_t *)wmem_list_frame_data(frame);
+		if (ssi->msg_id < msg_id && msg_id - ssi->msg_id > SMB2_UNMATCHED_WINDOW) {
+			wmem_map_remove(conv->unmatched, ssi);
+		}
+	}
+
+	/* don't rescan on every request when that many are really outstanding */
+	conv->unmatched_limit = MAX(SMB2_UNMATCHED_WINDOW, 2 * wmem_map_size(conv->unmatched));
 }
 
 static void smb2_key_derivation(const guint8 *KI, guint32 KI_len,
@@ -1985,7 +1993,8 @@ dissect_smb2_fid(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, int offset
 			dcerpc_store_polhnd_name(&policy_hnd, pinfo,
 						  fid_name);
 
-			g_hash_table_insert(si->conv->fids, sfi, sfi);
+			wmem_map_insert(si->conv->fids, sfi, sfi);
+			si->conv->last_file = sfi;
 			si->file = sfi;
 
 			/* If needed, create the file entry and save the policy hnd */
@@ -1995,13 +2004,13 @@ dissect_smb2_fid(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, int offset
 			}
 
 			if (si->conv) {
-				eo_file_info = (smb2_eo_file_info_t *)g_hash_table_lookup(si->conv->files,&policy_hnd);
+				eo_file_info = (smb2_eo_file_info_t *)wmem_map_lookup(si->conv->files,&policy_hnd);
 				if (!eo_file_info) {
 					eo_file_info = wmem_new(wmem_file_scope(), smb2_eo_file_info_t);
 					policy_hnd_hashtablekey = wmem_new(wmem_file_scope(), e_ctx_hnd);
 					memcpy(policy_hnd_hashtablekey, &policy_hnd, sizeof(e_ctx_hnd));
 					eo_file_info->end_of_file=0;
-					g_hash_table_insert(si->conv->files,policy_hnd_hashtablekey,eo_file_info);
+					wmem_map_insert(si->conv->files,policy_hnd_hashtablekey,eo_file_info);
 				}
 				si->eo_file_info=eo_file_info;
 			}
@@ -2017,7 +2026,13 @@ dissect_smb2_fid(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, int offset
 		break;
 	}
 
-	si->file = (smb2_fid_info_t *)g_hash_table_lookup(si->conv->fids, &sfi_key);
+	if (pinfo->fd->flags.visited && si->saved && si->saved->file) {
+		/* the file was resolved during the first pass; it may since
+		 * have been closed and removed from the fid table */
+		si->file = si->saved->file;
+	} else {
+		si->file = smb2_fid_lookup(si->conv, &sfi_key);
+	}
 	if (si->file) {
 		if (si->saved) {
 			si->saved->file = si->file;
@@ -2035,7 +2050,7 @@ dissect_smb2_fid(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, int offset
 		if (!si->eo_file_info) {
 			if (si->saved) { si->saved->policy_hnd = policy_hnd; }
 			if (si->conv) {
-				eo_file_info = (smb2_eo_file_info_t *)g_hash_table_lookup(si->conv->files,&policy_hnd);
+				eo_file_info = (smb2_eo_file_info_t *)wmem_map_lookup(si->conv->files,&policy_hnd);
 				if (eo_file_info) {
 					si->eo_file_info=eo_file_info;
 				} else { /* XXX This should never happen */
@@ -2043,7 +2058,7 @@ dissect_smb2_fid(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, int offset
 					policy_hnd_hashtablekey = wmem_new(wmem_file_scope(), e_ctx_hnd);
 					memcpy(policy_hnd_hashtablekey, &policy_hnd, sizeof(e_ctx_hnd));
 					eo_file_info->end_of_file=0;
-					g_hash_table_insert(si->conv->files,policy_hnd_hashtablekey,eo_file_info);
+					wmem_map_insert(si->conv->files,policy_hnd_hashtablekey,eo_file_info);
 				}
 			}
 
@@ -3129,8 +3144,8 @@ dissect_smb2_session_setup_request(tvbuff_t *tvb, packet_info *pinfo, proto_tree
 				smb2_set_session_keys(sesid, session_key);
 				sesid->server_port = pinfo->destport;
 				sesid->auth_frame = pinfo->num;
-				sesid->tids = g_hash_table_new(smb2_tid_info_hash, smb2_tid_info_equal);
-				g_hash_table_insert(si->conv->sesids, sesid, sesid);
+				sesid->tids = wmem_map_new(wmem_file_scope(), smb2_tid_info_hash, smb2_tid_info_equal);
+				wmem_map_insert(si->conv->sesids, sesid, sesid);
 			}
 		}
 	}
@@ -3318,8 +3333,8 @@ dissect_smb2_session_setup_response(tvbuff_t *tvb, packet_info *pinfo, proto_tre
 			smb2_set_session_keys(sesid, session_key);
 			sesid->server_port = pinfo->srcport;
 			sesid->auth_frame = pinfo->num;
-			sesid->tids = g_hash_table_new(smb2_tid_info_hash, smb2_tid_info_equal);
-			g_hash_table_insert(si->conv->sesids, sesid, sesid);
+			sesid->tids = wmem_map_new(wmem_file_scope(), smb2_tid_info_hash, smb2_tid_info_equal);
+			wmem_map_insert(si->conv->sesids, sesid, sesid);
 		}
 	}
 #endif
@@ -3387,9 +3402,9 @@ dissect_smb2_tree_connect_response(tvbuff_t *tvb, packet_info *pinfo, proto_tree
 		smb2_tid_info_t *tid, tid_key;
 
 		tid_key.tid = si->tid;
-		tid = (smb2_tid_info_t *)g_hash_table_lookup(si->session->tids, &tid_key);
+		tid = (smb2_tid_info_t *)wmem_map_lookup(si->session->tids, &tid_key);
 		if (tid) {
-			g_hash_table_remove(si->session->tids, &tid_key);
+			wmem_map_remove(si->session->tids, &tid_key);
 		}
 		tid = wmem_new(wmem_file_scope(), smb2_tid_info_t);
 		tid->tid = si->tid;
@@ -3397,7 +3412,7 @@ dissect_smb2_tree_connect_response(tvbuff_t *tvb, packet_info *pinfo, proto_tree
 		tid->connect_frame = pinfo->num;
 		tid->share_type = share_type;
 
-		g_hash_table_insert(si->session->tids, tid, tid);
+		wmem_map_insert(si->session->tids, tid, tid);
 
 		si->saved->extra_info_type = SMB2_EI_NONE;
 		si->saved->extra_info = NULL;
@@ -5063,6 +5078,15 @@ dissect_smb2_close_response(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *t
 		if (!continue_dissection) return offset;
 	}
 
+	if (!pinfo->fd->flags.visited && si->status == 0 && si->file) {
+		/* the fid is closed, a later use of the same value belongs to a
+		 * new open; frames that used it keep it through their saved info */
+		wmem_map_remove(si->conv->fids, si->file);
+		if (si->conv->last_file && smb2_fid_info_equal(si->conv->last_file, si->file)) {
+			si->conv->last_file = NULL;
+		}
+	}
+
 	/* close flags */
 	if (tree) {
 		flags_item = proto_tree_add_item(tree, hf_smb2_close_flags, tvb, offset, 2, ENC_LITTLE_ENDIAN);
@@ -8949,7 +8973,7 @@ dissect_smb2_transform_header(packet_info *pinfo, proto_tree *tree,
 
 	/* now we need to first lookup the uid session */
 	sesid_key.sesid = sti->sesid;
-	sti->session = (smb2_sesid_info_t *)g_hash_table_lookup(sti->conv->sesids, &sesid_key);
+	sti->session = (smb2_sesid_info_t *)wmem_map_lookup(sti->conv->sesids, &sesid_key);
 
 	if (sti->session != NULL && sti->session->auth_frame != (guint32)-1) {
 		item = proto_tree_add_string(sesid_tree, hf_smb2_acct_name, tvb, sesid_offset, 0, sti->session->acct_name);
@@ -9102,7 +9126,7 @@ dissect_smb2_tid_sesid(packet_info *pinfo _U_, proto_tree *tree, tvbuff_t *tvb,
 
 	/* now we need to first lookup the uid session */
 	sesid_key.sesid = si->sesid;
-	si->session = (smb2_sesid_info_t *)g_hash_table_lookup(si->conv->sesids, &sesid_key);
+	si->session = (smb2_sesid_info_t *)wmem_map_lookup(si->conv->sesids, &sesid_key);
 	if (!si->session) {
 		guint8 seskey[NTLMSSP_KEY_LEN] = {0, };
 
@@ -9117,7 +9141,7 @@ dissect_smb2_tid_sesid(packet_info *pinfo _U_, proto_tree *tree, tvbuff_t *tvb,
 		si->session = wmem_new0(wmem_file_scope(), smb2_sesid_info_t);
 		si->session->sesid      = si->sesid;
 		si->session->auth_frame = (guint32)-1;
-		si->session->tids       = g_hash_table_new(smb2_tid_info_hash, smb2_tid_info_equal);
+		si->session->tids       = wmem_map_new(wmem_file_scope(), smb2_tid_info_hash, smb2_tid_info_equal);
 		if (si->flags & SMB2_FLAGS_RESPONSE) {
 			si->session->server_port = pinfo->srcport;
 		} else {
@@ -9127,7 +9151,7 @@ dissect_smb2_tid_sesid(packet_info *pinfo _U_, proto_tree *tree, tvbuff_t *tvb,
 			smb2_set_session_keys(si->session, seskey);
 		}
 
-		g_hash_table_insert(si->conv->sesids, si->session, si->session);
+		wmem_map_insert(si->conv->sesids, si->session, si->session);
 
 		return offset;
 	}
@@ -9152,7 +9176,7 @@ dissect_smb2_tid_sesid(packet_info *pinfo _U_, proto_tree *tree, tvbuff_t *tvb,
 	if (!(si->flags&SMB2_FLAGS_ASYNC_CMD)) {
 		/* see if we can find the name for this tid */
 		tid_key.tid = si->tid;
-		si->tree = (smb2_tid_info_t *)g_hash_table_lookup(si->session->tids, &tid_key);
+		si->tree = (smb2_tid_info_t *)wmem_map_lookup(si->session->tids, &tid_key);
 		if (!si->tree) return offset;
 
 		item = proto_tree_add_string(tid_tree, hf_smb2_tree, tvb, tid_offset, 4, si->tree->name);
@@ -9207,23 +9231,15 @@ dissect_smb2(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, gboolea
 		 * create it.
 		 */
 		si->conv = wmem_new(wmem_file_scope(), smb2_conv_info_t);
-		/* qqq this leaks memory for now since we never free
-		   the hashtables */
-		si->conv->matched = g_hash_table_new(smb2_saved_info_hash_matched,
-			smb2_saved_info_equal_matched);
-		si->conv->unmatched = g_hash_table_new(smb2_saved_info_hash_unmatched,
+		si->conv->unmatched = wmem_map_new(wmem_file_scope(), smb2_saved_info_hash_unmatched,
 			smb2_saved_info_equal_unmatched);
-		si->conv->sesids = g_hash_table_new(smb2_sesid_info_hash,
+		si->conv->unmatched_limit = SMB2_UNMATCHED_WINDOW;
+		si->conv->sesids = wmem_map_new(wmem_file_scope(), smb2_sesid_info_hash,
 			smb2_sesid_info_equal);
-		si->conv->fids = g_hash_table_new(smb2_fid_info_hash,
+		si->conv->fids = wmem_map_new(wmem_file_scope(), smb2_fid_info_hash,
 			smb2_fid_info_equal);
-		si->conv->files = g_hash_table_new(smb2_eo_files_hash,smb2_eo_files_equal);
-
-		/* Bit of a hack to avoid leaking the hash tables - register a
-		 * callback to free them. Ideally wmem would implement a simple
-		 * hash table so we wouldn't have to do this. */
-		wmem_register_callback(wmem_file_scope(), smb2_conv_destroy,
-				si->conv);
+		si->conv->last_file = NULL;
+		si->conv->files = wmem_map_new(wmem_file_scope(), smb2_eo_files_hash,smb2_eo_files_equal);
 
 		conversation_add_proto_data(conversation, proto_smb2, si->conv);
 	}
@@ -9340,7 +9356,7 @@ dissect_smb2(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, gboolea
 
 		if (!pinfo->fd->flags.visited) {
 			/* see if we can find this msg_id in the unmatched table */
-			ssi = (smb2_saved_info_t *)g_hash_table_lookup(si->conv->unmatched, &ssi_key);
+			ssi = (smb2_saved_info_t *)wmem_map_lookup(si->conv->unmatched, &ssi_key);
 
 			if (!(si->flags & SMB2_FLAGS_RESPONSE)) {
 				/* This is a request */
@@ -9349,41 +9365,39 @@ dissect_smb2(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, gboolea
 					* an older ssi so just delete the previous
 					* one
 					*/
-					g_hash_table_remove(si->conv->unmatched, ssi);
+					wmem_map_remove(si->conv->unmatched, ssi);
 					ssi = NULL;
 				}
 
-				if (!ssi) {
-					/* no we couldn't find it, so just add it then
-					* if was a request we are decoding
-					*/
-					ssi                  = wmem_new0(wmem_file_scope(), smb2_saved_info_t);
-					ssi->msg_id          = ssi_key.msg_id;
-					ssi->frame_req       = pinfo->num;
-					ssi->req_time        = pinfo->abs_ts;
-					ssi->extra_info_type = SMB2_EI_NONE;
-					g_hash_table_insert(si->conv->unmatched, ssi, ssi);
-				}
+				/* drop requests whose response we will never see */
+				smb2_purge_unmatched(si->conv, ssi_key.msg_id);
+
+				ssi                  = wmem_new0(wmem_file_scope(), smb2_saved_info_t);
+				ssi->msg_id          = ssi_key.msg_id;
+				ssi->frame_req       = pinfo->num;
+				ssi->req_time        = pinfo->abs_ts;
+				ssi->extra_info_type = SMB2_EI_NONE;
+				wmem_map_insert(si->conv->unmatched, ssi, ssi);
 			} else {
 				/* This is a response */
 				if (!((si->flags & SMB2_FLAGS_ASYNC_CMD)
 					&& si->status == NT_STATUS_PENDING)
 					&& ssi) {
-					/* just  set the response frame and move it to the matched table */
+					/* just set the response frame, the pair is complete */
 					ssi->frame_res = pinfo->num;
-					g_hash_table_remove(si->conv->unmatched, ssi);
-					g_hash_table_insert(si->conv->matched, ssi, ssi);
+					wmem_map_remove(si->conv->unmatched, ssi);
 				}
 			}
-		} else {
-			/* see if we can find this msg_id in the matched table */
-			ssi = (smb2_saved_info_t *)g_hash_table_lookup(si->conv->matched, &ssi_key);
-			/* if we couldn't find it in the matched table, it might still
-			* be in the unmatched table
-			*/
-			if (!ssi) {
-				ssi = (smb2_saved_info_t *)g_hash_table_lookup(si->conv->unmatched, &ssi_key);
+
+			/* remember the exchange for later passes; a frame may
+			 * carry several chained commands, so key it by msg_id */
+			if (ssi) {
+				p_add_proto_data(wmem_file_scope(), pinfo, proto_smb2,
+						 (guint32)ssi_key.msg_id, ssi);
 			}
+		} else {
+			ssi = (smb2_saved_info_t *)p_get_proto_data(wmem_file_scope(), pinfo,
+						proto_smb2, (guint32)ssi_key.msg_id);
 		}
 
 		if (ssi) {
@@ -9391,14 +9405,14 @@ dissect_smb2(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, gboolea
 				/* If needed, create the file entry and save the policy hnd */
 				if (!si->eo_file_info) {
 					if (si->conv) {
-						eo_file_info = (smb2_eo_file_info_t *)g_hash_table_lookup(si->conv->files,&ssi->policy_hnd);
+						eo_file_info = (smb2_eo_file_info_t *)wmem_map_lookup(si->conv->files,&ssi->policy_hnd);
 						if (!eo_file_info) { /* XXX This should never happen */
 							/* assert(1==0); */
 							eo_file_info = wmem_new(wmem_file_scope(), smb2_eo_file_info_t);
 							policy_hnd_hashtablekey = wmem_new(wmem_file_scope(), e_ctx_hnd);
 							memcpy(policy_hnd_hashtablekey, &ssi->policy_hnd, sizeof(e_ctx_hnd));
 							eo_file_info->end_of_file=0;
-							g_hash_table_insert(si->conv->files,policy_hnd_hashtablekey,eo_file_info);
+							wmem_map_insert(si->conv->files,policy_hnd_hashtablekey,eo_file_info);
 						}
 						si->eo_file_info=eo_file_info;
 					}
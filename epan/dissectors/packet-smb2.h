@@ -94,20 +94,23 @@ typedef struct _smb2_sesid_info_t {
 	guint16 server_port;
 	guint8 client_decryption_key[16];
 	guint8 server_decryption_key[16];
-	GHashTable *tids;
+	wmem_map_t *tids;
 } smb2_sesid_info_t;
 
 /* Structure to keep track of conversations and the hash tables.
  * There is one such structure for each conversation.
  */
 typedef struct _smb2_conv_info_t {
-	/* these two tables are used to match requests with responses */
-	GHashTable *unmatched;
-	GHashTable *matched;
-	GHashTable *sesids;
-	GHashTable *fids;
+	/* requests waiting for their response, by msg_id. Matched requests
+	 * are removed and found again through the frame's proto data */
+	wmem_map_t *unmatched;
+	guint unmatched_limit;
+	wmem_map_t *sesids;
+	/* files by (fid, sesid, tid); closed files are removed */
+	wmem_map_t *fids;
+	smb2_fid_info_t *last_file;
 	/* table to store some infos for smb export object */
-	GHashTable *files;
+	wmem_map_t *files;
 } smb2_conv_info_t;
 
 
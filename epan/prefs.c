@@ -3174,6 +3174,14 @@ prefs_register_modules(void)
                                    "Wrap to beginning/end of file during search?",
                                    &prefs.gui_find_wrap);
 
+    prefs_register_bool_preference(gui_module, "find_index",
+                                   "Index packet data to speed up searches",
+                                   "Build an index of the packet bytes in the background after a file"
+                                   " has been read, so that searching for hex values or strings in the"
+                                   " packet bytes only looks at packets which may contain them."
+                                   " The index takes about as much memory as the file.",
+                                   &prefs.gui_find_index);
+
     prefs_register_bool_preference(gui_module, "use_pref_save",
                                    "Settings dialogs use a save button",
                                    "Settings dialogs use a save button?",
@@ -4021,6 +4029,7 @@ pre_init_prefs(void)
     prefs.gui_fileopen_preview       = 3;
     prefs.gui_ask_unsaved            = TRUE;
     prefs.gui_find_wrap              = TRUE;
+    prefs.gui_find_index             = FALSE;
     prefs.gui_use_pref_save          = FALSE;
     prefs.gui_update_enabled         = TRUE;
     prefs.gui_update_channel         = UPDATE_CHANNEL_STABLE;
@@ -179,6 +179,7 @@ typedef struct _e_prefs {
   guint        gui_fileopen_preview;
   gboolean     gui_ask_unsaved;
   gboolean     gui_find_wrap;
+  gboolean     gui_find_index;
   gboolean     gui_use_pref_save;
   gchar       *gui_webbrowser;
   gchar       *gui_window_title;
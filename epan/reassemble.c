@@ -299,6 +299,91 @@ addresses_ports_reassembly_table_functions = {
 	fragment_addresses_ports_free_persistent_key
 };
 
+/*
+ * Functions for IPv4/IPv6 reassembly tables, where the endpoint addresses
+ * and a fragment ID are used as the key.  The addresses are stored in the
+ * key itself rather than copied into separately allocated buffers, and
+ * are included in the hash so that the (often reused) IDs of unrelated
+ * hosts don't all end up in the same hash chains.
+ */
+#define FRAGMENT_IP_ADDR_LEN	16	/* enough for an IPv6 address */
+
+typedef struct _fragment_ip_key {
+	guint32 id;
+	guint8 src_len;
+	guint8 dst_len;
+	guint8 src[FRAGMENT_IP_ADDR_LEN];
+	guint8 dst[FRAGMENT_IP_ADDR_LEN];
+} fragment_ip_key;
+
+static guint
+fragment_ip_hash(gconstpointer k)
+{
+	const fragment_ip_key* key = (const fragment_ip_key*) k;
+	guint hash_val = key->id;
+	int i;
+
+	for (i = 0; i < key->src_len; i++)
+		hash_val = hash_val * 31 + key->src[i];
+	for (i = 0; i < key->dst_len; i++)
+		hash_val = hash_val * 31 + key->dst[i];
+
+	return hash_val;
+}
+
+static gint
+fragment_ip_equal(gconstpointer k1, gconstpointer k2)
+{
+	const fragment_ip_key* key1 = (const fragment_ip_key*) k1;
+	const fragment_ip_key* key2 = (const fragment_ip_key*) k2;
+
+	return (key1->id == key2->id) &&
+	       (key1->src_len == key2->src_len) &&
+	       (key1->dst_len == key2->dst_len) &&
+	       (memcmp(key1->src, key2->src, key1->src_len) == 0) &&
+	       (memcmp(key1->dst, key2->dst, key1->dst_len) == 0);
+}
+
+/*
+ * The key holds copies of the addresses, so the same key can be used
+ * both for temporary lookups and as a persistent key.
+ */
+static gpointer
+fragment_ip_key_new(const packet_info *pinfo, const guint32 id,
+		    const void *data _U_)
+{
+	fragment_ip_key *key = g_slice_new(fragment_ip_key);
+
+	key->id = id;
+	key->src_len = (guint8)MIN(pinfo->src.len, FRAGMENT_IP_ADDR_LEN);
+	key->dst_len = (guint8)MIN(pinfo->dst.len, FRAGMENT_IP_ADDR_LEN);
+	if (key->src_len)
+		memcpy(key->src, pinfo->src.data, key->src_len);
+	if (key->dst_len)
+		memcpy(key->dst, pinfo->dst.data, key->dst_len);
+
+	return (gpointer)key;
+}
+
+static void
+fragment_ip_free_key(gpointer ptr)
+{
+	fragment_ip_key *key = (fragment_ip_key *)ptr;
+
+	if(key)
+		g_slice_free(fragment_ip_key, key);
+}
+
+const reassembly_table_functions
+ip_reassembly_table_functions = {
+	fragment_ip_hash,
+	fragment_ip_equal,
+	fragment_ip_key_new,
+	fragment_ip_key_new,
+	fragment_ip_free_key,
+	fragment_ip_free_key
+};
+
 typedef struct _reassembled_key {
 	guint32 id;
 	guint32 frame;
@@ -490,6 +575,18 @@ reassembly_table_init(reassembly_table *table,
 		table->reassembled_table = g_hash_table_new_full(reassembled_hash,
 		    reassembled_equal, reassembled_key_free, NULL);
 	}
+
+	/*
+	 * The start times refer to keys of the fragment table, which
+	 * have just been freed.
+	 */
+	if (table->start_table != NULL) {
+		g_hash_table_remove_all(table->start_table);
+	} else {
+		table->start_table = g_hash_table_new_full(g_direct_hash,
+		    g_direct_equal, NULL, g_free);
+	}
+	table->last_sweep = 0;
 }
 
 /*
@@ -546,6 +643,74 @@ reassembly_table_destroy(reassembly_table *table)
 		g_hash_table_destroy(table->reassembled_table);
 		table->reassembled_table = NULL;
 	}
+	if (table->start_table != NULL) {
+		g_hash_table_destroy(table->start_table);
+		table->start_table = NULL;
+	}
+}
+
+/*
+ * Set the timeout for incomplete reassemblies.
+ */
+void
+reassembly_table_set_timeout(reassembly_table *table, const guint32 timeout)
+{
+	table->timeout = timeout;
+	if (timeout == 0 && table->start_table != NULL) {
+		/* Nothing will be aged out anymore */
+		g_hash_table_remove_all(table->start_table);
+	}
+}
+
+typedef struct {
+	reassembly_table *table;
+	nstime_t cutoff;
+} fragment_expire_data;
+
+/*
+ * g_hash_table_foreach_remove() callback for the start time table; drops
+ * the reassembly if its first fragment was seen before the cutoff time.
+ */
+static gboolean
+fragment_expired(gpointer key, gpointer value, gpointer user_data)
+{
+	fragment_expire_data *expire = (fragment_expire_data *)user_data;
+	fragment_head *fd_head;
+
+	if (nstime_cmp((const nstime_t *)value, &expire->cutoff) >= 0)
+		return FALSE;
+
+	fd_head = (fragment_head *)g_hash_table_lookup(expire->table->fragment_table, key);
+	if (fd_head != NULL) {
+		free_all_fragments(key, fd_head, NULL);
+		/* This frees the key */
+		g_hash_table_remove(expire->table->fragment_table, key);
+	}
+
+	return TRUE;
+}
+
+/*
+ * Drop the incomplete reassemblies that are older than the table's
+ * timeout.  This is done on the first pass only, and at most once per
+ * second of capture time, so that the reassemblies found on the first
+ * pass don't depend on the order the packets are looked at later.
+ */
+static void
+fragment_expire_old(reassembly_table *table, const packet_info *pinfo)
+{
+	fragment_expire_data expire;
+
+	if (table->timeout == 0 || table->start_table == NULL ||
+	    pinfo->abs_ts.secs == table->last_sweep)
+		return;
+	table->last_sweep = pinfo->abs_ts.secs;
+
+	expire.table = table;
+	expire.cutoff = pinfo->abs_ts;
+	expire.cutoff.secs -= table->timeout;
+	g_hash_table_foreach_remove(table->start_table, fragment_expired,
+				    &expire);
 }
 
 /*
@@ -631,6 +796,8 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		fd=tmp_fd;
 	}
 	g_slice_free(fragment_head, fd_head);
+	if (table->start_table != NULL)
+		g_hash_table_remove(table->start_table, key);
 	g_hash_table_remove(table->fragment_table, key);
 
 	return fd_tvb_data;
@@ -813,6 +980,8 @@ fragment_unhash(reassembly_table *table, gpointer key)
 	/*
 	 * Remove the entry from the fragment table.
 	 */
+	if (table->start_table != NULL)
+		g_hash_table_remove(table->start_table, key);
 	g_hash_table_remove(table->fragment_table, key);
 }
 
@@ -1523,6 +1692,8 @@ fragment_add_check(reassembly_table *table, tvbuff_t *tvb, const int offset,
 		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
 	}
 
+	fragment_expire_old(table, pinfo);
+
 	/* Looks up a key in the GHashTable, returning the original key and the associated value
 	 * and a gboolean which is TRUE if the key was found. This is useful if you need to free
 	 * the memory allocated for the original key, for example before calling g_hash_table_remove()
@@ -1538,6 +1709,16 @@ fragment_add_check(reassembly_table *table, tvbuff_t *tvb, const int offset,
 		 * Save the key, for unhashing it later.
 		 */
 		orig_key = insert_fd_head(table, fd_head, pinfo, id, data);
+
+		/*
+		 * Remember when this reassembly started, for aging it out.
+		 */
+		if (table->timeout != 0 && table->start_table != NULL) {
+			nstime_t *start = g_new(nstime_t, 1);
+
+			nstime_copy(start, &pinfo->abs_ts);
+			g_hash_table_insert(table->start_table, orig_key, start);
+		}
 	}
 
 	/*
@@ -28,6 +28,7 @@
 #define REASSEMBLE_H
 
 #include "ws_symbol_export.h"
+#include <time.h>
 
 /* only in fd_head: packet is defragmented */
 #define FD_DEFRAGMENTED		0x0001
@@ -142,6 +143,12 @@ typedef struct {
 	fragment_temporary_key temporary_key_func;
 	fragment_persistent_key persistent_key_func;
 	GDestroyNotify free_temporary_key_func;		/* temporary key destruction function */
+	guint32 timeout;		/* seconds after which an incomplete reassembly
+					 * started by fragment_add_check() is dropped;
+					 * 0 to keep it forever. */
+	GHashTable *start_table;	/* persistent key -> time of its first fragment,
+					 * only maintained with a timeout */
+	time_t last_sweep;		/* capture second of the last timeout check */
 } reassembly_table;
 
 /*
@@ -165,6 +172,8 @@ WS_DLL_PUBLIC const reassembly_table_functions
 	addresses_reassembly_table_functions;		/* keys have endpoint addresses and an ID */
 WS_DLL_PUBLIC const reassembly_table_functions
 	addresses_ports_reassembly_table_functions;	/* keys have endpoint addresses and ports and an ID */
+WS_DLL_PUBLIC const reassembly_table_functions
+	ip_reassembly_table_functions;			/* keys have IPv4/IPv6 endpoint addresses, stored inline, and an ID */
 
 /*
  * Register a reassembly table. By registering the table with epan, the creation and
@@ -187,6 +196,15 @@ reassembly_table_init(reassembly_table *table,
 WS_DLL_PUBLIC void
 reassembly_table_destroy(reassembly_table *table);
 
+/*
+ * Set the timeout, in seconds of capture time, after which an incomplete
+ * reassembly is dropped, as an IP stack does with its fragment queues.
+ * Only reassemblies done with fragment_add_check() are aged; 0 disables
+ * the timeout (the default).
+ */
+WS_DLL_PUBLIC void
+reassembly_table_set_timeout(reassembly_table *table, const guint32 timeout);
+
 /*
  * This function adds a new fragment to the reassembly table
  * If this is the first fragment seen for this datagram, a new entry
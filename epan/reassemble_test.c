@@ -1262,6 +1262,79 @@ test_fragment_add_seq_check_multiple(void) {
 }
 #endif
 
+/**********************************************************************************
+ *
+ * fragment_add_check
+ *
+ *********************************************************************************/
+
+/* Test case for the reassembly timeout, using the IP key functions.
+ * Starts a datagram, lets it age past the timeout, and checks that it is
+ * dropped while a later datagram is reassembled normally.
+ */
+/*   visit  id  frame  time  frag  len  more  tvb_offset
+       0    20     1    100     0   50   T      10
+       0    21     2    140     0   10   T       5
+       0    20     3    141    50   10   F      60
+       0    21     4    142    10   10   F      15
+*/
+static void
+test_fragment_add_check_timeout(void)
+{
+    fragment_head *fd_head;
+    /* fragment_add_check() gives up on short frames */
+    tvbuff_t *full_tvb = tvb_new_real_data(data, DATA_LEN, DATA_LEN);
+
+    reassembly_table_destroy(&test_reassembly_table);
+    reassembly_table_init(&test_reassembly_table,
+                          &ip_reassembly_table_functions);
+    reassembly_table_set_timeout(&test_reassembly_table, 30);
+
+    pinfo.num = 1;
+    pinfo.abs_ts.secs = 100;
+    fd_head=fragment_add_check(&test_reassembly_table, full_tvb, 10, &pinfo, 20, NULL,
+                               0, 50, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.start_table));
+
+    /* more than 30 seconds later: datagram #20 is dropped */
+    pinfo.num = 2;
+    pinfo.abs_ts.secs = 140;
+    fd_head=fragment_add_check(&test_reassembly_table, full_tvb, 5, &pinfo, 21, NULL,
+                               0, 10, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.start_table));
+
+    /* so its tail starts a new reassembly */
+    pinfo.num = 3;
+    pinfo.abs_ts.secs = 141;
+    fd_head=fragment_add_check(&test_reassembly_table, full_tvb, 60, &pinfo, 20, NULL,
+                               50, 10, FALSE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(2,g_hash_table_size(test_reassembly_table.fragment_table));
+
+    /* datagram #21 completes */
+    pinfo.num = 4;
+    pinfo.abs_ts.secs = 142;
+    fd_head=fragment_add_check(&test_reassembly_table, full_tvb, 15, &pinfo, 21, NULL,
+                               10, 10, FALSE);
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(20,fd_head->datalen);
+    ASSERT_EQ(4,fd_head->reassembled_in);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data+5,10));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,10,data+15,10));
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.start_table));
+    ASSERT_EQ(2,g_hash_table_size(test_reassembly_table.reassembled_table));
+
+    reassembly_table_set_timeout(&test_reassembly_table, 0);
+    tvb_free(full_tvb);
+    nstime_set_zero(&pinfo.abs_ts);
+}
+
 /**********************************************************************************
  *
  * fragment_add_seq_next
@@ -1546,6 +1619,7 @@ main(int argc _U_, char **argv _U_)
         test_fragment_add_seq_check_1,
         test_fragment_add_seq_802_11_0,
         test_fragment_add_seq_802_11_1,
+        test_fragment_add_check_timeout,
         test_simple_fragment_add_seq_next,
 #if 0
         test_missing_data_fragment_add_seq_next,
@@ -27,6 +27,7 @@
 #include <glib.h>
 #include "strutil.h"
 
+#include <wsutil/base64.h>
 #include <wsutil/str_util.h>
 #include <epan/proto.h>
 
@@ -406,6 +407,8 @@ hex_str_to_bytes(const char *hex_str, GByteArray *bytes, gboolean force_separato
     char        four_digits_second_half[3];
     char        two_digits[3];
     char        one_digit[2];
+    size_t      run;
+    guint       len;
 
     if (! hex_str || ! bytes) {
         return FALSE;
@@ -413,6 +416,26 @@ hex_str_to_bytes(const char *hex_str, GByteArray *bytes, gboolean force_separato
     g_byte_array_set_size(bytes, 0);
     p = hex_str;
     while (*p) {
+        if (!force_separators) {
+            /*
+             * Long runs of hex digits without separators (as pasted
+             * into filters or preferences) are decoded in one go; an
+             * odd trailing digit is left to the code below.
+             */
+            for (run = 0; g_ascii_isxdigit(p[run]); run++)
+                ;
+            if (run >= 4) {
+                len = bytes->len;
+                g_byte_array_set_size(bytes, len + (guint)(run / 2));
+                ws_base16_decode(p, run & ~1, bytes->data + len);
+                p += run & ~1;
+                if (!(run & 1) && is_byte_sep(*p)) {
+                    p++;
+                }
+                continue;
+            }
+        }
+
         q = p+1;
         r = p+2;
         s = p+3;
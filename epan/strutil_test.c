@@ -0,0 +1,188 @@
+/* strutil_test.c
+ * Tests for the conversion of hex strings to bytes
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "strutil.h"
+
+static GRand *test_rand;
+
+static void
+check_hex_str(const char *hex_str, gboolean force_separators,
+        gboolean expected_ok, const char *expected, guint expected_len)
+{
+    GByteArray *bytes = g_byte_array_new();
+
+    g_assert_cmpint(hex_str_to_bytes(hex_str, bytes, force_separators), ==, expected_ok);
+    if (expected_ok) {
+        g_assert_cmpuint(bytes->len, ==, expected_len);
+        g_assert(memcmp(bytes->data, expected, expected_len) == 0);
+    }
+    g_byte_array_free(bytes, TRUE);
+}
+
+/* Runs of digits are taken two at a time, with a leftover digit on its
+ * own; runs at least four long are decoded in one go. */
+static void
+strutil_test_hex_str_runs(void)
+{
+    check_hex_str("", FALSE, TRUE, "", 0);
+    check_hex_str("a", FALSE, TRUE, "\x0a", 1);
+    check_hex_str("aB", FALSE, TRUE, "\xab", 1);
+    check_hex_str("aBc", FALSE, TRUE, "\xab\x0c", 2);
+    check_hex_str("aBcD", FALSE, TRUE, "\xab\xcd", 2);
+    check_hex_str("aBcDe", FALSE, TRUE, "\xab\xcd\x0e", 3);
+    check_hex_str("00112233445566778899aabbccddeeff0", FALSE, TRUE,
+            "\x00\x11\x22\x33\x44\x55\x66\x77\x88\x99\xaa\xbb\xcc\xdd\xee\xff\x00", 17);
+    check_hex_str("0011:2233-4455.6677:", FALSE, TRUE,
+            "\x00\x11\x22\x33\x44\x55\x66\x77", 8);
+    check_hex_str("00112:33", FALSE, TRUE, "\x00\x11\x02\x33", 4);
+
+    check_hex_str("0011::2233", FALSE, FALSE, NULL, 0);
+    check_hex_str(":0011", FALSE, FALSE, NULL, 0);
+    check_hex_str("00112233g", FALSE, FALSE, NULL, 0);
+    check_hex_str("0011 2233", FALSE, FALSE, NULL, 0);
+
+    /* With forced separators groups have one, two or four digits */
+    check_hex_str("00:1:2233", TRUE, TRUE, "\x00\x01\x22\x33", 4);
+    check_hex_str("001:22", TRUE, FALSE, NULL, 0);
+    check_hex_str("001122", TRUE, FALSE, NULL, 0);
+}
+
+/*
+ * The expected result of hex_str_to_bytes(): the string is made of
+ * groups of digits between separators, which may also end it. Each
+ * group is taken two digits at a time, with a leftover digit on its own;
+ * with forced separators a group has one, two or four digits.
+ */
+static gboolean
+ref_hex_str_to_bytes(const char *s, GByteArray *bytes, gboolean force_separators)
+{
+    const char *group = s;
+    const char *p;
+    guint8 val;
+    size_t len, i;
+
+    g_byte_array_set_size(bytes, 0);
+    while (*group) {
+        for (p = group; g_ascii_isxdigit(*p); p++)
+            ;
+        len = (size_t)(p - group);
+        if (*p && *p != ':' && *p != '-' && *p != '.')
+            return FALSE;
+        if (len == 0)
+            return FALSE;
+        if (force_separators && len != 1 && len != 2 && len != 4)
+            return FALSE;
+        for (i = 0; i + 1 < len; i += 2) {
+            val = (guint8)(g_ascii_xdigit_value(group[i]) << 4 | g_ascii_xdigit_value(group[i + 1]));
+            g_byte_array_append(bytes, &val, 1);
+        }
+        if (i < len) {
+            val = (guint8)g_ascii_xdigit_value(group[i]);
+            g_byte_array_append(bytes, &val, 1);
+        }
+        group = *p ? p + 1 : p;
+    }
+    return TRUE;
+}
+
+/* Random groups with lengths around the 32-digit blocks of the base16
+ * decoder, random separators, and now and then a stray character. */
+static void
+strutil_test_hex_str_random(void)
+{
+    static const int lengths[] = { 0, 1, 2, 3, 4, 5, 6, 15, 16, 31, 32, 33, 34, 63, 64, 65 };
+    static const char digits[] = "0123456789abcdefABCDEF";
+    static const char seps[] = ":-.";
+    static const char strays[] = "/@Gg ,;\x80";
+    GByteArray *bytes = g_byte_array_new();
+    GByteArray *expected = g_byte_array_new();
+    GString *str = g_string_new(NULL);
+    gboolean ok;
+    int iter, groups, g, i, len;
+
+    for (iter = 0; iter < 5000; iter++) {
+        g_string_truncate(str, 0);
+        groups = g_rand_int_range(test_rand, 1, 5);
+        for (g = 0; g < groups; g++) {
+            if (g > 0)
+                g_string_append_c(str, seps[g_rand_int_range(test_rand, 0, 3)]);
+            len = lengths[g_rand_int_range(test_rand, 0, (gint32)G_N_ELEMENTS(lengths))];
+            for (i = 0; i < len; i++)
+                g_string_append_c(str, digits[g_rand_int_range(test_rand, 0, 22)]);
+        }
+        if (g_rand_boolean(test_rand))
+            g_string_append_c(str, seps[g_rand_int_range(test_rand, 0, 3)]);
+        if (str->len > 0 && g_rand_int_range(test_rand, 0, 8) == 0)
+            str->str[g_rand_int_range(test_rand, 0, (gint32)str->len)] =
+                strays[g_rand_int_range(test_rand, 0, (gint32)strlen(strays))];
+
+        for (i = 0; i < 2; i++) {
+            ok = ref_hex_str_to_bytes(str->str, expected, i);
+            g_assert_cmpint(hex_str_to_bytes(str->str, bytes, i), ==, ok);
+            if (ok) {
+                g_assert_cmpuint(bytes->len, ==, expected->len);
+                g_assert(memcmp(bytes->data, expected->data, expected->len) == 0);
+            }
+        }
+    }
+
+    g_string_free(str, TRUE);
+    g_byte_array_free(expected, TRUE);
+    g_byte_array_free(bytes, TRUE);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    g_test_init(&argc, &argv, NULL);
+    test_rand = g_rand_new_with_seed(42);
+
+    g_test_add_func("/strutil/hex_str_to_bytes/runs",   strutil_test_hex_str_runs);
+    g_test_add_func("/strutil/hex_str_to_bytes/random", strutil_test_hex_str_random);
+
+    ret = g_test_run();
+
+    g_rand_free(test_rand);
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -97,6 +97,8 @@ typedef struct _tap_listener_t {
 	volatile struct _tap_listener_t *next;
 	int tap_id;
 	gboolean needs_redraw;
+	gboolean needs_retap;	/* its data doesn't cover all the packets */
+	gboolean retapping;	/* it takes part in the retap in progress */
 	guint flags;
 	gchar *fstring;
 	dfilter_t *code;
@@ -107,6 +109,12 @@ typedef struct _tap_listener_t {
 } tap_listener_t;
 static volatile tap_listener_t *tap_listener_queue=NULL;
 
+/* Set between start_tap_listeners_retap() and finish_tap_listeners_retap();
+   only the listeners with "retapping" set are then used. */
+static gboolean retap_in_progress=FALSE;
+
+#define TAP_LISTENER_IN_USE(tl) (!retap_in_progress || (tl)->retapping)
+
 #ifdef HAVE_PLUGINS
 
 #include <gmodule.h>
@@ -318,7 +326,7 @@ void tap_build_interesting (epan_dissect_t *edt)
 	/* loop over all tap listeners and build the list of all
 	   interesting hf_fields */
 	for(tl=tap_listener_queue;tl;tl=tl->next){
-		if(tl->code){
+		if(tl->code && TAP_LISTENER_IN_USE(tl)){
 			epan_dissect_prime_with_dfilter(edt, tl->code);
 		}
 	}
@@ -369,6 +377,9 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
 		for(tl=tap_listener_queue;tl;tl=tl->next){
+			if(!TAP_LISTENER_IN_USE(tl)){
+				continue;
+			}
 			tp=&tap_packet_array[i];
 			/* Don't tap the packet if it's an "error" unless the listener tells us to */
 			if (!(tp->flags & TAP_PACKET_IS_ERROR_PACKET) || (tl->flags & TL_REQUIRES_ERROR_PACKETS))
@@ -440,6 +451,9 @@ reset_tap_listeners(void)
 	volatile tap_listener_t *tl;
 
 	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(!TAP_LISTENER_IN_USE(tl)){
+			continue;
+		}
 		if(tl->reset){
 			tl->reset(tl->tapdata);
 		}
@@ -448,6 +462,71 @@ reset_tap_listeners(void)
 
 }
 
+/* This function is called before retapping the packets, or before any other
+   pass that feeds all the packets to the tap listeners such as reading or
+   rescanning the file. If marked_only is TRUE only the tap listeners marked
+   as needing a retap take part, otherwise all of them do. Listeners
+   registered during the retap never take part.
+*/
+void
+start_tap_listeners_retap(gboolean marked_only)
+{
+	volatile tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tl->retapping = !marked_only || tl->needs_retap;
+	}
+	retap_in_progress=TRUE;
+}
+
+/* This function is called after retapping the packets. If the retap went
+   through all the packets, the listeners that took part are up to date.
+*/
+void
+finish_tap_listeners_retap(gboolean completed)
+{
+	volatile tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->retapping && completed){
+			tl->needs_retap=FALSE;
+		}
+		tl->retapping=FALSE;
+	}
+	retap_in_progress=FALSE;
+}
+
+/* This function marks a tap listener as needing a retap, for example
+   after its data has been cleared.
+*/
+void
+mark_tap_listener_for_retap(void *tapdata)
+{
+	volatile tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->tapdata==tapdata){
+			tl->needs_retap=TRUE;
+		}
+	}
+}
+
+/*
+ * Return TRUE if any tap listener is marked as needing a retap, FALSE
+ * otherwise.
+ */
+gboolean
+have_tap_listeners_marked_for_retap(void)
+{
+	volatile tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->needs_retap)
+			return TRUE;
+	}
+	return FALSE;
+}
+
 
 /* This function is called when we need to redraw all tap listeners, for example
    when we open/start a new capture or if we need to rescan the packet list.
@@ -550,6 +629,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 
 	tl=(volatile tap_listener_t *)g_malloc0(sizeof(tap_listener_t));
 	tl->needs_redraw=TRUE;
+	tl->needs_retap=TRUE;
 	tl->flags=flags;
 	if(fstring){
 		if(!dfilter_compile(fstring, &code, &err_msg)){
@@ -609,6 +689,7 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 			tl->code=NULL;
 		}
 		tl->needs_redraw=TRUE;
+		tl->needs_retap=TRUE;
 		g_free(tl->fstring);
 		if(fstring){
 			if(!dfilter_compile(fstring, &code, &err_msg)){
@@ -643,6 +724,7 @@ tap_listeners_dfilter_recompile(void)
 			tl->code=NULL;
 		}
 		tl->needs_redraw=TRUE;
+		tl->needs_retap=TRUE;
 		code=NULL;
 		if(tl->fstring){
 			if(!dfilter_compile(tl->fstring, &code, &err_msg)){
@@ -729,7 +811,7 @@ have_filtering_tap_listeners(void)
 	volatile tap_listener_t *tl;
 
 	for(tl=tap_listener_queue;tl;tl=tl->next){
-		if(tl->code)
+		if(tl->code && TAP_LISTENER_IN_USE(tl))
 			return TRUE;
 	}
 	return FALSE;
@@ -747,7 +829,8 @@ union_of_tap_listener_flags(void)
 	guint flags = 0;
 
 	for(tl=tap_listener_queue;tl;tl=tl->next){
-		flags|=tl->flags;
+		if(TAP_LISTENER_IN_USE(tl))
+			flags|=tl->flags;
 	}
 	return flags;
 }
@@ -128,6 +128,30 @@ extern void tap_push_tapped_queue(epan_dissect_t *edt);
 
 WS_DLL_PUBLIC void reset_tap_listeners(void);
 
+/** Start a retap of the packets. If marked_only is TRUE, only the tap
+ * listeners marked as needing a retap take part, otherwise all of them do:
+ * until finish_tap_listeners_retap() is called the others aren't reset by
+ * reset_tap_listeners(), don't get packets and don't count in
+ * have_filtering_tap_listeners() or union_of_tap_listener_flags().
+ * Tap listeners registered during the retap don't take part either.
+ * Reading or rescanning a file is bracketed the same way.
+ */
+WS_DLL_PUBLIC void start_tap_listeners_retap(gboolean marked_only);
+
+/** Finish a retap of the packets. If completed is TRUE, the tap listeners
+ * that took part in it are no longer marked as needing a retap.
+ */
+WS_DLL_PUBLIC void finish_tap_listeners_retap(gboolean completed);
+
+/** Mark a tap listener as needing a retap, for example after its data has
+ * been cleared. Tap listeners are also marked when they are registered and
+ * when their filter changes.
+ */
+WS_DLL_PUBLIC void mark_tap_listener_for_retap(void *tapdata);
+
+/** Return TRUE if any tap listener is marked as needing a retap. */
+WS_DLL_PUBLIC gboolean have_tap_listeners_marked_for_retap(void);
+
 /** This function is called when we need to redraw all tap listeners, for example
  * when we open/start a new capture or if we need to rescan the packet list.
  * It should be called from a low priority thread say once every 3 seconds
@@ -29,6 +29,7 @@
 #include "wmem_list.h"
 #include "wmem_map.h"
 #include "wmem_miscutl.h"
+#include "wmem_prefix_tree.h"
 #include "wmem_queue.h"
 #include "wmem_scopes.h"
 #include "wmem_stack.h"
@@ -45,6 +45,8 @@ struct _wmem_allocator_t {
     void  (*free_all)(void *private_data);
     void  (*gc)(void *private_data);
     void  (*cleanup)(void *private_data);
+    /* Optional, reports the chunks currently held from the system */
+    void  (*chunk_usage)(void *private_data, gsize *count, gsize *bytes);
 
     /* Callback List */
     struct _wmem_user_cb_container_t *callbacks;
@@ -53,6 +55,11 @@ struct _wmem_allocator_t {
     void                        *private_data;
     enum _wmem_allocator_type_t  type;
     gboolean                     in_scope;
+
+    /* Usage statistics, see wmem_allocator_get_stats() */
+    guint64 alloc_count;
+    guint64 alloc_bytes;
+    guint64 free_all_count;
 };
 
 #ifdef __cplusplus
@@ -156,6 +156,7 @@
 /* The header for an entire OS-level 'block' of memory */
 typedef struct _wmem_block_hdr_t {
     struct _wmem_block_hdr_t *prev, *next;
+    gsize size; /* of the whole block, for the usage statistics */
 } wmem_block_hdr_t;
 
 /* The header for a single 'chunk' of memory as returned from alloc/realloc.
@@ -775,6 +776,7 @@ wmem_block_new_block(wmem_block_allocator_t *allocator)
 
     /* allocate the new block and add it to the block list */
     block = (wmem_block_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
+    block->size = WMEM_BLOCK_SIZE;
     wmem_block_add_to_block_list(allocator, block);
 
     /* initialize it */
@@ -794,6 +796,7 @@ wmem_block_alloc_jumbo(wmem_block_allocator_t *allocator, const size_t size)
     block = (wmem_block_hdr_t *) wmem_alloc(NULL, size
             + WMEM_BLOCK_HEADER_SIZE
             + WMEM_CHUNK_HEADER_SIZE);
+    block->size = size + WMEM_BLOCK_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE;
 
     /* add it to the block list */
     wmem_block_add_to_block_list(allocator, block);
@@ -837,6 +840,7 @@ wmem_block_realloc_jumbo(wmem_block_allocator_t *allocator,
     block = (wmem_block_hdr_t *) wmem_realloc(NULL, block, size
             + WMEM_BLOCK_HEADER_SIZE
             + WMEM_CHUNK_HEADER_SIZE);
+    block->size = size + WMEM_BLOCK_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE;
 
     if (block->next) {
         block->next->prev = block;
@@ -1090,6 +1094,22 @@ wmem_block_gc(void *private_data)
     }
 }
 
+static void
+wmem_block_chunk_usage(void *private_data, gsize *count, gsize *bytes)
+{
+    wmem_block_allocator_t *allocator = (wmem_block_allocator_t*) private_data;
+    wmem_block_hdr_t       *cur;
+
+    *count = 0;
+    *bytes = 0;
+
+    /* blocks are large, so there are never very many of them */
+    for (cur = allocator->block_list; cur; cur = cur->next) {
+        (*count)++;
+        *bytes += cur->size;
+    }
+}
+
 static void
 wmem_block_allocator_cleanup(void *private_data)
 {
@@ -1116,6 +1136,8 @@ wmem_block_allocator_init(wmem_allocator_t *allocator)
     allocator->gc       = &wmem_block_gc;
     allocator->cleanup  = &wmem_block_allocator_cleanup;
 
+    allocator->chunk_usage = &wmem_block_chunk_usage;
+
     allocator->private_data = (void*) block_allocator;
 
     block_allocator->block_list    = NULL;
@@ -69,6 +69,7 @@ typedef struct {
 #define JUMBO_MAGIC 0xFFFFFFFF
 typedef struct _wmem_block_fast_jumbo {
     struct _wmem_block_fast_jumbo *prev, *next;
+    gsize size; /* of the whole block, for the usage statistics */
 } wmem_block_fast_jumbo_t;
 #define WMEM_JUMBO_HEADER_SIZE WMEM_ALIGN_SIZE(sizeof(wmem_block_fast_jumbo_t))
 
@@ -107,6 +108,7 @@ wmem_block_fast_alloc(void *private_data, const size_t size)
         /* allocate/initialize a new block of the necessary size */
         block = (wmem_block_fast_jumbo_t *)wmem_alloc(NULL,
                 size + WMEM_JUMBO_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE);
+        block->size = size + WMEM_JUMBO_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE;
 
         block->next = allocator->jumbo_list;
         block->prev = NULL;
@@ -155,6 +157,7 @@ wmem_block_fast_realloc(void *private_data, void *ptr, const size_t size)
         block = ((wmem_block_fast_jumbo_t*)((guint8*)(chunk) - WMEM_JUMBO_HEADER_SIZE));
         block =  (wmem_block_fast_jumbo_t*)wmem_realloc(NULL, block,
                 size + WMEM_JUMBO_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE);
+        block->size = size + WMEM_JUMBO_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE;
         if (block->prev) {
             block->prev->next = block;
         }
@@ -222,6 +225,27 @@ wmem_block_fast_gc(void *private_data _U_)
     /* No-op */
 }
 
+static void
+wmem_block_fast_chunk_usage(void *private_data, gsize *count, gsize *bytes)
+{
+    wmem_block_fast_allocator_t *allocator = (wmem_block_fast_allocator_t*) private_data;
+    wmem_block_fast_hdr_t       *cur;
+    wmem_block_fast_jumbo_t     *cur_jum;
+
+    *count = 0;
+    *bytes = 0;
+
+    for (cur = allocator->block_list; cur; cur = cur->next) {
+        (*count)++;
+        *bytes += WMEM_BLOCK_SIZE;
+    }
+
+    for (cur_jum = allocator->jumbo_list; cur_jum; cur_jum = cur_jum->next) {
+        (*count)++;
+        *bytes += cur_jum->size;
+    }
+}
+
 static void
 wmem_block_fast_allocator_cleanup(void *private_data)
 {
@@ -250,6 +274,8 @@ wmem_block_fast_allocator_init(wmem_allocator_t *allocator)
     allocator->gc       = &wmem_block_fast_gc;
     allocator->cleanup  = &wmem_block_fast_allocator_cleanup;
 
+    allocator->chunk_usage = &wmem_block_fast_chunk_usage;
+
     allocator->private_data = (void*) block_allocator;
 
     block_allocator->block_list = NULL;
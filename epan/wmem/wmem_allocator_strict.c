@@ -202,6 +202,24 @@ wmem_strict_gc(void *private_data _U_)
      * checking our canaries at this point? */
 }
 
+static void
+wmem_strict_chunk_usage(void *private_data, gsize *count, gsize *bytes)
+{
+    wmem_strict_allocator_t       *allocator;
+    wmem_strict_allocator_block_t *block;
+
+    allocator = (wmem_strict_allocator_t*) private_data;
+
+    *count = 0;
+    *bytes = 0;
+
+    /* every allocation is its own block */
+    for (block = allocator->blocks; block; block = block->next) {
+        (*count)++;
+        *bytes += WMEM_FULL_SIZE(block->data_len);
+    }
+}
+
 static void
 wmem_strict_allocator_cleanup(void *private_data)
 {
@@ -223,6 +241,8 @@ wmem_strict_allocator_init(wmem_allocator_t *allocator)
     allocator->gc       = &wmem_strict_gc;
     allocator->cleanup  = &wmem_strict_allocator_cleanup;
 
+    allocator->chunk_usage = &wmem_strict_chunk_usage;
+
     allocator->private_data = (void*) strict_allocator;
 
     strict_allocator->blocks = NULL;
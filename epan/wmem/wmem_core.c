@@ -55,6 +55,9 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    allocator->alloc_count++;
+    allocator->alloc_bytes += size;
+
     return allocator->walloc(allocator->private_data, size);
 }
 
@@ -107,6 +110,9 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     g_assert(allocator->in_scope);
 
+    allocator->alloc_count++;
+    allocator->alloc_bytes += size;
+
     return allocator->wrealloc(allocator->private_data, ptr, size);
 }
 
@@ -116,6 +122,7 @@ wmem_free_all_real(wmem_allocator_t *allocator, gboolean final)
     wmem_call_callbacks(allocator,
             final ? WMEM_CB_DESTROY_EVENT : WMEM_CB_FREE_EVENT);
     allocator->free_all(allocator->private_data);
+    allocator->free_all_count++;
 }
 
 void
@@ -157,6 +164,11 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     allocator->callbacks = NULL;
     allocator->in_scope  = TRUE;
 
+    allocator->chunk_usage    = NULL;
+    allocator->alloc_count    = 0;
+    allocator->alloc_bytes    = 0;
+    allocator->free_all_count = 0;
+
     switch (real_type) {
         case WMEM_ALLOCATOR_SIMPLE:
             wmem_simple_allocator_init(allocator);
@@ -181,6 +193,21 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     return allocator;
 }
 
+void
+wmem_allocator_get_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats)
+{
+    stats->alloc_count    = allocator->alloc_count;
+    stats->alloc_bytes    = allocator->alloc_bytes;
+    stats->free_all_count = allocator->free_all_count;
+    stats->chunk_count    = 0;
+    stats->chunk_bytes    = 0;
+
+    if (allocator->chunk_usage) {
+        allocator->chunk_usage(allocator->private_data,
+                &stats->chunk_count, &stats->chunk_bytes);
+    }
+}
+
 void
 wmem_init(void)
 {
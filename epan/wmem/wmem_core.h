@@ -206,6 +206,29 @@ WS_DLL_PUBLIC
 wmem_allocator_t *
 wmem_allocator_new(const wmem_allocator_type_t type);
 
+/** Usage statistics of an allocator, as returned by wmem_allocator_get_stats().
+ * The counters are always kept, and cheap enough to be. */
+typedef struct _wmem_allocator_stats_t {
+    guint64 alloc_count;    /**< Allocations and reallocations made since the
+                              allocator was created. */
+    guint64 alloc_bytes;    /**< Bytes requested by those. Frees are not
+                              subtracted. */
+    guint64 free_all_count; /**< Times the allocator was emptied by
+                              wmem_free_all(). */
+    gsize   chunk_count;    /**< Chunks of memory the allocator currently holds
+                              from the system, or 0 if it doesn't keep track. */
+    gsize   chunk_bytes;    /**< The size of those chunks. */
+} wmem_allocator_stats_t;
+
+/** Get the usage statistics of an allocator.
+ *
+ * @param allocator The allocator.
+ * @param stats Filled in with the statistics.
+ */
+WS_DLL_PUBLIC
+void
+wmem_allocator_get_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats);
+
 /** Initialize the wmem subsystem. This must be called before any other wmem
  * function, usually at the very beginning of your program.
  */
@@ -0,0 +1,253 @@
+/* wmem_prefix_tree.c
+ * Wireshark Memory Manager Longest-Prefix-Match Tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_prefix_tree.h"
+
+/* Every node holds a prefix (the key bits up to prefix_len, the rest being
+ * zeroed). A node whose value is NULL is an internal "glue" node created
+ * where two stored prefixes diverge; it never matches a lookup by itself.
+ * Children always have a strictly longer prefix than their parent, and the
+ * bit right after the parent's prefix selects the child. */
+typedef struct _wmem_prefix_tree_node_t {
+    struct _wmem_prefix_tree_node_t *child[2];
+    void  *value;
+    guint  prefix_len;
+    guint8 key[WMEM_PREFIX_TREE_MAX_KEY_LEN];
+} wmem_prefix_tree_node_t;
+
+struct _wmem_prefix_tree_t {
+    wmem_allocator_t        *allocator;
+    wmem_prefix_tree_node_t *root;
+    guint                    key_len;  /* in bytes */
+    guint                    key_bits; /* key_len * 8 */
+    guint                    count;
+};
+
+/* Returns bit number 'bit' of the key, counting from the most significant
+ * bit of the first byte. */
+static inline guint
+prefix_tree_get_bit(const guint8 *key, guint bit)
+{
+    return (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/* Returns TRUE if the first 'bits' bits of both keys are equal. */
+static inline gboolean
+prefix_tree_match(const guint8 *prefix, const guint8 *key, guint bits)
+{
+    guint bytes = bits >> 3;
+    guint rem   = bits & 7;
+
+    if (bytes && memcmp(prefix, key, bytes) != 0)
+        return FALSE;
+
+    if (rem) {
+        guint8 mask = (guint8)(0xFF << (8 - rem));
+        return ((prefix[bytes] ^ key[bytes]) & mask) == 0;
+    }
+
+    return TRUE;
+}
+
+/* Returns the number of leading bits both keys have in common, at most
+ * max_bits. */
+static guint
+prefix_tree_common_len(const guint8 *a, const guint8 *b, guint max_bits)
+{
+    guint  bits = 0;
+    guint  i;
+    guint8 diff;
+
+    for (i = 0; bits < max_bits; i++, bits += 8) {
+        diff = a[i] ^ b[i];
+        if (diff) {
+            while (!(diff & 0x80)) {
+                diff <<= 1;
+                bits++;
+            }
+            break;
+        }
+    }
+
+    return MIN(bits, max_bits);
+}
+
+static wmem_prefix_tree_node_t *
+prefix_tree_new_node(wmem_prefix_tree_t *tree, const guint8 *key,
+        guint prefix_len, void *value)
+{
+    wmem_prefix_tree_node_t *node;
+    guint bytes = prefix_len >> 3;
+    guint rem   = prefix_len & 7;
+
+    node = wmem_new0(tree->allocator, wmem_prefix_tree_node_t);
+    node->value      = value;
+    node->prefix_len = prefix_len;
+
+    /* Keep only the prefix bits so that node keys can be compared bytewise */
+    memcpy(node->key, key, bytes);
+    if (rem) {
+        node->key[bytes] = key[bytes] & (guint8)(0xFF << (8 - rem));
+    }
+
+    return node;
+}
+
+wmem_prefix_tree_t *
+wmem_prefix_tree_new(wmem_allocator_t *allocator, guint key_len)
+{
+    wmem_prefix_tree_t *tree;
+
+    g_assert(key_len > 0 && key_len <= WMEM_PREFIX_TREE_MAX_KEY_LEN);
+
+    tree = wmem_new(allocator, wmem_prefix_tree_t);
+    tree->allocator = allocator;
+    tree->root      = NULL;
+    tree->key_len   = key_len;
+    tree->key_bits  = key_len * 8;
+    tree->count     = 0;
+
+    return tree;
+}
+
+void *
+wmem_prefix_tree_insert(wmem_prefix_tree_t *tree, const guint8 *key,
+        guint prefix_len, void *value)
+{
+    wmem_prefix_tree_node_t **link = &tree->root;
+    wmem_prefix_tree_node_t  *node, *new_node, *glue;
+    guint common;
+
+    g_assert(value != NULL);
+    g_assert(prefix_len <= tree->key_bits);
+
+    while ((node = *link) != NULL) {
+        common = prefix_tree_common_len(node->key, key,
+                MIN(node->prefix_len, prefix_len));
+
+        if (common == node->prefix_len) {
+            if (common == prefix_len) {
+                /* Exact prefix already in the tree (perhaps as a glue node) */
+                void *old_value = node->value;
+
+                if (old_value == NULL)
+                    tree->count++;
+                node->value = value;
+                return old_value;
+            }
+            /* The node's prefix covers ours; descend */
+            link = &node->child[prefix_tree_get_bit(key, node->prefix_len)];
+            continue;
+        }
+
+        new_node = prefix_tree_new_node(tree, key, prefix_len, value);
+        tree->count++;
+
+        if (common == prefix_len) {
+            /* Our prefix covers the node's; insert above it */
+            new_node->child[prefix_tree_get_bit(node->key, prefix_len)] = node;
+            *link = new_node;
+        } else {
+            /* The prefixes diverge; join them under a glue node */
+            glue = prefix_tree_new_node(tree, key, common, NULL);
+            glue->child[prefix_tree_get_bit(node->key, common)] = node;
+            glue->child[prefix_tree_get_bit(key, common)] = new_node;
+            *link = glue;
+        }
+        return NULL;
+    }
+
+    *link = prefix_tree_new_node(tree, key, prefix_len, value);
+    tree->count++;
+
+    return NULL;
+}
+
+void *
+wmem_prefix_tree_lookup(wmem_prefix_tree_t *tree, const guint8 *key,
+        guint *prefix_len)
+{
+    wmem_prefix_tree_node_t *node = tree->root;
+    wmem_prefix_tree_node_t *best = NULL;
+
+    while (node && prefix_tree_match(node->key, key, node->prefix_len)) {
+        if (node->value) {
+            best = node;
+        }
+        if (node->prefix_len == tree->key_bits) {
+            break;
+        }
+        node = node->child[prefix_tree_get_bit(key, node->prefix_len)];
+    }
+
+    if (best == NULL) {
+        return NULL;
+    }
+
+    if (prefix_len) {
+        *prefix_len = best->prefix_len;
+    }
+
+    return best->value;
+}
+
+void *
+wmem_prefix_tree_lookup_exact(wmem_prefix_tree_t *tree, const guint8 *key,
+        guint prefix_len)
+{
+    wmem_prefix_tree_node_t *node = tree->root;
+
+    while (node && node->prefix_len <= prefix_len &&
+            prefix_tree_match(node->key, key, node->prefix_len)) {
+        if (node->prefix_len == prefix_len) {
+            return node->value;
+        }
+        node = node->child[prefix_tree_get_bit(key, node->prefix_len)];
+    }
+
+    return NULL;
+}
+
+guint
+wmem_prefix_tree_count(const wmem_prefix_tree_t *tree)
+{
+    return tree->count;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
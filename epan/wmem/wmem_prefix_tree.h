@@ -0,0 +1,136 @@
+/* wmem_prefix_tree.h
+ * Definitions for the Wireshark Memory Manager Longest-Prefix-Match Tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __WMEM_PREFIX_TREE_H__
+#define __WMEM_PREFIX_TREE_H__
+
+#include <glib.h>
+
+#include "wmem_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @addtogroup wmem
+ *  @{
+ *    @defgroup wmem-prefix-tree Prefix Tree
+ *
+ *    A path-compressed binary trie (PATRICIA tree) keyed by bit strings of up
+ *    to WMEM_PREFIX_TREE_MAX_KEY_LEN bytes. Each stored entry covers a prefix
+ *    of a given length in bits, and lookups return the value of the longest
+ *    stored prefix matching the key, as needed for IPv4/IPv6 subnet or
+ *    MAC address block resolution. Lookups cost at most one node visit per
+ *    distinct stored prefix length on the path, independently of the number
+ *    of entries.
+ *
+ *    @{
+ */
+
+/** The maximum key length in bytes (enough for an IPv6 address). */
+#define WMEM_PREFIX_TREE_MAX_KEY_LEN 16
+
+struct _wmem_prefix_tree_t;
+typedef struct _wmem_prefix_tree_t wmem_prefix_tree_t;
+
+/** Creates a prefix tree with the given allocator scope. When the scope is
+ * emptied, the tree is fully destroyed.
+ *
+ * @param allocator The allocator scope with which to create the tree.
+ * @param key_len   The length in bytes of the keys used with this tree; it
+ *                  must not exceed WMEM_PREFIX_TREE_MAX_KEY_LEN.
+ * @return The newly-allocated tree.
+ */
+WS_DLL_PUBLIC
+wmem_prefix_tree_t *
+wmem_prefix_tree_new(wmem_allocator_t *allocator, guint key_len)
+G_GNUC_MALLOC;
+
+/** Inserts a value for a prefix. Bits of the key past prefix_len are
+ * ignored. If the prefix was already present its value is replaced.
+ *
+ * @param tree The tree to insert into.
+ * @param key The key (of the tree's key length) holding the prefix bits.
+ * @param prefix_len The prefix length in bits, from 0 to 8 * key_len.
+ * @param value The value to insert; must not be NULL.
+ * @return The previous value stored for this prefix if any, or NULL.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_prefix_tree_insert(wmem_prefix_tree_t *tree, const guint8 *key,
+        guint prefix_len, void *value);
+
+/** Finds the value of the longest stored prefix matching a key.
+ *
+ * @param tree The tree to search in.
+ * @param key The key (of the tree's key length) to look up.
+ * @param prefix_len If not NULL, set to the length in bits of the matching
+ *                   prefix (only meaningful when a value is returned).
+ * @return The value stored for the longest matching prefix, or NULL.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_prefix_tree_lookup(wmem_prefix_tree_t *tree, const guint8 *key,
+        guint *prefix_len);
+
+/** Finds the value stored for an exact prefix.
+ *
+ * @param tree The tree to search in.
+ * @param key The key holding the prefix bits.
+ * @param prefix_len The prefix length in bits.
+ * @return The value stored for exactly this prefix, or NULL.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_prefix_tree_lookup_exact(wmem_prefix_tree_t *tree, const guint8 *key,
+        guint prefix_len);
+
+/** Returns the number of prefixes stored in the tree.
+ *
+ * @param tree The tree to use.
+ * @return The number of stored prefixes.
+ */
+WS_DLL_PUBLIC
+guint
+wmem_prefix_tree_count(const wmem_prefix_tree_t *tree);
+
+/**   @}
+ *  @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_PREFIX_TREE_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -56,6 +56,11 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
     allocator->callbacks = NULL;
     allocator->in_scope = TRUE;
 
+    allocator->chunk_usage = NULL;
+    allocator->alloc_count = 0;
+    allocator->alloc_bytes = 0;
+    allocator->free_all_count = 0;
+
     switch (type) {
         case WMEM_ALLOCATOR_SIMPLE:
             wmem_simple_allocator_init(allocator);
@@ -206,6 +211,64 @@ wmem_test_allocator_callbacks(void)
     g_assert(cb_called_count == 3);
 }
 
+static void
+wmem_test_allocator_stats_type(wmem_allocator_type_t type)
+{
+    wmem_allocator_t       *allocator;
+    wmem_allocator_stats_t  stats;
+    char                   *ptr;
+
+    allocator = wmem_allocator_force_new(type);
+
+    wmem_allocator_get_stats(allocator, &stats);
+    g_assert(stats.alloc_count == 0);
+    g_assert(stats.alloc_bytes == 0);
+    g_assert(stats.free_all_count == 0);
+
+    wmem_alloc(allocator, 100);
+    wmem_alloc(allocator, 0);
+    ptr = (char *)wmem_alloc(allocator, 100);
+    ptr = (char *)wmem_realloc(allocator, ptr, 200);
+    wmem_free(allocator, ptr);
+
+    wmem_allocator_get_stats(allocator, &stats);
+    g_assert(stats.alloc_count == 3);
+    g_assert(stats.alloc_bytes == 400);
+    if (type != WMEM_ALLOCATOR_SIMPLE) {
+        g_assert(stats.chunk_count > 0);
+        g_assert(stats.chunk_bytes >= 100);
+    }
+
+    wmem_alloc(allocator, 10*1024*1024);
+
+    wmem_allocator_get_stats(allocator, &stats);
+    g_assert(stats.alloc_count == 4);
+    if (type != WMEM_ALLOCATOR_SIMPLE) {
+        g_assert(stats.chunk_bytes >= 10*1024*1024 + 100);
+    }
+
+    wmem_free_all(allocator);
+    wmem_gc(allocator);
+
+    wmem_allocator_get_stats(allocator, &stats);
+    g_assert(stats.alloc_count == 4);
+    g_assert(stats.free_all_count == 1);
+    if (type != WMEM_ALLOCATOR_SIMPLE) {
+        g_assert(stats.chunk_bytes < 10*1024*1024);
+    }
+
+    wmem_destroy_allocator(allocator);
+}
+
+static void
+wmem_test_allocator_stats(void)
+{
+    wmem_test_allocator_stats_type(WMEM_ALLOCATOR_BLOCK);
+    wmem_test_allocator_stats_type(WMEM_ALLOCATOR_BLOCK_FAST);
+    wmem_test_allocator_stats_type(WMEM_ALLOCATOR_SIMPLE);
+    wmem_test_allocator_stats_type(WMEM_ALLOCATOR_STRICT);
+}
+
 static void
 wmem_test_allocator_det(wmem_allocator_t *allocator, wmem_verify_func verify,
         guint len)
@@ -1274,6 +1337,193 @@ wmem_test_tree(void)
 }
 
 
+static void
+wmem_test_prefix_tree(void)
+{
+    wmem_allocator_t   *allocator;
+    wmem_prefix_tree_t *tree;
+    guint32            *prefixes;
+    guint              *lengths;
+    guint               i, j, len, best;
+    guint32             addr, mask;
+    guint8              key[16];
+    void               *value;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    tree = wmem_prefix_tree_new(allocator, 4);
+    g_assert(tree);
+    g_assert(wmem_prefix_tree_count(tree) == 0);
+    memset(key, 0, sizeof key);
+    g_assert(wmem_prefix_tree_lookup(tree, key, NULL) == NULL);
+
+    /* nested and diverging prefixes */
+    key[0] = 10;
+    wmem_prefix_tree_insert(tree, key, 8, GINT_TO_POINTER(8));
+    key[1] = 1;
+    wmem_prefix_tree_insert(tree, key, 16, GINT_TO_POINTER(16));
+    key[1] = 2;
+    wmem_prefix_tree_insert(tree, key, 16, GINT_TO_POINTER(17));
+    key[2] = 128;
+    wmem_prefix_tree_insert(tree, key, 25, GINT_TO_POINTER(25));
+    g_assert(wmem_prefix_tree_count(tree) == 4);
+    g_assert(wmem_prefix_tree_insert(tree, key, 25, GINT_TO_POINTER(26)) ==
+            GINT_TO_POINTER(25));
+    g_assert(wmem_prefix_tree_count(tree) == 4);
+
+    key[3] = 7;
+    g_assert(wmem_prefix_tree_lookup(tree, key, &len) == GINT_TO_POINTER(26));
+    g_assert(len == 25);
+    key[2] = 127;
+    g_assert(wmem_prefix_tree_lookup(tree, key, &len) == GINT_TO_POINTER(17));
+    g_assert(len == 16);
+    key[1] = 3;
+    g_assert(wmem_prefix_tree_lookup(tree, key, &len) == GINT_TO_POINTER(8));
+    g_assert(len == 8);
+    key[0] = 11;
+    g_assert(wmem_prefix_tree_lookup(tree, key, NULL) == NULL);
+    key[0] = 10; key[1] = 2; key[2] = 0;
+    g_assert(wmem_prefix_tree_lookup_exact(tree, key, 16) == GINT_TO_POINTER(17));
+    g_assert(wmem_prefix_tree_lookup_exact(tree, key, 15) == NULL);
+    wmem_free_all(allocator);
+
+    /* compare random IPv4 prefixes against a linear search */
+    prefixes = wmem_alloc_array(allocator, guint32, CONTAINER_ITERS);
+    lengths  = wmem_alloc_array(allocator, guint, CONTAINER_ITERS);
+    tree = wmem_prefix_tree_new(allocator, 4);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        lengths[i]  = g_test_rand_int_range(0, 33);
+        mask        = lengths[i] ? 0xFFFFFFFFU << (32 - lengths[i]) : 0;
+        /* keep a few common leading bits so that prefixes nest */
+        prefixes[i] = (g_test_rand_int() & 0x0FFFFFFF) & mask;
+        key[0] = prefixes[i] >> 24;
+        key[1] = prefixes[i] >> 16;
+        key[2] = prefixes[i] >> 8;
+        key[3] = prefixes[i];
+        wmem_prefix_tree_insert(tree, key, lengths[i], GINT_TO_POINTER(i+1));
+    }
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        addr = g_test_rand_int() & 0x0FFFFFFF;
+        best = CONTAINER_ITERS;
+        for (j=0; j<CONTAINER_ITERS; j++) {
+            mask = lengths[j] ? 0xFFFFFFFFU << (32 - lengths[j]) : 0;
+            if ((addr & mask) == prefixes[j] &&
+                    (best == CONTAINER_ITERS || lengths[j] >= lengths[best])) {
+                best = j;
+            }
+        }
+        key[0] = addr >> 24;
+        key[1] = addr >> 16;
+        key[2] = addr >> 8;
+        key[3] = addr;
+        value = wmem_prefix_tree_lookup(tree, key, &len);
+        if (best == CONTAINER_ITERS) {
+            g_assert(value == NULL);
+        } else {
+            g_assert(value != NULL);
+            g_assert(len == lengths[best]);
+            j = GPOINTER_TO_INT(value) - 1;
+            g_assert(prefixes[j] == prefixes[best]);
+        }
+    }
+    wmem_strict_check_canaries(allocator);
+
+    /* IPv6-sized keys */
+    tree = wmem_prefix_tree_new(allocator, 16);
+    memset(key, 0, sizeof key);
+    key[0] = 0x20; key[1] = 0x01; key[2] = 0x0d; key[3] = 0xb8;
+    wmem_prefix_tree_insert(tree, key, 32, GINT_TO_POINTER(32));
+    key[7] = 0x01;
+    wmem_prefix_tree_insert(tree, key, 64, GINT_TO_POINTER(64));
+    key[15] = 0x42;
+    g_assert(wmem_prefix_tree_lookup(tree, key, &len) == GINT_TO_POINTER(64));
+    g_assert(len == 64);
+    key[7] = 0x02;
+    g_assert(wmem_prefix_tree_lookup(tree, key, &len) == GINT_TO_POINTER(32));
+    g_assert(len == 32);
+    wmem_prefix_tree_insert(tree, key, 128, GINT_TO_POINTER(128));
+    g_assert(wmem_prefix_tree_lookup(tree, key, &len) == GINT_TO_POINTER(128));
+    g_assert(len == 128);
+
+    wmem_destroy_allocator(allocator);
+}
+
+/* NOTE: You have to run "wmem_test --verbose" to see results. */
+static void
+wmem_test_prefix_tree_perf(void)
+{
+#define PREFIX_COUNT  (20 * 1000)
+#define LOOKUP_COUNT  (1 * 1000 * 1000)
+    wmem_allocator_t   *allocator;
+    wmem_prefix_tree_t *tree;
+    wmem_map_t         *maps[32];
+    guint32            *addrs;
+    guint32             prefix, mask, masked;
+    guint               i, len, found;
+    guint8              key[4];
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    /* A subnets file of PREFIX_COUNT entries of assorted lengths, stored both
+     * in a prefix tree and in one hash map per mask length (the layout
+     * addr_resolv used to probe, longest first). */
+    tree = wmem_prefix_tree_new(allocator, 4);
+    for (i=0; i<32; i++) {
+        maps[i] = wmem_map_new(allocator, g_direct_hash, g_direct_equal);
+    }
+    for (i=0; i<PREFIX_COUNT; i++) {
+        len    = g_test_rand_int_range(8, 33);
+        mask   = 0xFFFFFFFFU << (32 - len);
+        prefix = g_test_rand_int() & mask;
+        key[0] = prefix >> 24;
+        key[1] = prefix >> 16;
+        key[2] = prefix >> 8;
+        key[3] = prefix;
+        wmem_prefix_tree_insert(tree, key, len, GINT_TO_POINTER(len));
+        wmem_map_insert(maps[len-1], GUINT_TO_POINTER(prefix), GINT_TO_POINTER(len));
+    }
+
+    addrs = wmem_alloc_array(allocator, guint32, LOOKUP_COUNT);
+    for (i=0; i<LOOKUP_COUNT; i++) {
+        addrs[i] = g_test_rand_int();
+    }
+
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i=0; i<LOOKUP_COUNT; i++) {
+        for (len = 32; len > 0; len--) {
+            masked = addrs[i] & (0xFFFFFFFFU << (32 - len));
+            if (wmem_map_lookup(maps[len-1], GUINT_TO_POINTER(masked))) {
+                found++;
+                break;
+            }
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "per-length hash maps, %u lookups (%u found): u %.3f ms s %.3f ms",
+        LOOKUP_COUNT, found, utime_ms, stime_ms);
+
+    found = 0;
+    RESOURCE_USAGE_START;
+    for (i=0; i<LOOKUP_COUNT; i++) {
+        key[0] = addrs[i] >> 24;
+        key[1] = addrs[i] >> 16;
+        key[2] = addrs[i] >> 8;
+        key[3] = addrs[i];
+        if (wmem_prefix_tree_lookup(tree, key, NULL)) {
+            found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "prefix tree, %u lookups (%u found): u %.3f ms s %.3f ms",
+        LOOKUP_COUNT, found, utime_ms, stime_ms);
+
+    wmem_destroy_allocator(allocator);
+}
+
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
     wmem_range_t range;
@@ -1390,12 +1640,14 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/stats",     wmem_test_allocator_stats);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);
 
     if (!g_test_perf ()) {
         g_test_add_func("/wmem/utils/stringperf", wmem_test_stringperf);
+        g_test_add_func("/wmem/datastruct/prefix_tree_perf", wmem_test_prefix_tree_perf);
     }
 
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
@@ -1406,6 +1658,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
+    g_test_add_func("/wmem/datastruct/prefix_tree", wmem_test_prefix_tree);
 
     ret = g_test_run();
 
@@ -33,6 +33,7 @@
 #include <wsutil/tempfile.h>
 #include <wsutil/file_util.h>
 #include <wsutil/filesystem.h>
+#include <wsutil/ws_mempbrk.h>
 #include <ws_version_info.h>
 
 #include <wiretap/merge.h>
@@ -64,6 +65,7 @@
 #include "ui/simple_dialog.h"
 #include "ui/main_statusbar.h"
 #include "ui/progress_dlg.h"
+#include "ui/search_index.h"
 #include "ui/ui_util.h"
 
 /* Needed for addrinfo */
@@ -110,15 +112,17 @@ static match_result match_protocol_tree(capture_file *cf, frame_data *fdata,
 static void match_subtree_text(proto_node *node, gpointer data);
 static match_result match_summary_line(capture_file *cf, frame_data *fdata,
     void *criterion);
-static match_result match_narrow_and_wide(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_narrow(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_wide(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_binary(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_regex(capture_file *cf, frame_data *fdata,
+static gboolean find_narrow_and_wide(const guint8 *pd, guint32 buf_len,
+    void *criterion, guint32 *pos, guint32 *len);
+static gboolean find_narrow(const guint8 *pd, guint32 buf_len,
+    void *criterion, guint32 *pos, guint32 *len);
+static gboolean find_wide(const guint8 *pd, guint32 buf_len,
+    void *criterion, guint32 *pos, guint32 *len);
+static gboolean find_binary(const guint8 *pd, guint32 buf_len,
+    void *criterion, guint32 *pos, guint32 *len);
+static gboolean find_regex(const guint8 *pd, guint32 buf_len,
+    void *criterion, guint32 *pos, guint32 *len);
+static match_result match_data(capture_file *cf, frame_data *fdata,
     void *criterion);
 static match_result match_dfilter(capture_file *cf, frame_data *fdata,
     void *criterion);
@@ -129,6 +133,19 @@ static match_result match_time_reference(capture_file *cf, frame_data *fdata,
 static gboolean find_packet(capture_file *cf,
     match_result (*match_function)(capture_file *, frame_data *, void *),
     void *criterion, search_direction dir);
+static gboolean find_packet_data(capture_file *cf,
+    gboolean (*find_function)(const guint8 *, guint32, void *, guint32 *, guint32 *),
+    void *criterion, const guint8 *index_key, size_t index_key_len,
+    search_direction dir);
+static gboolean find_packet_select(capture_file *cf, frame_data *new_fd);
+static void find_dfilter_cache_clear(capture_file *cf);
+static void record_cache_free(capture_file *cf);
+#ifdef HAVE_LIBPCAP
+static void tail_state_free(capture_file *cf);
+#endif
+static void find_dfilter_cache_forget(capture_file *cf, guint32 framenum);
+static void cf_search_index_start(capture_file *cf);
+static void cf_search_index_discard(capture_file *cf);
 
 static const char *cf_get_user_packet_comment(capture_file *cf, const frame_data *fd);
 
@@ -339,6 +356,8 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   cf->marked_count = 0;
   cf->ignored_count = 0;
   cf->ref_time_count = 0;
+  memset(&cf->frame_tally, 0, sizeof cf->frame_tally);
+  cf->frame_tally.valid = TRUE;
   cf->drops_known = FALSE;
   cf->drops     = 0;
   cf->snap      = wtap_snapshot_length(cf->wth);
@@ -399,6 +418,14 @@ cf_close(capture_file *cf)
 
   cf_callback_invoke(cf_cb_file_closing, cf);
 
+  /* Stop indexing the file and throw the index away. */
+  cf_search_index_discard(cf);
+  find_dfilter_cache_clear(cf);
+  record_cache_free(cf);
+#ifdef HAVE_LIBPCAP
+  tail_state_free(cf);
+#endif
+
   /* close things, if not already closed before */
   color_filters_cleanup();
 
@@ -570,6 +597,8 @@ cf_read(capture_file *cf, gboolean reloading)
     (dfcode != NULL || have_filtering_tap_listeners() ||
      (tap_flags & TL_REQUIRES_PROTO_TREE) || postdissectors_want_hfids());
 
+  /* All the tap listeners see every packet we read. */
+  start_tap_listeners_retap(FALSE);
   reset_tap_listeners();
 
   name_ptr = g_filename_display_basename(cf->filename);
@@ -687,6 +716,9 @@ cf_read(capture_file *cf, gboolean reloading)
 
   epan_dissect_cleanup(&edt);
 
+  /* Unless we stopped early, the tap listeners are up to date. */
+  finish_tap_listeners_retap(!is_read_aborted && !cf->stop_flag && err == 0);
+
   /* We're done reading the file; destroy the progress bar if it was created. */
   if (progbar != NULL)
     destroy_progress_dlg(progbar);
@@ -711,6 +743,11 @@ cf_read(capture_file *cf, gboolean reloading)
      WTAP_ENCAP_PER_PACKET). */
   cf->lnk_t = wtap_file_encap(cf->wth);
 
+  /* Index the frame data in the background, if asked to, to speed up
+     searches. */
+  if (prefs.gui_find_index)
+    cf_search_index_start(cf);
+
   cf->current_frame = frame_data_sequence_find(cf->frames, cf->first_displayed);
   cf->current_row = 0;
 
@@ -757,23 +794,95 @@ cf_read(capture_file *cf, gboolean reloading)
 }
 
 #ifdef HAVE_LIBPCAP
+/*
+ * State kept in cf->tail_state between calls to cf_continue_tail().
+ *
+ * The display filter is compiled once and reused as long as it doesn't
+ * change.  Each call processes records for at most TAIL_BATCH_TIME
+ * seconds so that the GUI stays responsive; records it didn't get to
+ * are carried over to the next call.  While there is such a backlog we
+ * only scroll to the end of the packet list every TAIL_SCROLL_INTERVAL
+ * seconds, as scrolling makes the list dissect and colorize the rows
+ * that come into view.
+ */
+#define TAIL_BATCH_TIME       0.1
+#define TAIL_SCROLL_INTERVAL  1.0
+
+typedef struct _tail_state {
+  gchar     *dfilter;       /* Text of the compiled filter */
+  dfilter_t *dfcode;
+  gboolean   compiled;
+  int        backlog;       /* Records left over from the last call */
+  GTimer    *scroll_timer;  /* Time since we last scrolled to the end */
+} tail_state_t;
+
+static tail_state_t *
+tail_state_get(capture_file *cf)
+{
+  if (cf->tail_state == NULL)
+    cf->tail_state = g_new0(tail_state_t, 1);
+  return cf->tail_state;
+}
+
+static dfilter_t *
+tail_get_dfilter(capture_file *cf)
+{
+  tail_state_t *tail_state = tail_state_get(cf);
+
+  if (!tail_state->compiled || g_strcmp0(tail_state->dfilter, cf->dfilter) != 0) {
+    gboolean compiled;
+
+    dfilter_free(tail_state->dfcode);
+    g_free(tail_state->dfilter);
+
+    /* Compile the current display filter.
+     * We assume this will not fail since cf->dfilter is only set in
+     * cf_filter IFF the filter was valid.
+     */
+    compiled = dfilter_compile(cf->dfilter, &tail_state->dfcode, NULL);
+    g_assert(!cf->dfilter || (compiled && tail_state->dfcode));
+    tail_state->dfilter = g_strdup(cf->dfilter);
+    tail_state->compiled = TRUE;
+  }
+  return tail_state->dfcode;
+}
+
+static void
+tail_state_free(capture_file *cf)
+{
+  tail_state_t *tail_state = cf->tail_state;
+
+  if (tail_state == NULL)
+    return;
+  dfilter_free(tail_state->dfcode);
+  g_free(tail_state->dfilter);
+  if (tail_state->scroll_timer)
+    g_timer_destroy(tail_state->scroll_timer);
+  g_free(tail_state);
+  cf->tail_state = NULL;
+}
+
+int
+cf_tail_backlog(capture_file *cf)
+{
+  return cf->tail_state ? cf->tail_state->backlog : 0;
+}
+
 cf_read_status_t
 cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
 {
   gchar            *err_info;
   volatile int      newly_displayed_packets = 0;
+  tail_state_t     *tail_state;
   dfilter_t        *dfcode;
   epan_dissect_t    edt;
   gboolean          create_proto_tree;
   guint             tap_flags;
-  gboolean          compiled;
+  GTimer           *batch_timer;
 
-  /* Compile the current display filter.
-   * We assume this will not fail since cf->dfilter is only set in
-   * cf_filter IFF the filter was valid.
-   */
-  compiled = dfilter_compile(cf->dfilter, &dfcode, NULL);
-  g_assert(!cf->dfilter || (compiled && dfcode));
+  /* Get the display filter, compiling it if it has changed. */
+  dfcode = tail_get_dfilter(cf);
+  tail_state = tail_state_get(cf);
 
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
@@ -805,6 +914,11 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
 
   epan_dissect_init(&edt, cf->epan, create_proto_tree, FALSE);
 
+  /* Catch up with what we didn't get to last time. */
+  to_read += tail_state->backlog;
+  tail_state->backlog = 0;
+  batch_timer = g_timer_new();
+
   TRY {
     gint64 data_offset = 0;
     column_info *cinfo;
@@ -813,6 +927,11 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
     cinfo = (tap_flags & TL_REQUIRES_COLUMNS) ? &cf->cinfo : NULL;
 
     while (to_read != 0) {
+      if (g_timer_elapsed(batch_timer, NULL) > TAIL_BATCH_TIME) {
+        /* Let the GUI catch up; we'll read the rest next time. */
+        tail_state->backlog = to_read;
+        break;
+      }
       wtap_cleareof(cf->wth);
       if (!wtap_read(cf->wth, err, &err_info, &data_offset)) {
         break;
@@ -848,10 +967,7 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
      packets we've read. */
   cf->lnk_t = wtap_file_encap(cf->wth);
 
-  /* Cleanup and release all dfilter resources */
-  if (dfcode != NULL) {
-    dfilter_free(dfcode);
-  }
+  g_timer_destroy(batch_timer);
 
   epan_dissect_cleanup(&edt);
 
@@ -867,9 +983,18 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
     packet_list_select_first_row();
 
   /* moving to the end of the packet list - if the user requested so and
-     we have some new packets. */
-  if (newly_displayed_packets && auto_scroll_live && cf->count != 0)
+     we have some new packets, and not too often if we're falling behind. */
+  if (newly_displayed_packets && auto_scroll_live && cf->count != 0) {
+    if (tail_state->scroll_timer == NULL)
+      tail_state->scroll_timer = g_timer_new();
+    else if (tail_state->backlog != 0 &&
+             g_timer_elapsed(tail_state->scroll_timer, NULL) < TAIL_SCROLL_INTERVAL)
+      newly_displayed_packets = 0;
+    if (newly_displayed_packets) {
       packet_list_moveto_end();
+      g_timer_start(tail_state->scroll_timer);
+    }
+  }
 
   if (cf->state == FILE_READ_ABORTED) {
     /* Well, the user decided to exit Wireshark.  Return CF_READ_ABORTED
@@ -918,6 +1043,9 @@ cf_finish_tail(capture_file *cf, int *err)
   compiled = dfilter_compile(cf->dfilter, &dfcode, NULL);
   g_assert(!cf->dfilter || (compiled && dfcode));
 
+  /* We read everything that's left; forget about the tail state. */
+  tail_state_free(cf);
+
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
 
@@ -1117,6 +1245,61 @@ void cf_set_rfcode(capture_file *cf, dfilter_t *rfcode)
   cf->rfcode = rfcode;
 }
 
+/*
+ * Running totals for the summary (cf->frame_tally).
+ */
+static void
+tally_time(const frame_data *fdata, guint32 *count_ts, double *start, double *stop)
+{
+  double cur_time;
+
+  if (!fdata->flags.has_ts)
+    return;
+
+  cur_time = nstime_to_sec(&fdata->abs_ts);
+  if ((*count_ts)++ == 0) {
+    *start = cur_time;
+    *stop = cur_time;
+  } else {
+    if (cur_time < *start)
+      *start = cur_time;
+    if (cur_time > *stop)
+      *stop = cur_time;
+  }
+}
+
+static void
+tally_frame(frame_tally_t *ft, const frame_data *fdata)
+{
+  ft->bytes += fdata->pkt_len;
+  tally_time(fdata, &ft->count_ts, &ft->start_time, &ft->stop_time);
+}
+
+static void
+tally_filtered_frame(frame_tally_t *ft, const frame_data *fdata)
+{
+  ft->filtered_count++;
+  ft->filtered_bytes += fdata->pkt_len;
+  tally_time(fdata, &ft->filtered_count_ts, &ft->filtered_start, &ft->filtered_stop);
+}
+
+static void
+tally_marked_frame(frame_tally_t *ft, const frame_data *fdata)
+{
+  ft->marked_bytes += fdata->pkt_len;
+  tally_time(fdata, &ft->marked_count_ts, &ft->marked_start, &ft->marked_stop);
+}
+
+static void
+tally_reset_filtered(frame_tally_t *ft)
+{
+  ft->filtered_count = 0;
+  ft->filtered_bytes = 0;
+  ft->filtered_count_ts = 0;
+  ft->filtered_start = 0;
+  ft->filtered_stop = 0;
+}
+
 static int
 add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     epan_dissect_t *edt, dfilter_t *dfcode, column_info *cinfo,
@@ -1164,6 +1347,9 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
   } else
     fdata->flags.passed_dfilter = 1;
 
+  if (fdata->flags.passed_dfilter)
+    tally_filtered_frame(&cf->frame_tally, fdata);
+
   if (fdata->flags.passed_dfilter || fdata->flags.ref_time)
     cf->displayed_count++;
 
@@ -1232,6 +1418,7 @@ read_packet(capture_file *cf, dfilter_t *dfcode, epan_dissect_t *edt,
     fdata = frame_data_sequence_add(cf->frames, &fdlocal);
 
     cf->count++;
+    tally_frame(&cf->frame_tally, fdata);
     if (phdr->opt_comment != NULL)
       cf->packet_comment_count++;
     cf->f_datalen = offset + fdlocal.cap_len;
@@ -1504,6 +1691,8 @@ cf_filter_packets(capture_file *cf, gchar *dftext, gboolean force)
 void
 cf_reftime_packets(capture_file *cf)
 {
+  /* Relative times of the frames may change. */
+  find_dfilter_cache_clear(cf);
   ref_time_packets(cf);
 }
 
@@ -1515,10 +1704,181 @@ cf_redissect_packets(capture_file *cf)
   }
 }
 
+/*
+ * Cache of the records read with cf_read_record_r().
+ *
+ * The GUI reads the same records again and again (selecting, coloring
+ * and dissecting visible rows, searching), and every read is a seek and
+ * a read in the file, which is slow for compressed or remote files.
+ * Records are kept, most recently used first, until they take more
+ * than RECORD_CACHE_MAX_BYTES.  When two misses in a row are for
+ * consecutive frames the following RECORD_CACHE_READ_AHEAD records in
+ * that direction are read as well.
+ */
+#define RECORD_CACHE_MAX_BYTES   (16 * 1024 * 1024)
+#define RECORD_CACHE_READ_AHEAD  64
+
+typedef struct {
+  GList              link;      /* In the LRU queue; data points to the entry */
+  guint32            framenum;
+  struct wtap_pkthdr phdr;      /* Owns its ft_specific_data and opt_comment */
+  guint8            *pd;
+  gsize              size;      /* Memory accounted for the entry */
+} record_cache_entry_t;
+
+typedef struct _cf_record_cache {
+  GHashTable        *entries;   /* Frame number -> record_cache_entry_t */
+  GQueue             lru;       /* Most recently used first */
+  gsize              bytes;
+  guint32            last_miss; /* Frame number of the last miss */
+  struct wtap_pkthdr ra_phdr;   /* For read-ahead */
+  Buffer             ra_buf;
+  cf_record_cache_stats_t stats;
+} cf_record_cache_t;
+
+static void
+record_cache_entry_free(gpointer data)
+{
+  record_cache_entry_t *entry = (record_cache_entry_t *)data;
+
+  wtap_phdr_cleanup(&entry->phdr);
+  g_free(entry->phdr.opt_comment);
+  g_free(entry->pd);
+  g_free(entry);
+}
+
+static void
+record_cache_free(capture_file *cf)
+{
+  cf_record_cache_t *cache = cf->record_cache;
+
+  if (cache == NULL)
+    return;
+
+  g_hash_table_destroy(cache->entries);
+  wtap_phdr_cleanup(&cache->ra_phdr);
+  ws_buffer_free(&cache->ra_buf);
+  g_free(cache);
+  cf->record_cache = NULL;
+}
+
+static void
+record_cache_remove(cf_record_cache_t *cache, record_cache_entry_t *entry)
+{
+  g_queue_unlink(&cache->lru, &entry->link);
+  cache->bytes -= entry->size;
+  g_hash_table_remove(cache->entries, GUINT_TO_POINTER(entry->framenum));
+}
+
+static void
+record_cache_add(cf_record_cache_t *cache, guint32 framenum,
+                 const struct wtap_pkthdr *phdr, const guint8 *pd)
+{
+  record_cache_entry_t *entry;
+  guint ft_len = ws_buffer_length((Buffer *)&phdr->ft_specific_data);
+  gsize size;
+
+  size = sizeof(record_cache_entry_t) + phdr->caplen + ft_len;
+  if (phdr->opt_comment)
+    size += strlen(phdr->opt_comment) + 1;
+  if (size > RECORD_CACHE_MAX_BYTES / 4)
+    return;
+
+  entry = (record_cache_entry_t *)g_hash_table_lookup(cache->entries, GUINT_TO_POINTER(framenum));
+  if (entry)
+    record_cache_remove(cache, entry);
+
+  while (cache->bytes + size > RECORD_CACHE_MAX_BYTES && cache->lru.tail)
+    record_cache_remove(cache, (record_cache_entry_t *)cache->lru.tail->data);
+
+  entry = g_new(record_cache_entry_t, 1);
+  entry->framenum = framenum;
+  entry->phdr = *phdr;
+  ws_buffer_init(&entry->phdr.ft_specific_data, ft_len);
+  if (ft_len)
+    ws_buffer_append(&entry->phdr.ft_specific_data,
+                     ws_buffer_start_ptr((Buffer *)&phdr->ft_specific_data), ft_len);
+  entry->phdr.opt_comment = g_strdup(phdr->opt_comment);
+  entry->pd = (guint8 *)g_memdup(pd, phdr->caplen);
+  entry->size = size;
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
+
+  g_queue_push_head_link(&cache->lru, &entry->link);
+  cache->bytes += size;
+  g_hash_table_insert(cache->entries, GUINT_TO_POINTER(framenum), entry);
+}
+
+/* Copies a cached record to the caller's header and buffer. */
+static void
+record_cache_fill(cf_record_cache_t *cache, record_cache_entry_t *entry,
+                  struct wtap_pkthdr *phdr, Buffer *buf)
+{
+  Buffer ft_specific_data = phdr->ft_specific_data;
+
+  *phdr = entry->phdr;
+  phdr->ft_specific_data = ft_specific_data;
+  ws_buffer_clean(&phdr->ft_specific_data);
+  if (ws_buffer_length(&entry->phdr.ft_specific_data))
+    ws_buffer_append_buffer(&phdr->ft_specific_data, &entry->phdr.ft_specific_data);
+  /* As with wiretap, the caller gets its own copy of the comment. */
+  phdr->opt_comment = g_strdup(entry->phdr.opt_comment);
+
+  ws_buffer_assure_space(buf, entry->phdr.caplen);
+  memcpy(ws_buffer_start_ptr(buf), entry->pd, entry->phdr.caplen);
+
+  g_queue_unlink(&cache->lru, &entry->link);
+  g_queue_push_head_link(&cache->lru, &entry->link);
+}
+
+static void
+record_cache_read_ahead(capture_file *cf, guint32 framenum, gint step)
+{
+  cf_record_cache_t *cache = cf->record_cache;
+  const frame_data  *fdata;
+  int                err;
+  gchar             *err_info = NULL;
+  int                i;
+
+  for (i = 0; i < RECORD_CACHE_READ_AHEAD; i++) {
+    framenum += step;
+    if (framenum < 1 || framenum > cf->count)
+      break;
+    if (g_hash_table_lookup(cache->entries, GUINT_TO_POINTER(framenum)))
+      continue;
+    fdata = frame_data_sequence_find(cf->frames, framenum);
+    if (fdata == NULL || fdata->file_off == -1)
+      break;
+    if (!wtap_seek_read(cf->wth, fdata->file_off, &cache->ra_phdr, &cache->ra_buf, &err, &err_info)) {
+      /* The error will be reported if the record is actually wanted. */
+      g_free(err_info);
+      break;
+    }
+    record_cache_add(cache, framenum, &cache->ra_phdr, ws_buffer_start_ptr(&cache->ra_buf));
+    g_free(cache->ra_phdr.opt_comment);
+    cache->ra_phdr.opt_comment = NULL;
+    cache->stats.read_ahead++;
+  }
+}
+
+void
+cf_get_record_cache_stats(capture_file *cf, cf_record_cache_stats_t *stats)
+{
+  if (cf->record_cache) {
+    *stats = cf->record_cache->stats;
+    stats->entries = g_hash_table_size(cf->record_cache->entries);
+    stats->bytes = cf->record_cache->bytes;
+  } else {
+    memset(stats, 0, sizeof(*stats));
+  }
+}
+
 gboolean
 cf_read_record_r(capture_file *cf, const frame_data *fdata,
                  struct wtap_pkthdr *phdr, Buffer *buf)
 {
+  cf_record_cache_t    *cache;
+  record_cache_entry_t *entry;
   int    err;
   gchar *err_info;
 
@@ -1539,10 +1899,38 @@ cf_read_record_r(capture_file *cf, const frame_data *fdata,
   }
 #endif
 
+  if (cf->record_cache == NULL) {
+    cache = g_new0(cf_record_cache_t, 1);
+    cache->entries = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                           NULL, record_cache_entry_free);
+    g_queue_init(&cache->lru);
+    wtap_phdr_init(&cache->ra_phdr);
+    ws_buffer_init(&cache->ra_buf, 1500);
+    cf->record_cache = cache;
+  }
+  cache = cf->record_cache;
+
+  entry = (record_cache_entry_t *)g_hash_table_lookup(cache->entries, GUINT_TO_POINTER(fdata->num));
+  if (entry) {
+    cache->stats.hits++;
+    record_cache_fill(cache, entry, phdr, buf);
+    return TRUE;
+  }
+  cache->stats.misses++;
+
   if (!wtap_seek_read(cf->wth, fdata->file_off, phdr, buf, &err, &err_info)) {
     cfile_read_failure_alert_box(cf->filename, err, err_info);
     return FALSE;
   }
+  record_cache_add(cache, fdata->num, phdr, ws_buffer_start_ptr(buf));
+
+  /* Read ahead if we seem to be going through the file in order. */
+  if (cache->last_miss != 0 && fdata->num == cache->last_miss + 1)
+    record_cache_read_ahead(cf, fdata->num, 1);
+  else if (fdata->num + 1 == cache->last_miss)
+    record_cache_read_ahead(cf, fdata->num, -1);
+  cache->last_miss = fdata->num;
+
   return TRUE;
 }
 
@@ -1595,6 +1983,21 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   compiled = dfilter_compile(cf->dfilter, &dfcode, NULL);
   g_assert(!cf->dfilter || (compiled && dfcode));
 
+  /* Frames may dissect differently from now on, and fields such as
+     frame.time_delta_displayed or frame.coloring_rule.name depend on
+     what is displayed and how it is colored. */
+  find_dfilter_cache_clear(cf);
+
+#ifdef HAVE_LIBPCAP
+  /* Fields or macros the filter uses may have changed; have the
+     tail code compile it again. */
+  if (cf->tail_state) {
+    dfilter_free(cf->tail_state->dfcode);
+    cf->tail_state->dfcode = NULL;
+    cf->tail_state->compiled = FALSE;
+  }
+#endif
+
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
 
@@ -1619,6 +2022,8 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
      (tap_flags & TL_REQUIRES_PROTO_TREE) ||
      (redissect && postdissectors_want_hfids()));
 
+  /* All the tap listeners see every packet we rescan. */
+  start_tap_listeners_retap(FALSE);
   reset_tap_listeners();
   /* Which frame, if any, is the currently selected frame?
      XXX - should the selected frame or the focus frame be the "current"
@@ -1672,6 +2077,7 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
 
   /* We currently don't display any packets */
   cf->displayed_count = 0;
+  tally_reset_filtered(&cf->frame_tally);
 
   /* Iterate through the list of frames.  Call a routine for each frame
      to check whether it should be displayed and, if so, add it to
@@ -1811,6 +2217,14 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
 
   epan_dissect_cleanup(&edt);
 
+  /* If we stopped early, the frames we didn't get to still have their
+     old filtering results. */
+  if (framenum <= frames_count)
+    cf->frame_tally.valid = FALSE;
+
+  /* Unless we stopped early, the tap listeners are up to date. */
+  finish_tap_listeners_retap(framenum > frames_count);
+
   /* We are done redissecting the packet list. */
   cf->redissecting = FALSE;
 
@@ -2140,8 +2554,8 @@ retap_packet(capture_file *cf, frame_data *fdata,
   return TRUE;
 }
 
-cf_read_status_t
-cf_retap_packets(capture_file *cf)
+static cf_read_status_t
+retap_packets(capture_file *cf, gboolean marked_only)
 {
   packet_range_t        range;
   retap_callback_args_t callback_args;
@@ -2156,6 +2570,9 @@ cf_retap_packets(capture_file *cf)
 
   cf_callback_invoke(cf_cb_file_retap_started, cf);
 
+  /* Select the tap listeners taking part in this retap. */
+  start_tap_listeners_retap(marked_only);
+
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
 
@@ -2189,6 +2606,8 @@ cf_retap_packets(capture_file *cf)
 
   epan_dissect_cleanup(&callback_args.edt);
 
+  finish_tap_listeners_retap(ret == PSP_FINISHED);
+
   cf_callback_invoke(cf_cb_file_retap_finished, cf);
 
   switch (ret) {
@@ -2210,6 +2629,18 @@ cf_retap_packets(capture_file *cf)
   return CF_READ_OK;
 }
 
+cf_read_status_t
+cf_retap_packets(capture_file *cf)
+{
+  return retap_packets(cf, FALSE);
+}
+
+cf_read_status_t
+cf_retap_marked_packets(capture_file *cf)
+{
+  return retap_packets(cf, TRUE);
+}
+
 typedef struct {
   print_args_t *print_args;
   gboolean      print_header_line;
@@ -3113,10 +3544,22 @@ match_summary_line(capture_file *cf, frame_data *fdata, void *criterion)
 }
 
 typedef struct {
-    const guint8 *data;
-    size_t        data_len;
+    const guint8      *data;
+    size_t             data_len;
+    gboolean           case_type;   /* ASCII case insensitive; data is upper case */
+    gboolean           use_anchor;  /* TRUE to look for the first character with anchor */
+    ws_mempbrk_pattern anchor;      /* First character in either case */
 } cbs_t;    /* "Counted byte string" */
 
+/* A routine looking for a match in the raw bytes of a frame. On success it
+ * returns the position of the last matching byte and the match length. */
+typedef gboolean (*match_data_func)(const guint8 *pd, guint32 buf_len,
+    void *criterion, guint32 *pos, guint32 *len);
+
+typedef struct {
+    match_data_func  func;
+    void            *criterion;
+} match_data_t;
 
 /*
  * The current match_* routines only support ASCII case insensitivity and don't
@@ -3128,257 +3571,376 @@ typedef struct {
  * significantly better.
  */
 
+static void
+cbs_init(cbs_t *info, const guint8 *string, size_t string_size, gboolean case_type)
+{
+  gchar needles[3];
+
+  info->data = string;
+  info->data_len = string_size;
+  info->case_type = case_type;
+
+  /* The search string is upper case when searching case insensitively,
+     so its first character may appear in the packet in either case.
+     Look for both at once with ws_mempbrk_exec() (which uses SSE4.2
+     when available); otherwise memchr() is used. */
+  info->use_anchor = FALSE;
+  if (case_type && string_size > 0 && g_ascii_isupper(string[0])) {
+    needles[0] = (gchar)string[0];
+    needles[1] = g_ascii_tolower(string[0]);
+    needles[2] = '\0';
+    ws_mempbrk_compile(&info->anchor, needles);
+    info->use_anchor = TRUE;
+  }
+}
+
+/* Returns a pointer to the next byte of pd[0..buf_len) that may start a
+   match, i.e. matches the first character of the string, or NULL. */
+static inline const guint8 *
+cbs_find_anchor(const cbs_t *info, const guint8 *pd, size_t buf_len)
+{
+  if (info->use_anchor)
+    return ws_mempbrk_exec(pd, buf_len, &info->anchor, NULL);
+  return (const guint8 *)memchr(pd, info->data[0], buf_len);
+}
+
+static inline gboolean
+cbs_char_matches(const cbs_t *info, guint8 c_char, guint8 text_char)
+{
+  if (info->case_type)
+    c_char = g_ascii_toupper(c_char);
+  return c_char == text_char;
+}
+
 gboolean
 cf_find_packet_data(capture_file *cf, const guint8 *string, size_t string_size,
                     search_direction dir)
 {
   cbs_t info;
 
-  info.data = string;
-  info.data_len = string_size;
+  if (string_size == 0 && !cf->regex)
+    return FALSE;
 
   /* Regex, String or hex search? */
   if (cf->regex) {
     /* Regular Expression search */
-    return find_packet(cf, match_regex, NULL, dir);
+    return find_packet_data(cf, find_regex, cf->regex, NULL, 0, dir);
   } else if (cf->string) {
+    cbs_init(&info, string, string_size, cf->case_type);
+
     /* String search - what type of string? */
     switch (cf->scs_type) {
 
     case SCS_NARROW_AND_WIDE:
-      return find_packet(cf, match_narrow_and_wide, &info, dir);
+      return find_packet_data(cf, find_narrow_and_wide, &info, NULL, 0, dir);
 
     case SCS_NARROW:
-      return find_packet(cf, match_narrow, &info, dir);
+      return find_packet_data(cf, find_narrow, &info, string, string_size, dir);
 
     case SCS_WIDE:
-      return find_packet(cf, match_wide, &info, dir);
+      return find_packet_data(cf, find_wide, &info, NULL, 0, dir);
 
     default:
       g_assert_not_reached();
       return FALSE;
     }
-  } else
-    return find_packet(cf, match_binary, &info, dir);
+  } else {
+    cbs_init(&info, string, string_size, FALSE);
+    return find_packet_data(cf, find_binary, &info, string, string_size, dir);
+  }
 }
 
-static match_result
-match_narrow_and_wide(capture_file *cf, frame_data *fdata, void *criterion)
+/* Matches the string with any number of NUL bytes between its characters,
+   so that both ASCII and UCS-2/UTF-16 text is found. */
+static gboolean
+find_narrow_and_wide(const guint8 *pd, guint32 buf_len, void *criterion,
+                     guint32 *pos, guint32 *len)
 {
   cbs_t        *info       = (cbs_t *)criterion;
   const guint8 *ascii_text = info->data;
   size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint8       *pd;
-  guint32       i;
-  guint8        c_char;
-  size_t        c_match    = 0;
-
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
-
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
-  i = 0;
-  while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = g_ascii_toupper(c_char);
-    if (c_char != '\0') {
-      if (c_char == ascii_text[c_match]) {
-        c_match += 1;
-        if (c_match == textlen) {
-          result = MR_MATCHED;
-          cf->search_pos = i; /* Save the position of the last character
-                                 for highlighting the field. */
-          cf->search_len = (guint32)textlen;
-          break;
-        }
-      }
-      else {
-        g_assert(i>=c_match);
-        i -= (guint32)c_match;
-        c_match = 0;
-      }
+  const guint8 *end        = pd + buf_len;
+  const guint8 *start      = pd;
+  const guint8 *p;
+  size_t        c_match;
+
+  while ((start = cbs_find_anchor(info, start, end - start)) != NULL) {
+    c_match = 1;
+    for (p = start + 1; c_match < textlen && p < end; p++) {
+      if (*p == '\0')
+        continue;
+      if (!cbs_char_matches(info, *p, ascii_text[c_match]))
+        break;
+      c_match++;
     }
-    i += 1;
+    if (c_match == textlen) {
+      *pos = (guint32)(p - 1 - pd); /* Position of the last character
+                                       for highlighting the field. */
+      *len = (guint32)textlen;
+      return TRUE;
+    }
+    start++;
   }
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_narrow(capture_file *cf, frame_data *fdata, void *criterion)
+static gboolean
+find_narrow(const guint8 *pd, guint32 buf_len, void *criterion,
+            guint32 *pos, guint32 *len)
 {
-  guint8       *pd;
   cbs_t        *info       = (cbs_t *)criterion;
   const guint8 *ascii_text = info->data;
   size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint32       i;
-  guint8        c_char;
-  size_t        c_match    = 0;
+  const guint8 *last;
+  const guint8 *start      = pd;
+  size_t        i;
 
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
+  if (textlen > buf_len)
+    return FALSE;
+  last = pd + buf_len - textlen;    /* Last possible start of a match */
 
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
-  i = 0;
-  while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = g_ascii_toupper(c_char);
-    if (c_char == ascii_text[c_match]) {
-      c_match += 1;
-      if (c_match == textlen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)textlen;
+  while ((start = cbs_find_anchor(info, start, last - start + 1)) != NULL) {
+    for (i = 1; i < textlen; i++) {
+      if (!cbs_char_matches(info, start[i], ascii_text[i]))
         break;
-      }
     }
-    else {
-      g_assert(i>=c_match);
-      i -= (guint32)c_match;
-      c_match = 0;
+    if (i == textlen) {
+      *pos = (guint32)(start - pd + textlen - 1);
+      *len = (guint32)textlen;
+      return TRUE;
     }
-    i += 1;
+    if (start == last)
+      break;
+    start++;
   }
-
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_wide(capture_file *cf, frame_data *fdata, void *criterion)
+/* Matches every other byte, as in little-endian UCS-2/UTF-16 text. */
+static gboolean
+find_wide(const guint8 *pd, guint32 buf_len, void *criterion,
+          guint32 *pos, guint32 *len)
 {
   cbs_t        *info       = (cbs_t *)criterion;
   const guint8 *ascii_text = info->data;
   size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint8       *pd;
-  guint32       i;
-  guint8        c_char;
-  size_t        c_match    = 0;
+  const guint8 *last;
+  const guint8 *start      = pd;
+  size_t        i;
 
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
+  if ((textlen - 1) * 2 >= buf_len)
+    return FALSE;
+  last = pd + buf_len - 1 - (textlen - 1) * 2;
 
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
-  i = 0;
-  while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = g_ascii_toupper(c_char);
-    if (c_char == ascii_text[c_match]) {
-      c_match += 1;
-      if (c_match == textlen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)textlen;
+  while ((start = cbs_find_anchor(info, start, last - start + 1)) != NULL) {
+    for (i = 1; i < textlen; i++) {
+      if (!cbs_char_matches(info, start[i * 2], ascii_text[i]))
         break;
-      }
-      i += 1;
     }
-    else {
-      g_assert(i>=(c_match*2));
-      i -= (guint32)c_match*2;
-      c_match = 0;
+    if (i == textlen) {
+      *pos = (guint32)(start - pd + (textlen - 1) * 2);
+      *len = (guint32)textlen;
+      return TRUE;
     }
-    i += 1;
+    if (start == last)
+      break;
+    start++;
   }
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_binary(capture_file *cf, frame_data *fdata, void *criterion)
+static gboolean
+find_binary(const guint8 *pd, guint32 buf_len, void *criterion,
+            guint32 *pos, guint32 *len)
 {
   cbs_t        *info        = (cbs_t *)criterion;
   const guint8 *binary_data = info->data;
   size_t        datalen     = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint8       *pd;
-  guint32       i;
-  size_t        c_match     = 0;
-
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
+  const guint8 *last;
+  const guint8 *start       = pd;
 
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
-  i = 0;
-  while (i < buf_len) {
-    if (pd[i] == binary_data[c_match]) {
-      c_match += 1;
-      if (c_match == datalen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)datalen;
-        break;
-      }
-    }
-    else {
-      g_assert(i>=c_match);
-      i -= (guint32)c_match;
-      c_match = 0;
+  if (datalen > buf_len)
+    return FALSE;
+  last = pd + buf_len - datalen;
+
+  while ((start = (const guint8 *)memchr(start, binary_data[0], last - start + 1)) != NULL) {
+    /* Check the second byte before comparing the rest, which rules out
+       most false candidates cheaply. */
+    if (datalen == 1 ||
+        (start[1] == binary_data[1] &&
+         memcmp(start + 2, binary_data + 2, datalen - 2) == 0)) {
+      *pos = (guint32)(start - pd + datalen - 1);
+      *len = (guint32)datalen;
+      return TRUE;
     }
-    i += 1;
+    if (start == last)
+      break;
+    start++;
   }
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_regex(capture_file *cf, frame_data *fdata, void *criterion _U_)
+static gboolean
+find_regex(const guint8 *pd, guint32 buf_len, void *criterion,
+           guint32 *pos, guint32 *len)
 {
-    match_result  result = MR_NOTMATCHED;
+    GRegex       *regex = (GRegex *)criterion;
     GMatchInfo   *match_info = NULL;
+    gboolean      result = FALSE;
 
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
-    }
-
-    if (g_regex_match_full(cf->regex, (const gchar *)ws_buffer_start_ptr(&cf->buf), fdata->cap_len,
+    if (g_regex_match_full(regex, (const gchar *)pd, buf_len,
                            0, (GRegexMatchFlags) 0, &match_info, NULL))
     {
         gint start_pos = 0, end_pos = 0;
         g_match_info_fetch_pos (match_info, 0, &start_pos, &end_pos);
-        cf->search_pos = end_pos - 1;
-        cf->search_len = end_pos - start_pos;
-        result = MR_MATCHED;
+        *pos = end_pos - 1;
+        *len = end_pos - start_pos;
+        result = TRUE;
     }
+    g_match_info_free(match_info);
     return result;
 }
 
+static match_result
+match_data(capture_file *cf, frame_data *fdata, void *criterion)
+{
+  match_data_t *md = (match_data_t *)criterion;
+  guint32       pos, len;
+
+  /* Load the frame's data. */
+  if (!cf_read_record(cf, fdata)) {
+    /* Attempt to get the packet failed. */
+    return MR_ERROR;
+  }
+
+  if (!(*md->func)(ws_buffer_start_ptr(&cf->buf), fdata->cap_len,
+                   md->criterion, &pos, &len))
+    return MR_NOTMATCHED;
+
+  cf->search_pos = pos; /* Save the position of the last character
+                           for highlighting the field. */
+  cf->search_len = len;
+  return MR_MATCHED;
+}
+
+/*
+ * Display filter searches.
+ *
+ * "Find next" is often used repeatedly with the same filter, and going
+ * back and forth dissects the same frames over and over.  Remember for
+ * the last filter searched for which frames have been dissected and
+ * whether they matched.  The results are thrown away when anything that
+ * can change the dissection of all the frames happens, including a
+ * change of the color filters, and forgotten for a single frame when
+ * it's marked, ignored, commented or edited.
+ */
+typedef struct _find_dfilter_cache {
+  gchar   *filter;      /* Expanded text of the filter */
+  guint    colors;      /* Generation of the color filters used */
+  guint32  count;       /* Number of frames the bitmaps cover */
+  guint8  *tested;      /* Frames dissected for the filter */
+  guint8  *matched;     /* Frames which matched it */
+} find_dfilter_cache_t;
+
+typedef struct {
+  dfilter_t      *sfcode;
+  epan_dissect_t  edt;
+  gboolean        use_cache;
+} match_dfilter_t;
+
+#define FIND_CACHE_BIT(bitmap, framenum) \
+  ((bitmap)[((framenum) - 1) >> 3] & (1 << (((framenum) - 1) & 7)))
+#define FIND_CACHE_SET_BIT(bitmap, framenum) \
+  ((bitmap)[((framenum) - 1) >> 3] |= (1 << (((framenum) - 1) & 7)))
+#define FIND_CACHE_CLEAR_BIT(bitmap, framenum) \
+  ((bitmap)[((framenum) - 1) >> 3] &= ~(1 << (((framenum) - 1) & 7)))
+
+static void
+find_dfilter_cache_clear(capture_file *cf)
+{
+  find_dfilter_cache_t *cache = cf->find_dfilter_cache;
+
+  if (cache == NULL)
+    return;
+
+  g_free(cache->filter);
+  g_free(cache->tested);
+  g_free(cache->matched);
+  g_free(cache);
+  cf->find_dfilter_cache = NULL;
+}
+
+static void
+find_dfilter_cache_forget(capture_file *cf, guint32 framenum)
+{
+  find_dfilter_cache_t *cache = cf->find_dfilter_cache;
+
+  if (cache && framenum >= 1 && framenum <= cache->count) {
+    FIND_CACHE_CLEAR_BIT(cache->tested, framenum);
+    FIND_CACHE_CLEAR_BIT(cache->matched, framenum);
+  }
+}
+
+/* Makes the cache hold results for this filter and all the frames. */
+static gboolean
+find_dfilter_cache_prepare(capture_file *cf, dfilter_t *sfcode)
+{
+  find_dfilter_cache_t *cache;
+  const gchar *filter = dfilter_text(sfcode);
+  guint32      old_bytes, new_bytes;
+
+  if (filter == NULL)
+    return FALSE;
+
+  cache = cf->find_dfilter_cache;
+  if (cache && (g_strcmp0(cache->filter, filter) != 0 ||
+                cache->colors != color_filters_generation())) {
+    find_dfilter_cache_clear(cf);
+    cache = NULL;
+  }
+  if (cache == NULL) {
+    cache = g_new0(find_dfilter_cache_t, 1);
+    cache->filter = g_strdup(filter);
+    cache->colors = color_filters_generation();
+    cf->find_dfilter_cache = cache;
+  }
+
+  if (cache->count < cf->count) {
+    /* More frames have been read since the last search. */
+    old_bytes = (cache->count + 7) / 8;
+    new_bytes = (cf->count + 7) / 8;
+    cache->tested = (guint8 *)g_realloc(cache->tested, new_bytes);
+    cache->matched = (guint8 *)g_realloc(cache->matched, new_bytes);
+    memset(cache->tested + old_bytes, 0, new_bytes - old_bytes);
+    memset(cache->matched + old_bytes, 0, new_bytes - old_bytes);
+    /* The last byte may have been partly used; its new bits are clear. */
+    cache->count = cf->count;
+  }
+  return TRUE;
+}
+
+static gboolean
+find_packet_dfilter(capture_file *cf, dfilter_t *sfcode, search_direction dir)
+{
+  match_dfilter_t criterion;
+  gboolean        result;
+
+  criterion.sfcode = sfcode;
+  criterion.use_cache = find_dfilter_cache_prepare(cf, sfcode);
+
+  /* Use a single epan_dissect_t for the whole search, resetting it
+     after each frame. */
+  epan_dissect_init(&criterion.edt, cf->epan, TRUE, FALSE);
+  result = find_packet(cf, match_dfilter, &criterion, dir);
+  epan_dissect_cleanup(&criterion.edt);
+  return result;
+}
+
 gboolean
 cf_find_packet_dfilter(capture_file *cf, dfilter_t *sfcode,
                        search_direction dir)
 {
-  return find_packet(cf, match_dfilter, sfcode, dir);
+  return find_packet_dfilter(cf, sfcode, dir);
 }
 
 gboolean
@@ -3402,7 +3964,7 @@ cf_find_packet_dfilter_string(capture_file *cf, const char *filter,
      */
     return FALSE;
   }
-  result = find_packet(cf, match_dfilter, sfcode, dir);
+  result = find_packet_dfilter(cf, sfcode, dir);
   dfilter_free(sfcode);
   return result;
 }
@@ -3410,9 +3972,15 @@ cf_find_packet_dfilter_string(capture_file *cf, const char *filter,
 static match_result
 match_dfilter(capture_file *cf, frame_data *fdata, void *criterion)
 {
-  dfilter_t      *sfcode = (dfilter_t *)criterion;
-  epan_dissect_t  edt;
-  match_result    result;
+  match_dfilter_t *mdf = (match_dfilter_t *)criterion;
+  find_dfilter_cache_t *cache = mdf->use_cache ? cf->find_dfilter_cache : NULL;
+  match_result     result;
+
+  if (cache && fdata->num <= cache->count &&
+      FIND_CACHE_BIT(cache->tested, fdata->num)) {
+    return FIND_CACHE_BIT(cache->matched, fdata->num) ?
+        MR_MATCHED : MR_NOTMATCHED;
+  }
 
   /* Load the frame's data. */
   if (!cf_read_record(cf, fdata)) {
@@ -3420,11 +3988,18 @@ match_dfilter(capture_file *cf, frame_data *fdata, void *criterion)
     return MR_ERROR;
   }
 
-  epan_dissect_init(&edt, cf->epan, TRUE, FALSE);
-  epan_dissect_prime_with_dfilter(&edt, sfcode);
-  epan_dissect_run(&edt, cf->cd_t, &cf->phdr, frame_tvbuff_new_buffer(fdata, &cf->buf), fdata, NULL);
-  result = dfilter_apply_edt(sfcode, &edt) ? MR_MATCHED : MR_NOTMATCHED;
-  epan_dissect_cleanup(&edt);
+  epan_dissect_prime_with_dfilter(&mdf->edt, mdf->sfcode);
+  epan_dissect_run(&mdf->edt, cf->cd_t, &cf->phdr, frame_tvbuff_new_buffer(fdata, &cf->buf), fdata, NULL);
+  result = dfilter_apply_edt(mdf->sfcode, &mdf->edt) ? MR_MATCHED : MR_NOTMATCHED;
+  epan_dissect_reset(&mdf->edt);
+
+  if (cache && fdata->num <= cache->count) {
+    FIND_CACHE_SET_BIT(cache->tested, fdata->num);
+    if (result == MR_MATCHED)
+      FIND_CACHE_SET_BIT(cache->matched, fdata->num);
+    else
+      FIND_CACHE_CLEAR_BIT(cache->matched, fdata->num);
+  }
   return result;
 }
 
@@ -3464,7 +4039,6 @@ find_packet(capture_file *cf,
   progdlg_t   *progbar = NULL;
   GTimer      *prog_timer = g_timer_new();
   int          count;
-  gboolean     found;
   float        progbar_val;
   GTimeVal     start_time;
   gchar        status_str[100];
@@ -3599,6 +4173,14 @@ find_packet(capture_file *cf,
     g_timer_destroy(prog_timer);
   }
 
+  return find_packet_select(cf, new_fd);
+}
+
+static gboolean
+find_packet_select(capture_file *cf, frame_data *new_fd)
+{
+  gboolean found;
+
   if (new_fd != NULL) {
     /* Find and select */
     cf->search_in_progress = TRUE;
@@ -3620,6 +4202,575 @@ find_packet(capture_file *cf,
     return FALSE;   /* failure */
 }
 
+/*
+ * Parallel search of the raw frame data.
+ *
+ * The frames are visited in the same order as find_packet() does (starting
+ * after the current frame, in the search direction, wrapping around if
+ * wanted and ending with the current frame) and that sequence is cut into
+ * chunks of FIND_CHUNK_FRAMES frames.  Worker thread n searches chunks n,
+ * n + n_workers, ... using its own random access wtap handle, so that the
+ * chunks closest to the current frame are searched first.  The main thread
+ * keeps the progress dialog going and stops the search as soon as a chunk
+ * has a match and all the chunks before it have been searched.
+ */
+#define FIND_PARALLEL_MIN_FRAMES 10000
+#define FIND_CHUNK_FRAMES        1024
+#define FIND_MAX_WORKERS         8
+
+typedef struct {
+  capture_file     *cf;
+  match_data_t     *md;
+  search_direction  dir;
+  guint32           start;          /* Current frame number */
+  guint32           total;          /* Number of frames to search */
+  gint              n_chunks;
+  gint              n_workers;
+  volatile gint     best_chunk;     /* First chunk with a match, or n_chunks */
+  volatile gint     frames_done;    /* For the progress bar */
+  volatile gint     stop;
+  volatile gint     error;
+  volatile gint    *chunk_done;
+  guint32          *match_framenum; /* Per chunk, 0 if no match */
+  guint32          *match_pos;
+  guint32          *match_len;
+} find_parallel_t;
+
+typedef struct {
+  find_parallel_t   *fp;
+  gint               first_chunk;
+  wtap              *wth;
+  struct wtap_pkthdr phdr;
+  Buffer             buf;
+} find_worker_t;
+
+/* Returns the number of the frame at position idx of the search order. */
+static guint32
+find_parallel_framenum(const find_parallel_t *fp, guint32 idx)
+{
+  guint32 count = fp->cf->count;
+  guint32 offset;
+
+  if (idx == fp->total - 1)
+    return fp->start;   /* The current frame is checked last */
+
+  offset = idx + 1;
+  if (fp->dir == SD_BACKWARD)
+    return fp->start > offset ? fp->start - offset : fp->start + count - offset;
+  else
+    return fp->start + offset <= count ? fp->start + offset : fp->start + offset - count;
+}
+
+static gboolean
+find_worker_read_record(find_worker_t *worker, const frame_data *fdata)
+{
+  int    err;
+  gchar *err_info = NULL;
+
+#ifdef WANT_PACKET_EDITOR
+  if (G_UNLIKELY(fdata->file_off == -1)) {
+    const modified_frame_data *frame = (const modified_frame_data *) g_tree_lookup(worker->fp->cf->edited_frames, GINT_TO_POINTER(fdata->num));
+
+    if (!frame)
+      return FALSE;
+
+    worker->phdr = frame->phdr;
+    ws_buffer_assure_space(&worker->buf, frame->phdr.caplen);
+    memcpy(ws_buffer_start_ptr(&worker->buf), frame->pd, frame->phdr.caplen);
+    return TRUE;
+  }
+#endif
+
+  if (!wtap_seek_read(worker->wth, fdata->file_off, &worker->phdr, &worker->buf, &err, &err_info)) {
+    /* The main thread falls back to a sequential search, which
+       reports the error. */
+    g_free(err_info);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static gpointer
+find_worker_thread(gpointer data)
+{
+  find_worker_t   *worker = (find_worker_t *)data;
+  find_parallel_t *fp = worker->fp;
+  frame_data      *fdata;
+  gint             chunk, best;
+  guint32          idx, end_idx, framenum, pos, len;
+
+  for (chunk = worker->first_chunk; chunk < fp->n_chunks; chunk += fp->n_workers) {
+    idx = (guint32)chunk * FIND_CHUNK_FRAMES;
+    end_idx = MIN(idx + FIND_CHUNK_FRAMES, fp->total);
+    for (; idx < end_idx; idx++) {
+      /* Give up when stopped or when an earlier chunk has a match. */
+      if (g_atomic_int_get(&fp->stop) || g_atomic_int_get(&fp->best_chunk) < chunk)
+        return NULL;
+
+      framenum = find_parallel_framenum(fp, idx);
+      fdata = frame_data_sequence_find(fp->cf->frames, framenum);
+
+      /* Is this packet in the display? */
+      if (!fdata->flags.passed_dfilter)
+        continue;
+
+      if (!find_worker_read_record(worker, fdata)) {
+        g_atomic_int_set(&fp->error, 1);
+        g_atomic_int_set(&fp->stop, 1);
+        return NULL;
+      }
+
+      if ((*fp->md->func)(ws_buffer_start_ptr(&worker->buf), fdata->cap_len,
+                          fp->md->criterion, &pos, &len)) {
+        fp->match_framenum[chunk] = framenum;
+        fp->match_pos[chunk] = pos;
+        fp->match_len[chunk] = len;
+        do {
+          best = g_atomic_int_get(&fp->best_chunk);
+        } while (chunk < best &&
+                 !g_atomic_int_compare_and_exchange(&fp->best_chunk, best, chunk));
+        break;
+      }
+    }
+    g_atomic_int_add(&fp->frames_done, (gint)(end_idx - (guint32)chunk * FIND_CHUNK_FRAMES));
+    g_atomic_int_set(&fp->chunk_done[chunk], 1);
+  }
+  return NULL;
+}
+
+/*
+ * Searches the raw data of the frames on several threads.  Returns FALSE
+ * if the search couldn't be done that way, in which case the caller does
+ * a sequential search; otherwise *new_fd is set to the matching frame,
+ * the current frame if the search was stopped, or NULL.
+ */
+static gboolean
+find_packet_parallel(capture_file *cf, match_data_t *md,
+                     search_direction dir, frame_data **new_fd)
+{
+  find_parallel_t fp;
+  find_worker_t  *workers;
+  GThread       **threads;
+  frame_data     *start_fd = cf->current_frame;
+  progdlg_t      *progbar = NULL;
+  GTimer         *prog_timer;
+  float           progbar_val = 0.0f;
+  GTimeVal        start_time;
+  gchar           status_str[100];
+  const char     *title;
+  gint            n_workers, i, first_pending, best = 0;
+  gboolean        searched = FALSE;
+  gboolean        wrapped;
+  int             err;
+  gchar          *err_info;
+
+  if (start_fd == NULL || cf->state != FILE_READ_DONE || cf->filename == NULL ||
+      cf->count < FIND_PARALLEL_MIN_FRAMES)
+    return FALSE;
+
+  /* The workers' handles start without the fast seek index of cf->wth;
+     in a compressed file every backward seek would then decompress it
+     again from the start. */
+  if (wtap_iscompressed(cf->wth))
+    return FALSE;
+
+#if GLIB_CHECK_VERSION(2,36,0)
+  n_workers = MIN((gint)g_get_num_processors(), FIND_MAX_WORKERS);
+#else
+  n_workers = 2;
+#endif
+  if (n_workers < 2)
+    return FALSE;
+
+  memset(&fp, 0, sizeof(fp));
+  fp.cf = cf;
+  fp.md = md;
+  fp.dir = dir;
+  fp.start = start_fd->num;
+  if (prefs.gui_find_wrap)
+    fp.total = cf->count;
+  else if (dir == SD_BACKWARD)
+    fp.total = fp.start;
+  else
+    fp.total = cf->count - fp.start + 1;
+  fp.n_chunks = (gint)((fp.total + FIND_CHUNK_FRAMES - 1) / FIND_CHUNK_FRAMES);
+  n_workers = MIN(n_workers, fp.n_chunks);
+  fp.n_workers = n_workers;
+  fp.best_chunk = fp.n_chunks;
+  fp.chunk_done = g_new0(gint, fp.n_chunks);
+  fp.match_framenum = g_new0(guint32, fp.n_chunks);
+  fp.match_pos = g_new0(guint32, fp.n_chunks);
+  fp.match_len = g_new0(guint32, fp.n_chunks);
+
+  /* Open a handle per worker; if we can't, search sequentially. */
+  workers = g_new0(find_worker_t, n_workers);
+  threads = g_new0(GThread *, n_workers);
+  for (i = 0; i < n_workers; i++) {
+    workers[i].fp = &fp;
+    workers[i].first_chunk = i;
+    workers[i].wth = wtap_open_offline(cf->filename, cf->open_type, &err, &err_info, TRUE);
+    if (workers[i].wth == NULL) {
+      g_free(err_info);
+      break;
+    }
+    wtap_phdr_init(&workers[i].phdr);
+    ws_buffer_init(&workers[i].buf, 1500);
+  }
+
+  if (i == n_workers) {
+    for (i = 0; i < n_workers; i++) {
+#if GLIB_CHECK_VERSION(2,31,0)
+      threads[i] = g_thread_new("Find packet", find_worker_thread, &workers[i]);
+#else
+      threads[i] = g_thread_create(find_worker_thread, &workers[i], TRUE, NULL);
+#endif
+    }
+
+    prog_timer = g_timer_new();
+    g_timer_start(prog_timer);
+    cf->stop_flag = FALSE;
+    g_get_current_time(&start_time);
+    title = cf->sfilter?cf->sfilter:"";
+    first_pending = 0;
+    for (;;) {
+      while (first_pending < fp.n_chunks && g_atomic_int_get(&fp.chunk_done[first_pending]))
+        first_pending++;
+      best = g_atomic_int_get(&fp.best_chunk);
+      if (first_pending > best || first_pending == fp.n_chunks || g_atomic_int_get(&fp.error))
+        break;
+
+      if (progbar == NULL)
+         progbar = delayed_create_progress_dlg(cf->window, "Searching", title,
+           FALSE, &cf->stop_flag, &start_time, progbar_val);
+
+      if (g_timer_elapsed(prog_timer, NULL) > PROGBAR_UPDATE_INTERVAL) {
+        progbar_val = (gfloat) g_atomic_int_get(&fp.frames_done) / fp.total;
+
+        g_snprintf(status_str, sizeof(status_str),
+                    "%4u of %u packets", (guint)g_atomic_int_get(&fp.frames_done), cf->count);
+        update_progress_dlg(progbar, progbar_val, status_str);
+
+        g_timer_start(prog_timer);
+      }
+
+      if (cf->stop_flag)
+        break;
+
+      g_usleep(1000);
+    }
+
+    /* Tell the workers to finish up and wait for them. */
+    g_atomic_int_set(&fp.stop, 1);
+    for (i = 0; i < n_workers; i++)
+      g_thread_join(threads[i]);
+
+    if (progbar != NULL)
+      destroy_progress_dlg(progbar);
+    g_timer_destroy(prog_timer);
+    searched = !fp.error;
+  }
+
+  if (searched) {
+    if (cf->stop_flag) {
+      /* The user decided to abort the search.  Go back to the
+         frame where we started. */
+      *new_fd = start_fd;
+    } else if (best < fp.n_chunks) {
+      *new_fd = frame_data_sequence_find(cf->frames, fp.match_framenum[best]);
+      cf->search_pos = fp.match_pos[best];
+      cf->search_len = fp.match_len[best];
+      wrapped = (dir == SD_BACKWARD) ? fp.match_framenum[best] > fp.start
+                                     : fp.match_framenum[best] < fp.start;
+      if (wrapped)
+        statusbar_push_temporary_msg(dir == SD_BACKWARD ?
+            "Search reached the beginning. Continuing at end." :
+            "Search reached the end. Continuing at beginning.");
+    } else {
+      *new_fd = NULL;
+      if (!prefs.gui_find_wrap)
+        statusbar_push_temporary_msg(dir == SD_BACKWARD ?
+            "Search reached the beginning." : "Search reached the end.");
+    }
+  }
+
+  for (i = 0; i < n_workers && workers[i].wth != NULL; i++) {
+    wtap_close(workers[i].wth);
+    wtap_phdr_cleanup(&workers[i].phdr);
+    ws_buffer_free(&workers[i].buf);
+  }
+  g_free(workers);
+  g_free(threads);
+  g_free((gpointer)fp.chunk_done);
+  g_free(fp.match_framenum);
+  g_free(fp.match_pos);
+  g_free(fp.match_len);
+
+  return searched;
+}
+
+/*
+ * Background indexing of the frame data.
+ *
+ * Once a file has been read, and if the "gui.find_index" preference is
+ * set, a thread reads all its frames again through its own wtap handle
+ * and builds a trigram index of their data (see ui/search_index.h).  When
+ * it's done, byte and narrow string searches only look at the frames the
+ * index returns as candidates.
+ */
+typedef struct _cf_search_index {
+  capture_file   *cf;
+  search_index_t *index;
+  GThread        *thread;
+  wtap           *wth;
+  guint32         count;    /* Number of frames to index */
+  volatile gint   stop;
+  volatile gint   ready;    /* Set once all the frames are indexed */
+} cf_search_index_t;
+
+/* Searching the candidates beats a full search only if there are few. */
+#define FIND_INDEX_MAX_CANDIDATES(count) ((count) / 8)
+
+/* Give up on indexing files whose index would take more memory than this. */
+#define FIND_INDEX_MAX_SIZE ((gsize)256 * 1024 * 1024)
+
+static gpointer
+cf_search_index_thread(gpointer data)
+{
+  cf_search_index_t *csi = (cf_search_index_t *)data;
+  struct wtap_pkthdr phdr;
+  Buffer             buf;
+  frame_data        *fdata;
+  guint32            framenum;
+  int                err;
+  gchar             *err_info = NULL;
+
+  wtap_phdr_init(&phdr);
+  ws_buffer_init(&buf, 1500);
+  for (framenum = 1; framenum <= csi->count; framenum++) {
+    if (g_atomic_int_get(&csi->stop))
+      break;
+    fdata = frame_data_sequence_find(csi->cf->frames, framenum);
+    if (!wtap_seek_read(csi->wth, fdata->file_off, &phdr, &buf, &err, &err_info)) {
+      /* Leave the index unfinished; it will not be used. */
+      g_free(err_info);
+      break;
+    }
+    search_index_add_frame(csi->index, framenum, ws_buffer_start_ptr(&buf), fdata->cap_len);
+    if (search_index_size(csi->index) > FIND_INDEX_MAX_SIZE) {
+      /* Too big to be worth keeping; leave it unfinished. */
+      break;
+    }
+  }
+  wtap_phdr_cleanup(&phdr);
+  ws_buffer_free(&buf);
+
+  wtap_close(csi->wth);
+  csi->wth = NULL;
+  if (framenum > csi->count) {
+    g_atomic_int_set(&csi->ready, 1);
+  } else {
+    /* An unfinished index is never used; don't hold on to it. */
+    search_index_free(csi->index);
+    csi->index = NULL;
+  }
+  return NULL;
+}
+
+static void
+cf_search_index_start(capture_file *cf)
+{
+  cf_search_index_t *csi;
+  int                err;
+  gchar             *err_info = NULL;
+
+  cf_search_index_discard(cf);
+  if (cf->filename == NULL || cf->count == 0)
+    return;
+
+  csi = g_new0(cf_search_index_t, 1);
+  csi->cf = cf;
+  csi->count = cf->count;
+  csi->wth = wtap_open_offline(cf->filename, cf->open_type, &err, &err_info, TRUE);
+  if (csi->wth == NULL) {
+    /* Searches will just be done without the index. */
+    g_free(err_info);
+    g_free(csi);
+    return;
+  }
+  csi->index = search_index_new();
+#if GLIB_CHECK_VERSION(2,31,0)
+  csi->thread = g_thread_new("Search index", cf_search_index_thread, csi);
+#else
+  csi->thread = g_thread_create(cf_search_index_thread, csi, TRUE, NULL);
+#endif
+  cf->search_index = csi;
+}
+
+static void
+cf_search_index_discard(capture_file *cf)
+{
+  cf_search_index_t *csi = cf->search_index;
+
+  if (csi == NULL)
+    return;
+
+  g_atomic_int_set(&csi->stop, 1);
+  g_thread_join(csi->thread);
+  search_index_free(csi->index);
+  g_free(csi);
+  cf->search_index = NULL;
+}
+
+/*
+ * Searches the frames the index says may contain index_key, in the same
+ * order as find_packet().  Returns FALSE if the index can't be used, in
+ * which case the caller does a full search; otherwise *new_fd is set to
+ * the matching frame, the current frame on error, or NULL.
+ */
+static gboolean
+find_packet_indexed(capture_file *cf, match_data_t *md,
+                    const guint8 *index_key, size_t index_key_len,
+                    search_direction dir, frame_data **new_fd)
+{
+  cf_search_index_t *csi = cf->search_index;
+  frame_data *start_fd = cf->current_frame;
+  frame_data *fdata;
+  GArray     *candidates;
+  guint32    *frames;
+  guint       n, lo, hi, mid, steps, i;
+  gint        j;
+  gboolean    has_start;
+  match_result result;
+  progdlg_t  *progbar = NULL;
+  GTimer     *prog_timer;
+  float       progbar_val = 0.0f;
+  GTimeVal    start_time;
+  gchar       status_str[100];
+  const char *title;
+
+  if (csi == NULL || !g_atomic_int_get(&csi->ready) || start_fd == NULL)
+    return FALSE;
+
+  candidates = search_index_candidates(csi->index, index_key, index_key_len);
+  if (candidates == NULL)
+    return FALSE;
+  if (candidates->len > FIND_INDEX_MAX_CANDIDATES(cf->count)) {
+    g_array_free(candidates, TRUE);
+    return FALSE;
+  }
+
+  /* Find where the current frame is (or would be) in the list. */
+  frames = (guint32 *)(void *)candidates->data;
+  n = candidates->len;
+  lo = 0;
+  hi = n;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (frames[mid] < start_fd->num)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  has_start = lo < n && frames[lo] == start_fd->num;
+
+  *new_fd = NULL;
+  steps = has_start ? n - 1 : n;
+
+  /* There may still be many candidates to read and match; show our
+     progress and let the search be stopped, as find_packet() does. */
+  prog_timer = g_timer_new();
+  cf->stop_flag = FALSE;
+  g_get_current_time(&start_time);
+  title = cf->sfilter ? cf->sfilter : "";
+
+  j = (dir == SD_BACKWARD) ? (gint)lo - 1 : (has_start ? (gint)lo + 1 : (gint)lo);
+  for (i = 0; i <= steps; i++, j += (dir == SD_BACKWARD) ? -1 : 1) {
+    if (progbar == NULL)
+      progbar = delayed_create_progress_dlg(cf->window, "Searching", title,
+        FALSE, &cf->stop_flag, &start_time, progbar_val);
+
+    if (g_timer_elapsed(prog_timer, NULL) > PROGBAR_UPDATE_INTERVAL) {
+      progbar_val = (gfloat) i / (steps + 1);
+
+      g_snprintf(status_str, sizeof(status_str),
+                 "%4u of %u candidate packets", i, steps + 1);
+      update_progress_dlg(progbar, progbar_val, status_str);
+
+      g_timer_start(prog_timer);
+    }
+
+    if (cf->stop_flag) {
+      /* The user stopped the search; stay on the current frame. */
+      *new_fd = start_fd;
+      break;
+    }
+
+    if (i == steps) {
+      /* The current frame is checked last. */
+      if (!has_start)
+        break;
+      fdata = start_fd;
+    } else {
+      if (j < 0 || j >= (gint)n) {
+        if (!prefs.gui_find_wrap) {
+          statusbar_push_temporary_msg(dir == SD_BACKWARD ?
+              "Search reached the beginning." : "Search reached the end.");
+          /* Only the current frame is left to look at. */
+          i = steps - 1;
+          continue;
+        }
+        statusbar_push_temporary_msg(dir == SD_BACKWARD ?
+            "Search reached the beginning. Continuing at end." :
+            "Search reached the end. Continuing at beginning.");
+        j = (j < 0) ? (gint)n - 1 : 0;
+      }
+      fdata = frame_data_sequence_find(cf->frames, frames[j]);
+    }
+
+    /* Is this packet in the display? */
+    if (!fdata->flags.passed_dfilter)
+      continue;
+
+    result = match_data(cf, fdata, md);
+    if (result == MR_ERROR) {
+      *new_fd = start_fd;
+      break;
+    } else if (result == MR_MATCHED) {
+      *new_fd = fdata;
+      break;
+    }
+  }
+
+  if (progbar != NULL)
+    destroy_progress_dlg(progbar);
+  g_timer_destroy(prog_timer);
+
+  g_array_free(candidates, TRUE);
+  return TRUE;
+}
+
+static gboolean
+find_packet_data(capture_file *cf,
+                 gboolean (*find_function)(const guint8 *, guint32, void *, guint32 *, guint32 *),
+                 void *criterion, const guint8 *index_key, size_t index_key_len,
+                 search_direction dir)
+{
+  match_data_t md;
+  frame_data  *new_fd;
+
+  md.func = find_function;
+  md.criterion = criterion;
+
+  if (index_key != NULL &&
+      find_packet_indexed(cf, &md, index_key, index_key_len, dir, &new_fd))
+    return find_packet_select(cf, new_fd);
+
+  if (find_packet_parallel(cf, &md, dir, &new_fd))
+    return find_packet_select(cf, new_fd);
+
+  return find_packet(cf, match_data, &md, dir);
+}
+
 gboolean
 cf_goto_frame(capture_file *cf, guint fnumber)
 {
@@ -3759,8 +4910,10 @@ cf_mark_frame(capture_file *cf, frame_data *frame)
 {
   if (! frame->flags.marked) {
     frame->flags.marked = TRUE;
+    find_dfilter_cache_forget(cf, frame->num);
     if (cf->count > cf->marked_count)
       cf->marked_count++;
+    tally_marked_frame(&cf->frame_tally, frame);
   }
 }
 
@@ -3772,8 +4925,23 @@ cf_unmark_frame(capture_file *cf, frame_data *frame)
 {
   if (frame->flags.marked) {
     frame->flags.marked = FALSE;
+    find_dfilter_cache_forget(cf, frame->num);
     if (cf->marked_count > 0)
       cf->marked_count--;
+    cf->frame_tally.marked_bytes -= frame->pkt_len;
+    if (cf->frame_tally.valid && frame->flags.has_ts) {
+      double cur_time = nstime_to_sec(&frame->abs_ts);
+
+      if (--cf->frame_tally.marked_count_ts == 0) {
+        cf->frame_tally.marked_start = 0;
+        cf->frame_tally.marked_stop = 0;
+      } else if (cur_time == cf->frame_tally.marked_start ||
+                 cur_time == cf->frame_tally.marked_stop) {
+        /* We can't tell the new first or last marked time without
+           looking at the other frames. */
+        cf->frame_tally.valid = FALSE;
+      }
+    }
   }
 }
 
@@ -3785,6 +4953,7 @@ cf_ignore_frame(capture_file *cf, frame_data *frame)
 {
   if (! frame->flags.ignored) {
     frame->flags.ignored = TRUE;
+    find_dfilter_cache_forget(cf, frame->num);
     if (cf->count > cf->ignored_count)
       cf->ignored_count++;
   }
@@ -3798,11 +4967,39 @@ cf_unignore_frame(capture_file *cf, frame_data *frame)
 {
   if (frame->flags.ignored) {
     frame->flags.ignored = FALSE;
+    find_dfilter_cache_forget(cf, frame->num);
     if (cf->ignored_count > 0)
       cf->ignored_count--;
   }
 }
 
+/*
+ * Get the running totals of the frames, recomputing them if needed.
+ */
+const frame_tally_t *
+cf_get_frame_tally(capture_file *cf)
+{
+  frame_tally_t *ft = &cf->frame_tally;
+  frame_data    *fdata;
+  guint32        framenum;
+
+  if (ft->valid)
+    return ft;
+
+  memset(ft, 0, sizeof *ft);
+  for (framenum = 1; framenum <= cf->count; framenum++) {
+    fdata = frame_data_sequence_find(cf->frames, framenum);
+    tally_frame(ft, fdata);
+    if (fdata->flags.passed_dfilter)
+      tally_filtered_frame(ft, fdata);
+    if (fdata->flags.marked)
+      tally_marked_frame(ft, fdata);
+  }
+  ft->valid = TRUE;
+
+  return ft;
+}
+
 /*
  * Read the section comment.
  */
@@ -3931,6 +5128,7 @@ cf_set_user_packet_comment(capture_file *cf, frame_data *fd, const gchar *new_co
     cf->packet_comment_count++;
 
   fd->flags.has_user_comment = TRUE;
+  find_dfilter_cache_forget(cf, fd->num);
 
   if (!cf->frames_user_comments)
     cf->frames_user_comments = g_tree_new_full(frame_cmp, NULL, NULL, g_free);
@@ -4008,6 +5206,10 @@ cf_set_frame_edited(capture_file *cf, frame_data *fd,
 {
   modified_frame_data *mfd = (modified_frame_data *)g_malloc(sizeof(modified_frame_data));
 
+  /* The index doesn't know about the new data. */
+  cf_search_index_discard(cf);
+  find_dfilter_cache_forget(cf, fd->num);
+
   mfd->phdr = *phdr;
   mfd->pd = (char *)pd;
 
@@ -4391,6 +5593,14 @@ cf_save_records(capture_file *cf, const char *fname, guint save_format,
 
   cf_callback_invoke(cf_cb_file_save_started, (gpointer)fname);
 
+  /* The records will be read from the new file from now on. */
+  record_cache_free(cf);
+
+  /* The file may be moved or replaced; don't keep an unfinished index
+     reading it. */
+  if (cf->search_index != NULL && !g_atomic_int_get(&cf->search_index->ready))
+    cf_search_index_discard(cf);
+
   addr_lists = get_addrinfo_list();
 
   if (save_format == cf->cd_t && compressed == cf->iscompressed
@@ -172,6 +172,23 @@ cf_read_status_t cf_read(capture_file *cf, gboolean from_save);
 gboolean cf_read_record_r(capture_file *cf, const frame_data *fdata,
                           struct wtap_pkthdr *phdr, Buffer *buf);
 
+/** Statistics of the cache used by cf_read_record_r() */
+typedef struct {
+    guint64 hits;           /**< Records found in the cache */
+    guint64 misses;         /**< Records read from the file */
+    guint64 read_ahead;     /**< Records read ahead of being asked for */
+    guint   entries;        /**< Records currently in the cache */
+    gsize   bytes;          /**< Memory used by those records */
+} cf_record_cache_stats_t;
+
+/**
+ * Get the statistics of the cache of records read by cf_read_record_r().
+ *
+ * @param cf the capture file
+ * @param stats filled in with the statistics since the file was opened
+ */
+void cf_get_record_cache_stats(capture_file *cf, cf_record_cache_stats_t *stats);
+
 /**
  * Read the metadata and raw data for a record into a
  * capture_file structure's phdr and buf members.
@@ -193,6 +210,16 @@ gboolean cf_read_record(capture_file *cf, frame_data *fdata);
  */
 cf_read_status_t cf_continue_tail(capture_file *cf, volatile int to_read, int *err);
 
+/**
+ * Get the number of records cf_continue_tail() left unread to keep the
+ * GUI responsive. While there are any, the GUI should call it again soon
+ * rather than wait for the capture child to report new packets.
+ *
+ * @param cf the capture file
+ * @return the number of records still to be read
+ */
+int cf_tail_backlog(capture_file *cf);
+
 /**
  * Fake reading packets from the "end" of a capture file.
  *
@@ -410,6 +437,16 @@ void cf_redissect_packets(capture_file *cf);
  */
 cf_read_status_t cf_retap_packets(capture_file *cf);
 
+/**
+ * Rescan all packets and run the taps, only for the tap listeners marked
+ * as needing a retap (see mark_tap_listener_for_retap()). The other tap
+ * listeners keep their data.
+ *
+ * @param cf the capture file
+ * @return one of cf_read_status_t
+ */
+cf_read_status_t cf_retap_marked_packets(capture_file *cf);
+
 /**
  * Adjust timestamp precision if auto is selected.
  *
@@ -657,6 +694,16 @@ void cf_ignore_frame(capture_file *cf, frame_data *frame);
  */
 void cf_unignore_frame(capture_file *cf, frame_data *frame);
 
+/**
+ * Get the running totals of the frames used for the summary, recomputing
+ * them first if something (such as an interrupted filtering) left them out
+ * of date.
+ *
+ * @param cf the capture file
+ * @return the totals
+ */
+const frame_tally_t *cf_get_frame_tally(capture_file *cf);
+
 /**
  * Merge two or more capture files into a temporary file.
  * @todo is this the right place for this function? It doesn't have to do a lot with capture_file.
@@ -91,10 +91,12 @@ usage(gboolean is_error)
 		output = stderr;
 	}
 
-	fprintf(output, "Usage: randpkt [-b maxbytes] [-c count] [-t type] [-r] filename\n");
+	fprintf(output, "Usage: randpkt [-b maxbytes] [-c count] [-t type] [-r] [-s seed] [-j threads] filename\n");
 	fprintf(output, "Default max bytes (per packet) is 5000\n");
 	fprintf(output, "Default count is 1000.\n");
 	fprintf(output, "-r: random packet type selection\n");
+	fprintf(output, "-s: seed of the random number generator, to reproduce a capture file\n");
+	fprintf(output, "-j: number of threads generating packets (default 1, not with -r)\n");
 	fprintf(output, "\n");
 	fprintf(output, "Types:\n");
 
@@ -108,7 +110,8 @@ usage(gboolean is_error)
 	g_strfreev(abbrev_list);
 	g_strfreev(longname_list);
 
-	fprintf(output, "\nIf type is not specified, a random packet will be chosen\n\n");
+	fprintf(output, "\nIf type is not specified, a random packet will be chosen\n");
+	fprintf(output, "The -flow types produce well-formed sessions rather than random bytes\n\n");
 }
 
 int
@@ -123,6 +126,9 @@ main(int argc, char **argv)
 	randpkt_example		*example;
 	guint8*			type = NULL;
 	int 			allrandom = FALSE;
+	gboolean		seeded = FALSE;
+	guint32			seed = 0;
+	int			n_threads = 1;
 	wtap_dumper		*savedump;
 	int 			 ret = EXIT_SUCCESS;
 	static const struct option long_options[] = {
@@ -147,6 +153,10 @@ main(int argc, char **argv)
 		g_free(init_progfile_dir_error);
 	}
 
+#if !GLIB_CHECK_VERSION(2,31,0)
+	g_thread_init(NULL);
+#endif
+
 	wtap_init();
 
 	cmdarg_err_init(failure_warning_message, failure_message_cont);
@@ -174,7 +184,7 @@ main(int argc, char **argv)
 	register_all_wiretap_modules();
 #endif
 
-	while ((opt = getopt_long(argc, argv, "b:c:ht:r", long_options, NULL)) != -1) {
+	while ((opt = getopt_long(argc, argv, "b:c:hj:rs:t:", long_options, NULL)) != -1) {
 		switch (opt) {
 			case 'b':	/* max bytes */
 				produce_max_bytes = get_positive_int(optarg, "max bytes");
@@ -189,6 +199,15 @@ main(int argc, char **argv)
 				produce_count = get_positive_int(optarg, "count");
 				break;
 
+			case 'j':	/* number of generator threads */
+				n_threads = get_positive_int(optarg, "number of threads");
+				break;
+
+			case 's':	/* seed */
+				seed = get_guint32(optarg, "seed");
+				seeded = TRUE;
+				break;
+
 			case 't':	/* type of packet to produce */
 				type = g_strdup(optarg);
 				break;
@@ -220,6 +239,9 @@ main(int argc, char **argv)
 		goto clean_exit;
 	}
 
+	if (seeded)
+		randpkt_seed(seed);
+
 	if (!allrandom) {
 		produce_type = randpkt_parse_type(type);
 		g_free(type);
@@ -233,7 +255,7 @@ main(int argc, char **argv)
 		ret = randpkt_example_init(example, produce_filename, produce_max_bytes);
 		if (ret != EXIT_SUCCESS)
 			goto clean_exit;
-		randpkt_loop(example, produce_count);
+		randpkt_loop_threads(example, produce_count, n_threads);
 	} else {
 		if (type) {
 			fprintf(stderr, "Can't set type in random mode\n");
@@ -241,6 +263,12 @@ main(int argc, char **argv)
 			goto clean_exit;
 		}
 
+		if (n_threads > 1) {
+			fprintf(stderr, "Can't use several threads in random mode\n");
+			ret = INVALID_OPTION;
+			goto clean_exit;
+		}
+
 		produce_type = randpkt_parse_type(NULL);
 		example = randpkt_find_example(produce_type);
 		if (!example) {
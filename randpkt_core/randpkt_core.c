@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <wsutil/file_util.h>
+#include <wsutil/pint.h>
 #include <wiretap/wtap_opttypes.h>
 
 #include "ui/failure_message.h"
@@ -47,9 +48,11 @@ enum {
 	PKT_BGP,
 	PKT_BVLC,
 	PKT_DNS,
+	PKT_DNS_FLOW,
 	PKT_ETHERNET,
 	PKT_FDDI,
 	PKT_GIOP,
+	PKT_HTTP_FLOW,
 	PKT_ICMP,
 	PKT_IEEE802154,
 	PKT_IP,
@@ -61,6 +64,7 @@ enum {
 	PKT_NCP2222,
 	PKT_SCTP,
 	PKT_SYSLOG,
+	PKT_SYSLOG_FLOW,
 	PKT_TCP,
 	PKT_TDS,
 	PKT_TR,
@@ -357,6 +361,42 @@ guint8 pkt_megaco[] = {
 	0x00, 0x00, 0x00, 0x07,
 };
 
+/*
+ * The "-flow" examples don't produce random bytes but whole, well-formed
+ * sessions over Ethernet and IPv4: a TCP handshake, the talk of the
+ * protocol with its payloads segmented and acknowledged, and a teardown,
+ * or UDP datagrams.  Each flow has its own addresses and ports.  They're
+ * meant for measuring how fast the dissectors run on plausible traffic.
+ */
+#define FLOW_ETH_LEN	14
+#define FLOW_IP_LEN	20
+#define FLOW_TCP_LEN	20
+#define FLOW_UDP_LEN	8
+
+#define FLOW_TCP_HEADERS_LEN	(FLOW_ETH_LEN + FLOW_IP_LEN + FLOW_TCP_LEN)
+#define FLOW_UDP_HEADERS_LEN	(FLOW_ETH_LEN + FLOW_IP_LEN + FLOW_UDP_LEN)
+
+#define FLOW_IP_PROTO_TCP	6
+#define FLOW_IP_PROTO_UDP	17
+
+typedef struct _randpkt_flow randpkt_flow;
+
+struct _randpkt_flow_type {
+	guint8		ip_proto;
+	guint16		port;		/* server port */
+	/* Adds the packets after the handshake, returning FALSE once
+	 * no more fit in the chunk */
+	gboolean	(*talk)(randpkt_flow* flow);
+};
+
+static gboolean flow_talk_dns(randpkt_flow* flow);
+static gboolean flow_talk_http(randpkt_flow* flow);
+static gboolean flow_talk_syslog(randpkt_flow* flow);
+
+static const randpkt_flow_type flow_dns = { FLOW_IP_PROTO_UDP, 53, flow_talk_dns };
+static const randpkt_flow_type flow_http = { FLOW_IP_PROTO_TCP, 80, flow_talk_http };
+static const randpkt_flow_type flow_syslog = { FLOW_IP_PROTO_UDP, 514, flow_talk_syslog };
+
 /* This little data table drives the whole program */
 static randpkt_example examples[] = {
 	{ "arp", "Address Resolution Protocol",
@@ -365,6 +405,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "bgp", "Border Gateway Protocol",
@@ -373,6 +414,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "bvlc", "BACnet Virtual Link Control",
@@ -381,6 +423,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "dns", "Domain Name Service",
@@ -389,6 +432,16 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
+	},
+
+	{ "dns-flow", "Domain Name Service queries and responses",
+		PKT_DNS_FLOW,	WTAP_ENCAP_ETHERNET,
+		NULL,		FLOW_UDP_HEADERS_LEN,
+		NULL,		0,
+		NULL,		NULL,
+		1000,
+		&flow_dns,
 	},
 
 	{ "eth", "Ethernet",
@@ -397,6 +450,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "fddi", "Fiber Distributed Data Interface",
@@ -405,6 +459,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "giop", "General Inter-ORB Protocol",
@@ -413,6 +468,16 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
+	},
+
+	{ "http-flow", "Hypertext Transfer Protocol sessions over TCP",
+		PKT_HTTP_FLOW,	WTAP_ENCAP_ETHERNET,
+		NULL,		FLOW_TCP_HEADERS_LEN,
+		NULL,		0,
+		NULL,		NULL,
+		1000,
+		&flow_http,
 	},
 
 	{ "icmp", "Internet Control Message Protocol",
@@ -421,6 +486,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "ieee802.15.4", "IEEE 802.15.4",
@@ -429,6 +495,7 @@ static randpkt_example examples[] = {
 		NULL,           0,
 		NULL,           NULL,
 		127,
+		NULL,
 	},
 
 	{ "ip", "Internet Protocol",
@@ -437,6 +504,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "ipv6", "Internet Protocol Version 6",
@@ -445,6 +513,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "llc", "Logical Link Control",
@@ -453,6 +522,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "m2m", "WiMAX M2M Encapsulation Protocol",
@@ -461,6 +531,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "megaco", "MEGACO",
@@ -469,6 +540,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "nbns", "NetBIOS-over-TCP Name Service",
@@ -477,6 +549,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "ncp2222", "NetWare Core Protocol",
@@ -485,6 +558,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "sctp", "Stream Control Transmission Protocol",
@@ -493,6 +567,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "syslog", "Syslog message",
@@ -501,6 +576,16 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
+	},
+
+	{ "syslog-flow", "Syslog messages from a host",
+		PKT_SYSLOG_FLOW, WTAP_ENCAP_ETHERNET,
+		NULL,		FLOW_UDP_HEADERS_LEN,
+		NULL,		0,
+		NULL,		NULL,
+		1000,
+		&flow_syslog,
 	},
 
 	{ "tds", "TDS NetLib",
@@ -509,6 +594,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "tcp", "Transmission Control Protocol",
@@ -517,6 +603,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "tr",	 "Token-Ring",
@@ -525,6 +612,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "udp", "User Datagram Protocol",
@@ -533,6 +621,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 	{ "usb-linux", "Universal Serial Bus with Linux specific header",
@@ -541,6 +630,7 @@ static randpkt_example examples[] = {
 		NULL,		0,
 		NULL,		NULL,
 		1000,
+		NULL,
 	},
 
 };
@@ -567,38 +657,483 @@ randpkt_example* randpkt_find_example(int type)
 	return NULL;
 }
 
-void randpkt_loop(randpkt_example* example, guint64 produce_count)
+/* Packets are generated in chunks, each with its own random number
+ * generator seeded from pkt_rand, so that the chunks can be generated
+ * in parallel and the output only depends on the seed of pkt_rand, not
+ * on the number of threads. */
+#define CHUNK_PACKETS	256
+
+typedef struct {
+	randpkt_example*	example;
+	guint32			seed;
+	guint64			first;		/* number of the first packet */
+	guint			count;
+	guint			stride;		/* room for each packet in data */
+	struct wtap_pkthdr*	pkthdrs;
+	guint8*			data;
+	gboolean		done;		/* generated, ready to be written */
+} randpkt_chunk;
+
+#define FLOW_MSS	1460
+
+#define FLOW_TCP_FIN	0x01
+#define FLOW_TCP_SYN	0x02
+#define FLOW_TCP_PSH	0x08
+#define FLOW_TCP_ACK	0x10
+
+#define FLOW_CLIENT	0
+#define FLOW_SERVER	1
+
+struct _randpkt_flow {
+	randpkt_chunk*	chunk;
+	GRand*		rand;
+	guint		n;		/* packets of the chunk done so far */
+	guint64		clock;		/* time of the last packet, in microseconds */
+	guint		mss;		/* largest payload of a packet */
+	guint8		ip_proto;
+	/* Indexed by FLOW_CLIENT or FLOW_SERVER */
+	guint8		mac[2][6];
+	guint32		addr[2];
+	guint16		port[2];
+	guint8		ttl[2];
+	guint16		ip_id[2];
+	guint32		seq[2];		/* next sequence number */
+};
+
+static guint32 flow_sum(guint32 sum, const guint8* p, guint len)
+{
+	guint i;
+
+	for (i = 0; i + 1 < len; i += 2)
+		sum += (p[i] << 8) | p[i + 1];
+	if (i < len)
+		sum += p[i] << 8;
+	return sum;
+}
+
+static guint16 flow_cksum(guint32 sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (guint16)~sum;
+}
+
+/* Add a packet from one side of the flow to the other.  Returns FALSE if
+ * the chunk is already full. */
+static gboolean flow_packet(randpkt_flow* flow, int from, guint8 tcp_flags,
+    const guint8* payload, guint len)
+{
+	randpkt_chunk* chunk = flow->chunk;
+	struct wtap_pkthdr* pkthdr;
+	guint8* buffer;
+	guint8* ip;
+	guint8* l4;
+	guint l4_len;
+	guint16 cksum;
+	guint32 sum;
+	int to = !from;
+
+	if (flow->n == chunk->count)
+		return FALSE;
+
+	pkthdr = &chunk->pkthdrs[flow->n];
+	buffer = chunk->data + (gsize)flow->n * chunk->stride;
+	flow->n++;
+
+	l4_len = (flow->ip_proto == FLOW_IP_PROTO_TCP ? FLOW_TCP_LEN : FLOW_UDP_LEN) + len;
+
+	flow->clock += g_rand_int_range(flow->rand, 10, 50000);
+
+	memset(pkthdr, 0, sizeof *pkthdr);
+	pkthdr->rec_type = REC_TYPE_PACKET;
+	pkthdr->presence_flags = WTAP_HAS_TS;
+	pkthdr->pkt_encap = chunk->example->sample_wtap_encap;
+	pkthdr->ts.secs = (time_t)(flow->clock / 1000000);
+	pkthdr->ts.nsecs = (int)(flow->clock % 1000000) * 1000;
+	pkthdr->caplen = FLOW_ETH_LEN + FLOW_IP_LEN + l4_len;
+	pkthdr->len = pkthdr->caplen;
+
+	memcpy(buffer, flow->mac[to], 6);
+	memcpy(buffer + 6, flow->mac[from], 6);
+	phton16(buffer + 12, 0x0800);
+
+	/* IPv4, don't fragment */
+	ip = buffer + FLOW_ETH_LEN;
+	ip[0] = 0x45;
+	ip[1] = 0;
+	phton16(ip + 2, FLOW_IP_LEN + l4_len);
+	phton16(ip + 4, flow->ip_id[from]);
+	flow->ip_id[from]++;
+	phton16(ip + 6, 0x4000);
+	ip[8] = flow->ttl[from];
+	ip[9] = flow->ip_proto;
+	phton16(ip + 10, 0);
+	phton32(ip + 12, flow->addr[from]);
+	phton32(ip + 16, flow->addr[to]);
+	cksum = flow_cksum(flow_sum(0, ip, FLOW_IP_LEN));
+	phton16(ip + 10, cksum);
+
+	l4 = ip + FLOW_IP_LEN;
+	phton16(l4, flow->port[from]);
+	phton16(l4 + 2, flow->port[to]);
+	if (flow->ip_proto == FLOW_IP_PROTO_TCP) {
+		phton32(l4 + 4, flow->seq[from]);
+		if (tcp_flags & FLOW_TCP_ACK) {
+			phton32(l4 + 8, flow->seq[to]);
+		} else {
+			phton32(l4 + 8, 0);
+		}
+		l4[12] = (FLOW_TCP_LEN / 4) << 4;
+		l4[13] = tcp_flags;
+		phton16(l4 + 14, 65535);
+		phton16(l4 + 16, 0);
+		phton16(l4 + 18, 0);
+		if (len > 0)
+			memcpy(l4 + FLOW_TCP_LEN, payload, len);
+		flow->seq[from] += len;
+		if (tcp_flags & (FLOW_TCP_SYN | FLOW_TCP_FIN))
+			flow->seq[from]++;
+	} else {
+		phton16(l4 + 4, l4_len);
+		phton16(l4 + 6, 0);
+		if (len > 0)
+			memcpy(l4 + FLOW_UDP_LEN, payload, len);
+	}
+
+	/* The checksum covers a pseudo-header with the addresses */
+	sum = flow_sum(0, ip + 12, 8);
+	sum += flow->ip_proto + l4_len;
+	cksum = flow_cksum(flow_sum(sum, l4, l4_len));
+	if (flow->ip_proto == FLOW_IP_PROTO_TCP) {
+		phton16(l4 + 16, cksum);
+	} else {
+		/* A UDP checksum of 0 means there is none */
+		if (cksum == 0)
+			cksum = 0xffff;
+		phton16(l4 + 6, cksum);
+	}
+
+	return TRUE;
+}
+
+/* Send data from one side to the other, in as many TCP segments as
+ * needed, or in a single (possibly truncated) UDP datagram. */
+static gboolean flow_send(randpkt_flow* flow, int from, const guint8* data, guint len)
+{
+	guint seg_len;
+	guint segs = 0;
+
+	if (flow->ip_proto != FLOW_IP_PROTO_TCP)
+		return flow_packet(flow, from, 0, data, MIN(len, flow->mss));
+
+	do {
+		seg_len = MIN(len, flow->mss);
+		if (!flow_packet(flow, from,
+		    seg_len == len ? FLOW_TCP_PSH | FLOW_TCP_ACK : FLOW_TCP_ACK,
+		    data, seg_len))
+			return FALSE;
+		data += seg_len;
+		len -= seg_len;
+
+		/* The other side acknowledges every other segment */
+		if (++segs % 2 == 0 && len > 0 &&
+		    !flow_packet(flow, !from, FLOW_TCP_ACK, NULL, 0))
+			return FALSE;
+	} while (len > 0);
+
+	return TRUE;
+}
+
+/* Append a random lower case word */
+static void flow_word(randpkt_flow* flow, GString* str, guint min_len, guint max_len)
+{
+	guint len = g_rand_int_range(flow->rand, min_len, max_len + 1);
+
+	while (len-- > 0)
+		g_string_append_c(str, 'a' + g_rand_int_range(flow->rand, 0, 26));
+}
+
+/* Append a DNS label holding a random word */
+static void flow_dns_label(randpkt_flow* flow, GByteArray* msg, guint min_len, guint max_len)
+{
+	GString* word = g_string_new(NULL);
+	guint8 len;
+
+	flow_word(flow, word, min_len, max_len);
+	len = (guint8)word->len;
+	g_byte_array_append(msg, &len, 1);
+	g_byte_array_append(msg, (const guint8*)word->str, len);
+	g_string_free(word, TRUE);
+}
+
+/* A query for the address of a random name, and its answer */
+static gboolean flow_talk_dns(randpkt_flow* flow)
+{
+	static const char* tlds[] = { "com", "net", "org", "example" };
+	GByteArray* query = g_byte_array_new();
+	GByteArray* response = g_byte_array_new();
+	guint8 buf[16];
+	guint16 qtype = g_rand_boolean(flow->rand) ? 1 : 28;	/* A or AAAA */
+	gboolean nxdomain = g_rand_int_range(flow->rand, 0, 10) == 0;
+	const char* tld;
+	guint8 len;
+	guint i;
+	gboolean ok;
+
+	/* A recursive query with a single question */
+	phton16(buf, g_rand_int_range(flow->rand, 0, 65536));
+	phton16(buf + 2, 0x0100);
+	phton16(buf + 4, 1);
+	phton16(buf + 6, 0);
+	phton16(buf + 8, 0);
+	phton16(buf + 10, 0);
+	g_byte_array_append(query, buf, 12);
+
+	if (g_rand_boolean(flow->rand)) {
+		len = 3;
+		g_byte_array_append(query, &len, 1);
+		g_byte_array_append(query, (const guint8*)"www", 3);
+	}
+	flow_dns_label(flow, query, 2, 15);
+	tld = tlds[g_rand_int_range(flow->rand, 0, array_length(tlds))];
+	len = (guint8)strlen(tld);
+	g_byte_array_append(query, &len, 1);
+	g_byte_array_append(query, (const guint8*)tld, len);
+	len = 0;
+	g_byte_array_append(query, &len, 1);
+	phton16(buf, qtype);
+	phton16(buf + 2, 1);	/* IN */
+	g_byte_array_append(query, buf, 4);
+
+	ok = flow_send(flow, FLOW_CLIENT, query->data, query->len);
+
+	/* The response repeats the question */
+	g_byte_array_append(response, query->data, query->len);
+	phton16(response->data + 2, nxdomain ? 0x8183 : 0x8180);
+	if (!nxdomain) {
+		phton16(response->data + 6, 1);
+		phton16(buf, 0xc00c);	/* the name of the question */
+		phton16(buf + 2, qtype);
+		phton16(buf + 4, 1);
+		phton32(buf + 6, g_rand_int_range(flow->rand, 60, 86400));
+		phton16(buf + 10, qtype == 1 ? 4 : 16);
+		g_byte_array_append(response, buf, 12);
+		for (i = 0; i < (qtype == 1 ? 4U : 16U); i++)
+			buf[i] = (guint8)g_rand_int(flow->rand);
+		g_byte_array_append(response, buf, qtype == 1 ? 4 : 16);
+	}
+
+	ok = ok && flow_send(flow, FLOW_SERVER, response->data, response->len);
+
+	g_byte_array_free(query, TRUE);
+	g_byte_array_free(response, TRUE);
+	return ok;
+}
+
+/* A few requests for pages of a site over one connection */
+static gboolean flow_talk_http(randpkt_flow* flow)
+{
+	GString* host = g_string_new("www.");
+	GString* request = g_string_new(NULL);
+	GString* body = g_string_new(NULL);
+	GString* response = g_string_new(NULL);
+	guint requests = g_rand_int_range(flow->rand, 1, 4);
+	guint words;
+	gboolean ok = TRUE;
+
+	flow_word(flow, host, 2, 15);
+	g_string_append(host, ".example");
+
+	while (ok && requests-- > 0) {
+		g_string_assign(request, "GET /");
+		flow_word(flow, request, 1, 20);
+		g_string_append_printf(request, ".html HTTP/1.1\r\n"
+		    "Host: %s\r\n"
+		    "User-Agent: randpkt\r\n"
+		    "Accept: text/html\r\n"
+		    "\r\n", host->str);
+
+		g_string_assign(body, "<html><body><p>");
+		words = g_rand_int_range(flow->rand, 0, 1000);
+		while (words-- > 0) {
+			flow_word(flow, body, 1, 10);
+			g_string_append_c(body, ' ');
+		}
+		g_string_append(body, "</p></body></html>\r\n");
+
+		g_string_printf(response, "HTTP/1.1 200 OK\r\n"
+		    "Content-Type: text/html\r\n"
+		    "Content-Length: %u\r\n"
+		    "\r\n", (guint)body->len);
+		g_string_append_len(response, body->str, body->len);
+
+		ok = flow_send(flow, FLOW_CLIENT, (const guint8*)request->str, (guint)request->len) &&
+		     flow_send(flow, FLOW_SERVER, (const guint8*)response->str, (guint)response->len);
+	}
+
+	g_string_free(host, TRUE);
+	g_string_free(request, TRUE);
+	g_string_free(body, TRUE);
+	g_string_free(response, TRUE);
+	return ok;
+}
+
+/* A few BSD syslog messages from one host */
+static gboolean flow_talk_syslog(randpkt_flow* flow)
 {
+	static const char* months[] = {
+		"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+		"Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+	};
+	static const char* apps[] = { "cron", "kernel", "postfix", "sshd", "systemd" };
+	GString* host = g_string_new(NULL);
+	GString* msg = g_string_new(NULL);
+	guint count = g_rand_int_range(flow->rand, 1, 6);
+	guint pri, month, day, hour, minute, second, app, pid, words;
+	gboolean ok = TRUE;
+
+	flow_word(flow, host, 2, 15);
+
+	while (ok && count-- > 0) {
+		pri = g_rand_int_range(flow->rand, 0, 192);
+		month = g_rand_int_range(flow->rand, 0, 12);
+		day = g_rand_int_range(flow->rand, 1, 29);
+		hour = g_rand_int_range(flow->rand, 0, 24);
+		minute = g_rand_int_range(flow->rand, 0, 60);
+		second = g_rand_int_range(flow->rand, 0, 60);
+		app = g_rand_int_range(flow->rand, 0, array_length(apps));
+		pid = g_rand_int_range(flow->rand, 1, 32768);
+		g_string_printf(msg, "<%u>%s %2u %02u:%02u:%02u %s %s[%u]:",
+		    pri, months[month], day, hour, minute, second,
+		    host->str, apps[app], pid);
+
+		words = g_rand_int_range(flow->rand, 1, 20);
+		while (words-- > 0) {
+			g_string_append_c(msg, ' ');
+			flow_word(flow, msg, 1, 10);
+		}
+
+		ok = flow_send(flow, FLOW_CLIENT, (const guint8*)msg->str, (guint)msg->len);
+	}
+
+	g_string_free(host, TRUE);
+	g_string_free(msg, TRUE);
+	return ok;
+}
+
+/* Add a whole flow with new endpoints.  Returns FALSE if it didn't fit
+ * in the chunk. */
+static gboolean flow_session(randpkt_flow* flow, const randpkt_flow_type* type)
+{
+	int side;
+	guint i;
+
+	/* A flow starts a second per packet after the first one of the
+	 * file, so that the flows never overlap in time */
+	flow->clock = (flow->chunk->first + flow->n) * G_GUINT64_CONSTANT(1000000);
+
+	for (side = FLOW_CLIENT; side <= FLOW_SERVER; side++) {
+		/* Locally administered MAC addresses */
+		flow->mac[side][0] = 0x02;
+		for (i = 1; i < 6; i++)
+			flow->mac[side][i] = (guint8)g_rand_int(flow->rand);
+		flow->ip_id[side] = (guint16)g_rand_int(flow->rand);
+		flow->seq[side] = g_rand_int(flow->rand);
+	}
+	/* Clients in 10.0.0.0/8, servers in the 198.18.0.0/15
+	 * benchmarking range, a few hops away */
+	flow->addr[FLOW_CLIENT] = 0x0a000000 | (g_rand_int(flow->rand) & 0xffffff);
+	flow->addr[FLOW_SERVER] = 0xc6120000 | (g_rand_int(flow->rand) & 0x1ffff);
+	flow->port[FLOW_CLIENT] = (guint16)g_rand_int_range(flow->rand, 49152, 65536);
+	flow->port[FLOW_SERVER] = type->port;
+	flow->ttl[FLOW_CLIENT] = 64;
+	flow->ttl[FLOW_SERVER] = (guint8)g_rand_int_range(flow->rand, 40, 64);
+
+	if (flow->ip_proto == FLOW_IP_PROTO_TCP &&
+	    (!flow_packet(flow, FLOW_CLIENT, FLOW_TCP_SYN, NULL, 0) ||
+	     !flow_packet(flow, FLOW_SERVER, FLOW_TCP_SYN | FLOW_TCP_ACK, NULL, 0) ||
+	     !flow_packet(flow, FLOW_CLIENT, FLOW_TCP_ACK, NULL, 0)))
+		return FALSE;
+
+	if (!type->talk(flow))
+		return FALSE;
+
+	if (flow->ip_proto == FLOW_IP_PROTO_TCP &&
+	    (!flow_packet(flow, FLOW_CLIENT, FLOW_TCP_FIN | FLOW_TCP_ACK, NULL, 0) ||
+	     !flow_packet(flow, FLOW_SERVER, FLOW_TCP_FIN | FLOW_TCP_ACK, NULL, 0) ||
+	     !flow_packet(flow, FLOW_CLIENT, FLOW_TCP_ACK, NULL, 0)))
+		return FALSE;
+
+	return TRUE;
+}
+
+/* Fill a chunk with whole flows.  A flow that doesn't fit is left out,
+ * unless it's the first one, which is then cut short. */
+static void randpkt_flow_generate(randpkt_chunk* chunk)
+{
+	const randpkt_flow_type* type = chunk->example->flow_type;
+	randpkt_flow flow;
+	guint start;
+
+	memset(&flow, 0, sizeof flow);
+	flow.chunk = chunk;
+	flow.rand = g_rand_new_with_seed(chunk->seed);
+	flow.ip_proto = type->ip_proto;
+	flow.mss = MIN(FLOW_MSS, chunk->example->produce_max_bytes);
+
+	while (flow.n < chunk->count) {
+		start = flow.n;
+		if (!flow_session(&flow, type)) {
+			if (start > 0)
+				flow.n = start;
+			break;
+		}
+	}
+	chunk->count = flow.n;
+
+	g_rand_free(flow.rand);
+}
+
+static void randpkt_chunk_generate(randpkt_chunk* chunk)
+{
+	randpkt_example* example = chunk->example;
+	GRand* rand;
 	guint i, j;
-	int err;
+	guint32 r;
 	guint len_random;
 	guint len_this_pkt;
-	gchar* err_info;
 	union wtap_pseudo_header* ps_header;
 	guint8* buffer;
 	struct wtap_pkthdr* pkthdr;
 
-	pkthdr = g_new0(struct wtap_pkthdr, 1);
-	buffer = (guint8*)g_malloc0(65536);
+	if (example->flow_type != NULL) {
+		randpkt_flow_generate(chunk);
+		return;
+	}
 
-	pkthdr->rec_type = REC_TYPE_PACKET;
-	pkthdr->presence_flags = WTAP_HAS_TS;
-	pkthdr->pkt_encap = example->sample_wtap_encap;
+	rand = g_rand_new_with_seed(chunk->seed);
+
+	for (i = 0; i < chunk->count; i++) {
+		pkthdr = &chunk->pkthdrs[i];
+		buffer = chunk->data + (gsize)i * chunk->stride;
+
+		memset(pkthdr, 0, sizeof *pkthdr);
+		pkthdr->rec_type = REC_TYPE_PACKET;
+		pkthdr->presence_flags = WTAP_HAS_TS;
+		pkthdr->pkt_encap = example->sample_wtap_encap;
 
-	ps_header = &pkthdr->pseudo_header;
+		ps_header = &pkthdr->pseudo_header;
 
-	/* Load the sample pseudoheader into our pseudoheader buffer */
-	if (example->pseudo_buffer)
-		memcpy(ps_header, example->pseudo_buffer, example->pseudo_length);
+		/* Load the sample pseudoheader into our pseudoheader buffer */
+		if (example->pseudo_buffer)
+			memcpy(ps_header, example->pseudo_buffer, example->pseudo_length);
 
-	/* Load the sample into our buffer */
-	if (example->sample_buffer)
-		memcpy(buffer, example->sample_buffer, example->sample_length);
+		/* Load the sample into our buffer */
+		if (example->sample_buffer)
+			memcpy(buffer, example->sample_buffer, example->sample_length);
 
-	/* Produce random packets */
-	for (i = 0; i < produce_count; i++) {
 		if (example->produce_max_bytes > 0) {
-			len_random = g_rand_int_range(pkt_rand, 0, example->produce_max_bytes + 1);
+			len_random = g_rand_int_range(rand, 0, example->produce_max_bytes + 1);
 		}
 		else {
 			len_random = 0;
@@ -608,31 +1143,197 @@ void randpkt_loop(randpkt_example* example, guint64 produce_count)
 
 		pkthdr->caplen = len_this_pkt;
 		pkthdr->len = len_this_pkt;
-		pkthdr->ts.secs = i; /* just for variety */
+		pkthdr->ts.secs = (time_t)(chunk->first + i); /* just for variety */
 
 		for (j = example->pseudo_length; j < (int) sizeof(*ps_header); j++) {
-			((guint8*)ps_header)[j] = g_rand_int_range(pkt_rand, 0, 0x100);
+			((guint8*)ps_header)[j] = (guint8)g_rand_int(rand);
 		}
 
 		for (j = example->sample_length; j < len_this_pkt; j++) {
-			/* Add format strings here and there */
-			if ((int) (100.0*g_rand_double(pkt_rand)) < 3 && j < (len_random - 3)) {
+			/* One random number per byte: the low bits are the
+			 * byte, the others decide whether to add a format
+			 * string here instead */
+			r = g_rand_int(rand);
+			if ((r >> 8) % 100 < 3 && j + 3 <= len_this_pkt) {
 				memcpy(&buffer[j], "%s", 3);
 				j += 2;
 			} else {
-				buffer[j] = g_rand_int_range(pkt_rand, 0, 0x100);
+				buffer[j] = (guint8)r;
 			}
 		}
+	}
+
+	g_rand_free(rand);
+}
+
+/* The chunks are generated by persistent worker threads, and written in
+ * order by the calling thread.  Chunk number c is kept in slot
+ * c % n_slots, so the workers can get ahead of the writing by n_slots
+ * chunks. */
+typedef struct {
+	randpkt_chunk*	chunks;
+	guint		n_slots;
+	guint64		next_gen;	/* the next chunk for a worker to take */
+	guint64		n_queued;	/* chunks handed out so far */
+	gboolean	stop;
+	GMutex*		mutex;		/* protects all of the above */
+	GCond*		cond;
+} randpkt_chunk_queue;
+
+static gpointer randpkt_chunk_worker(gpointer data)
+{
+	randpkt_chunk_queue* q = (randpkt_chunk_queue*)data;
+	randpkt_chunk* chunk;
+
+	for (;;) {
+		g_mutex_lock(q->mutex);
+		while (!q->stop && q->next_gen >= q->n_queued)
+			g_cond_wait(q->cond, q->mutex);
+		if (q->stop) {
+			g_mutex_unlock(q->mutex);
+			break;
+		}
+		chunk = &q->chunks[q->next_gen++ % q->n_slots];
+		g_mutex_unlock(q->mutex);
+
+		randpkt_chunk_generate(chunk);
+
+		g_mutex_lock(q->mutex);
+		chunk->done = TRUE;
+		g_cond_broadcast(q->cond);
+		g_mutex_unlock(q->mutex);
+	}
+	return NULL;
+}
+
+void randpkt_loop(randpkt_example* example, guint64 produce_count)
+{
+	randpkt_loop_threads(example, produce_count, 1);
+}
+
+void randpkt_loop_threads(randpkt_example* example, guint64 produce_count, guint n_threads)
+{
+	randpkt_chunk_queue q;
+	randpkt_chunk* chunk;
+	GThread** threads = NULL;
+	guint64 first = 0;
+	guint64 written = 0;
+	guint64 next_write;
+	guint chunk_packets;
+	guint i, t;
+	int err;
+	gchar* err_info;
+
+	if (produce_count == 0)
+		return;
+
+	/* Don't allocate more than the packets need, e.g. when called for
+	 * each packet in random mode */
+	chunk_packets = (guint)MIN(CHUNK_PACKETS, produce_count);
+	if (n_threads < 1)
+		n_threads = 1;
+	n_threads = (guint)MIN(n_threads, (produce_count + CHUNK_PACKETS - 1) / CHUNK_PACKETS);
+
+	memset(&q, 0, sizeof q);
+	/* With a single thread the chunks are generated here, one at a time */
+	q.n_slots = (n_threads > 1) ? 2 * n_threads : 1;
+	q.chunks = g_new0(randpkt_chunk, q.n_slots);
+	for (t = 0; t < q.n_slots; t++) {
+		q.chunks[t].example = example;
+		q.chunks[t].stride = example->sample_length + example->produce_max_bytes;
+		q.chunks[t].pkthdrs = g_new(struct wtap_pkthdr, chunk_packets);
+		q.chunks[t].data = (guint8*)g_malloc0((gsize)chunk_packets * MAX(q.chunks[t].stride, 1));
+	}
+
+	if (n_threads > 1) {
+#if GLIB_CHECK_VERSION(2,31,0)
+		q.mutex = g_new(GMutex, 1);
+		g_mutex_init(q.mutex);
+		q.cond = g_new(GCond, 1);
+		g_cond_init(q.cond);
+#else
+		q.mutex = g_mutex_new();
+		q.cond = g_cond_new();
+#endif
+		threads = g_new(GThread*, n_threads);
+		for (t = 0; t < n_threads; t++) {
+#if GLIB_CHECK_VERSION(2,31,0)
+			threads[t] = g_thread_new("randpkt", randpkt_chunk_worker, &q);
+#else
+			threads[t] = g_thread_create(randpkt_chunk_worker, &q, TRUE, NULL);
+#endif
+		}
+	}
+
+	for (next_write = 0; written < produce_count; next_write++) {
+		/* Hand out the seeds in chunk order, as far ahead as there are
+		 * free slots.  Chunks of flows only hold whole flows, so they
+		 * may come back with fewer packets than they have room for;
+		 * they always get a full chunk of room, so that they don't
+		 * depend on the number of threads, and more are handed out
+		 * until enough packets are written. */
+		if (q.mutex)
+			g_mutex_lock(q.mutex);
+		while (q.n_queued < next_write + q.n_slots &&
+		    (q.n_queued == next_write || example->flow_type != NULL || first < produce_count)) {
+			chunk = &q.chunks[q.n_queued % q.n_slots];
+			chunk->seed = g_rand_int(pkt_rand);
+			chunk->first = first;
+			if (example->flow_type != NULL)
+				chunk->count = chunk_packets;
+			else
+				chunk->count = (guint)MIN(chunk_packets, produce_count - first);
+			chunk->done = FALSE;
+			first += chunk_packets;
+			q.n_queued++;
+		}
+
+		chunk = &q.chunks[next_write % q.n_slots];
+		if (q.mutex) {
+			g_cond_broadcast(q.cond);
+			while (!chunk->done)
+				g_cond_wait(q.cond, q.mutex);
+			g_mutex_unlock(q.mutex);
+		} else {
+			randpkt_chunk_generate(chunk);
+		}
 
-		if (!wtap_dump(example->dump, pkthdr, buffer, &err, &err_info)) {
-			cfile_write_failure_message("randpkt", NULL,
-			    example->filename, err, err_info, 0,
-			    WTAP_FILE_TYPE_SUBTYPE_PCAP);
+		/* The dumper isn't thread-safe; write the chunks in order */
+		for (i = 0; i < chunk->count && written < produce_count; i++, written++) {
+			if (!wtap_dump(example->dump, &chunk->pkthdrs[i],
+			    chunk->data + (gsize)i * chunk->stride,
+			    &err, &err_info)) {
+				cfile_write_failure_message("randpkt", NULL,
+				    example->filename, err, err_info, 0,
+				    WTAP_FILE_TYPE_SUBTYPE_PCAP);
+			}
 		}
 	}
 
-	g_free(pkthdr);
-	g_free(buffer);
+	if (threads != NULL) {
+		g_mutex_lock(q.mutex);
+		q.stop = TRUE;
+		g_cond_broadcast(q.cond);
+		g_mutex_unlock(q.mutex);
+		for (t = 0; t < n_threads; t++)
+			g_thread_join(threads[t]);
+		g_free(threads);
+#if GLIB_CHECK_VERSION(2,31,0)
+		g_mutex_clear(q.mutex);
+		g_free(q.mutex);
+		g_cond_clear(q.cond);
+		g_free(q.cond);
+#else
+		g_mutex_free(q.mutex);
+		g_cond_free(q.cond);
+#endif
+	}
+
+	for (t = 0; t < q.n_slots; t++) {
+		g_free(q.chunks[t].pkthdrs);
+		g_free(q.chunks[t].data);
+	}
+	g_free(q.chunks);
 }
 
 gboolean randpkt_example_close(randpkt_example* example)
@@ -692,6 +1393,13 @@ int randpkt_example_init(randpkt_example* example, char* produce_filename, int p
 	return EXIT_SUCCESS;
 }
 
+void randpkt_seed(guint32 seed)
+{
+	if (pkt_rand != NULL)
+		g_rand_free(pkt_rand);
+	pkt_rand = g_rand_new_with_seed(seed);
+}
+
 /* Parse command-line option "type" and return enum type */
 int randpkt_parse_type(char *string)
 {
@@ -700,6 +1408,8 @@ int randpkt_parse_type(char *string)
 
 	/* If called with NULL, or empty string, choose a random packet */
 	if (!string || !g_strcmp0(string, "")) {
+		if (pkt_rand != NULL)
+			return examples[g_rand_int_range(pkt_rand, 0, num_entries)].produceable_type;
 		return examples[g_random_int_range(0, num_entries)].produceable_type;
 	}
 
@@ -27,6 +27,9 @@
 #include <glib.h>
 #include "wiretap/wtap.h"
 
+/* The protocol and the talk of the examples producing sessions */
+typedef struct _randpkt_flow_type randpkt_flow_type;
+
 typedef struct {
 	const char*  abbrev;
 	const char*  longname;
@@ -39,6 +42,7 @@ typedef struct {
 	wtap_dumper* dump;
 	const char*  filename;
 	guint        produce_max_bytes;
+	const randpkt_flow_type* flow_type;	/* NULL unless the example produces sessions */
 
 } randpkt_example;
 
@@ -57,9 +61,16 @@ randpkt_example* randpkt_find_example(int type);
 /* Init a new example */
 int randpkt_example_init(randpkt_example* example, char* produce_filename, int produce_max_bytes);
 
+/* Use a fixed seed, so that every run produces the same packets */
+void randpkt_seed(guint32 seed);
+
 /* Loop the packet generation */
 void randpkt_loop(randpkt_example* example, guint64 produce_count);
 
+/* Loop the packet generation, generating the packets in n_threads threads.
+ * For a given seed the packets don't depend on the number of threads. */
+void randpkt_loop_threads(randpkt_example* example, guint64 produce_count, guint n_threads);
+
 /* Close the current example */
 gboolean randpkt_example_close(randpkt_example* example);
 
@@ -151,7 +151,23 @@ static print_format_e print_format = PR_FMT_TEXT;
 
 static gboolean want_pcap_pkthdr;
 
+/*
+ * The pipe is read in blocks of up to RAW_PIPE_BUFSIZE bytes and the
+ * records are taken out of the buffer, rather than reading each record
+ * header and packet separately.
+ */
+#define RAW_PIPE_BUFSIZE (1024 * 1024)
+
+static guchar *pipe_buf;
+static guint pipe_buf_start;    /* first byte not processed yet */
+static guint pipe_buf_end;      /* end of the data read */
+
+/* Set from the magic number of the pcap header skipped with -s */
+static gboolean pipe_byte_swapped;
+static gboolean pipe_nsecs;
+
 cf_status_t raw_cf_open(capture_file *cf, const char *fname);
+static gboolean raw_pipe_fill(guint needed, int *err);
 static gboolean load_cap_file(capture_file *cf);
 static gboolean process_packet(capture_file *cf, epan_dissect_t *edt, gint64 offset,
                                struct wtap_pkthdr *whdr, const guchar *pd);
@@ -823,17 +839,31 @@ main(int argc, char *argv[])
 
         /* Do we need to PCAP header and magic? */
         if (skip_pcap_header) {
-            unsigned int bytes_left = (unsigned int) sizeof(struct pcap_hdr) + sizeof(guint32);
-            gchar buf[sizeof(struct pcap_hdr) + sizeof(guint32)];
-            while (bytes_left != 0) {
-                ssize_t bytes = ws_read(fd, buf, bytes_left);
-                if (bytes <= 0) {
-                    cmdarg_err("Not enough bytes for pcap header.");
-                    ret =  FORMAT_ERROR;
-                    goto clean_exit;
-                }
-                bytes_left -= (unsigned int)bytes;
+            int err;
+            guint32 magic;
+
+            if (!raw_pipe_fill(sizeof(struct pcap_hdr) + sizeof(guint32), &err)) {
+                cmdarg_err("Not enough bytes for pcap header.");
+                ret =  FORMAT_ERROR;
+                goto clean_exit;
+            }
+
+            /* The magic number gives the byte order of the record headers
+               and the resolution of their time stamps. */
+            memcpy(&magic, pipe_buf + pipe_buf_start, sizeof magic);
+            switch (magic) {
+            case PCAP_SWAPPED_MAGIC:
+                pipe_byte_swapped = TRUE;
+                break;
+            case PCAP_NSEC_MAGIC:
+                pipe_nsecs = TRUE;
+                break;
+            case PCAP_SWAPPED_NSEC_MAGIC:
+                pipe_byte_swapped = TRUE;
+                pipe_nsecs = TRUE;
+                break;
             }
+            pipe_buf_start += (guint) (sizeof(struct pcap_hdr) + sizeof(guint32));
         }
 
         /* Process the packets in the file */
@@ -849,6 +879,7 @@ main(int argc, char *argv[])
     }
 
 clean_exit:
+    g_free(pipe_buf);
     epan_free(cfile.epan);
     epan_cleanup();
 #ifdef HAVE_EXTCAP
@@ -858,6 +889,44 @@ clean_exit:
     return ret;
 }
 
+/**
+ * Make sure the pipe buffer holds at least "needed" bytes, reading as
+ * much as is available from the pipe.
+ * @param needed [IN] The number of bytes needed, at most RAW_PIPE_BUFSIZE.
+ * @param err [OUT] Error indicator: 0 at the end of the input, else errno.
+ * @return TRUE on success, FALSE on failure.
+ */
+static gboolean
+raw_pipe_fill(guint needed, int *err) {
+    ssize_t bytes_read;
+
+    if (pipe_buf == NULL)
+        pipe_buf = (guchar*) g_malloc(RAW_PIPE_BUFSIZE);
+
+    if (pipe_buf_end - pipe_buf_start >= needed)
+        return TRUE;
+
+    /* Move the partial record to the start of the buffer */
+    if (pipe_buf_start > 0) {
+        memmove(pipe_buf, pipe_buf + pipe_buf_start, pipe_buf_end - pipe_buf_start);
+        pipe_buf_end -= pipe_buf_start;
+        pipe_buf_start = 0;
+    }
+
+    while (pipe_buf_end < needed) {
+        bytes_read = ws_read(fd, pipe_buf + pipe_buf_end, RAW_PIPE_BUFSIZE - pipe_buf_end);
+        if (bytes_read == 0) {
+            *err = 0;
+            return FALSE;
+        } else if (bytes_read < 0) {
+            *err = errno;
+            return FALSE;
+        }
+        pipe_buf_end += (guint)bytes_read;
+    }
+    return TRUE;
+}
+
 /**
  * Read data from a raw pipe.  The "raw" data consists of a libpcap
  * packet header followed by the payload.
@@ -873,15 +942,12 @@ static gboolean
 raw_pipe_read(struct wtap_pkthdr *phdr, guchar * pd, int *err, gchar **err_info, gint64 *data_offset) {
     struct pcap_pkthdr mem_hdr;
     struct pcaprec_hdr disk_hdr;
-    ssize_t bytes_read = 0;
     unsigned int bytes_needed = (unsigned int) sizeof(disk_hdr);
-    guchar *ptr = (guchar*) &disk_hdr;
 
     *err = 0;
 
     if (want_pcap_pkthdr) {
         bytes_needed = sizeof(mem_hdr);
-        ptr = (guchar*) &mem_hdr;
     }
 
     /*
@@ -901,34 +967,32 @@ raw_pipe_read(struct wtap_pkthdr *phdr, guchar * pd, int *err, gchar **err_info,
     }
 #endif
 
-    /* Copied from capture_loop.c */
-    while (bytes_needed > 0) {
-        bytes_read = ws_read(fd, ptr, bytes_needed);
-        if (bytes_read == 0) {
-            *err = 0;
-            *err_info = NULL;
-            return FALSE;
-        } else if (bytes_read < 0) {
-            *err = errno;
-            *err_info = NULL;
-            return FALSE;
-        }
-        bytes_needed -= (unsigned int)bytes_read;
-        *data_offset += bytes_read;
-        ptr += bytes_read;
+    if (!raw_pipe_fill(bytes_needed, err)) {
+        *err_info = NULL;
+        return FALSE;
     }
 
     if (want_pcap_pkthdr) {
+        memcpy(&mem_hdr, pipe_buf + pipe_buf_start, sizeof(mem_hdr));
         phdr->ts.secs = mem_hdr.ts.tv_sec;
         phdr->ts.nsecs = (gint32)mem_hdr.ts.tv_usec * 1000;
         phdr->caplen = mem_hdr.caplen;
         phdr->len = mem_hdr.len;
     } else {
+        memcpy(&disk_hdr, pipe_buf + pipe_buf_start, sizeof(disk_hdr));
+        if (pipe_byte_swapped) {
+            disk_hdr.ts_sec = GUINT32_SWAP_LE_BE(disk_hdr.ts_sec);
+            disk_hdr.ts_usec = GUINT32_SWAP_LE_BE(disk_hdr.ts_usec);
+            disk_hdr.incl_len = GUINT32_SWAP_LE_BE(disk_hdr.incl_len);
+            disk_hdr.orig_len = GUINT32_SWAP_LE_BE(disk_hdr.orig_len);
+        }
         phdr->ts.secs = disk_hdr.ts_sec;
-        phdr->ts.nsecs = disk_hdr.ts_usec * 1000;
+        phdr->ts.nsecs = pipe_nsecs ? disk_hdr.ts_usec : disk_hdr.ts_usec * 1000;
         phdr->caplen = disk_hdr.incl_len;
         phdr->len = disk_hdr.orig_len;
     }
+    pipe_buf_start += bytes_needed;
+    *data_offset += bytes_needed;
     bytes_needed = phdr->caplen;
 
     phdr->pkt_encap = encap;
@@ -947,22 +1011,15 @@ raw_pipe_read(struct wtap_pkthdr *phdr, guchar * pd, int *err, gchar **err_info,
         return FALSE;
     }
 
-    ptr = pd;
-    while (bytes_needed > 0) {
-        bytes_read = ws_read(fd, ptr, bytes_needed);
-        if (bytes_read == 0) {
+    if (!raw_pipe_fill(bytes_needed, err)) {
+        if (*err == 0)
             *err = WTAP_ERR_SHORT_READ;
-            *err_info = NULL;
-            return FALSE;
-        } else if (bytes_read < 0) {
-            *err = errno;
-            *err_info = NULL;
-            return FALSE;
-        }
-        bytes_needed -= (unsigned int)bytes_read;
-        *data_offset += bytes_read;
-        ptr += bytes_read;
+        *err_info = NULL;
+        return FALSE;
     }
+    memcpy(pd, pipe_buf + pipe_buf_start, bytes_needed);
+    pipe_buf_start += bytes_needed;
+    *data_offset += bytes_needed;
     return TRUE;
 }
 
@@ -34,6 +34,7 @@
 #include <wsutil/ws_printf.h>
 
 #include <file.h>
+#include <epan/app_mem_usage.h>
 #include <epan/exceptions.h>
 #include <epan/color_filters.h>
 #include <epan/prefs.h>
@@ -620,6 +621,56 @@ sharkd_session_process_status(void)
 	printf("}\n");
 }
 
+/**
+ * sharkd_session_process_memory()
+ *
+ * Process memory request
+ *
+ * Output object with attributes:
+ *   (m) memory - array of memory usage components, with attributes:
+ *                  'name'  - component name
+ *                  'bytes' - bytes used
+ *   (m) scopes - array of wmem scopes, with attributes:
+ *                  'name'        - scope name
+ *                  'allocs'      - allocations made from the scope
+ *                  'alloc_bytes' - bytes requested by them
+ *                  'free_alls'   - number of times the scope was emptied
+ *                  'chunks'      - chunks of memory held from the system
+ *                  'chunk_bytes' - bytes in those chunks
+ */
+static void
+sharkd_session_process_memory(void)
+{
+	wmem_allocator_stats_t stats;
+	const char *name;
+	gsize value;
+	guint i;
+
+	printf("{\"memory\":[");
+	for (i = 0; (name = memory_usage_get(i, &value)) != NULL; i++)
+	{
+		printf("%s{\"name\":", i ? "," : "");
+		json_puts_string(name);
+		printf(",\"bytes\":%" G_GSIZE_FORMAT "}", value);
+	}
+	printf("]");
+
+	printf(",\"scopes\":[");
+	for (i = 0; (name = memory_usage_get_scope_stats(i, &stats)) != NULL; i++)
+	{
+		printf("%s{\"name\":", i ? "," : "");
+		json_puts_string(name);
+		printf(",\"allocs\":%" G_GUINT64_FORMAT, stats.alloc_count);
+		printf(",\"alloc_bytes\":%" G_GUINT64_FORMAT, stats.alloc_bytes);
+		printf(",\"free_alls\":%" G_GUINT64_FORMAT, stats.free_all_count);
+		printf(",\"chunks\":%" G_GSIZE_FORMAT, stats.chunk_count);
+		printf(",\"chunk_bytes\":%" G_GSIZE_FORMAT "}", stats.chunk_bytes);
+	}
+	printf("]");
+
+	printf("}\n");
+}
+
 struct sharkd_analyse_data
 {
 	GHashTable *protocols_set;
@@ -3659,6 +3710,8 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
 			sharkd_session_process_load(buf, tokens, count);
 		else if (!strcmp(tok_req, "status"))
 			sharkd_session_process_status();
+		else if (!strcmp(tok_req, "memory"))
+			sharkd_session_process_memory();
 		else if (!strcmp(tok_req, "analyse"))
 			sharkd_session_process_analyse();
 		else if (!strcmp(tok_req, "info"))
@@ -28,81 +28,13 @@
 
 #include <epan/packet.h>
 #include "cfile.h"
+#include "file.h"
 #include "summary.h"
 
-static void
-tally_frame_data(frame_data *cur_frame, summary_tally *sum_tally)
-{
-  double cur_time;
-
-  sum_tally->bytes += cur_frame->pkt_len;
-  if (cur_frame->flags.passed_dfilter){
-    sum_tally->filtered_count++;
-    sum_tally->filtered_bytes += cur_frame->pkt_len;
-  }
-  if (cur_frame->flags.marked){
-    sum_tally->marked_count++;
-    sum_tally->marked_bytes += cur_frame->pkt_len;
-  }
-  if (cur_frame->flags.ignored){
-    sum_tally->ignored_count++;
-  }
-
-  if (cur_frame->flags.has_ts) {
-    /* This packet has a time stamp. */
-    cur_time = nstime_to_sec(&cur_frame->abs_ts);
-
-    sum_tally->packet_count_ts++;
-    if (cur_time < sum_tally->start_time) {
-      sum_tally->start_time = cur_time;
-    }
-    if (cur_time > sum_tally->stop_time){
-      sum_tally->stop_time = cur_time;
-    }
-    if (cur_frame->flags.passed_dfilter){
-      sum_tally->filtered_count_ts++;
-      /*
-       * If we've seen one filtered packet, this is the first
-       * one.
-       */
-      if (sum_tally->filtered_count == 1){
-        sum_tally->filtered_start= cur_time;
-        sum_tally->filtered_stop = cur_time;
-      } else {
-        if (cur_time < sum_tally->filtered_start) {
-          sum_tally->filtered_start = cur_time;
-        }
-        if (cur_time > sum_tally->filtered_stop) {
-          sum_tally->filtered_stop = cur_time;
-        }
-      }
-    }
-    if (cur_frame->flags.marked){
-      sum_tally->marked_count_ts++;
-      /*
-       * If we've seen one marked packet, this is the first
-       * one.
-       */
-      if (sum_tally->marked_count == 1){
-        sum_tally->marked_start= cur_time;
-        sum_tally->marked_stop = cur_time;
-      } else {
-        if (cur_time < sum_tally->marked_start) {
-          sum_tally->marked_start = cur_time;
-        }
-        if (cur_time > sum_tally->marked_stop) {
-          sum_tally->marked_stop = cur_time;
-        }
-      }
-    }
-  }
-}
-
 void
 summary_fill_in(capture_file *cf, summary_tally *st)
 {
-  frame_data    *first_frame, *cur_frame;
-  guint32        framenum;
+  const frame_tally_t *ft;
   iface_options iface;
   guint i;
   wtapng_iface_descriptions_t* idb_info;
@@ -113,33 +45,24 @@ summary_fill_in(capture_file *cf, summary_tally *st)
   char* if_string;
   wtapng_if_descr_filter_t* if_filter;
 
-  st->packet_count_ts = 0;
-  st->start_time = 0;
-  st->stop_time = 0;
-  st->bytes = 0;
-  st->filtered_count = 0;
-  st->filtered_count_ts = 0;
-  st->filtered_start = 0;
-  st->filtered_stop = 0;
-  st->filtered_bytes = 0;
-  st->marked_count = 0;
-  st->marked_count_ts = 0;
-  st->marked_start = 0;
-  st->marked_stop = 0;
-  st->marked_bytes = 0;
-  st->ignored_count = 0;
-
-  /* initialize the tally */
-  if (cf->count != 0) {
-    first_frame = frame_data_sequence_find(cf->frames, 1);
-    st->start_time = nstime_to_sec(&first_frame->abs_ts);
-    st->stop_time = nstime_to_sec(&first_frame->abs_ts);
-
-    for (framenum = 1; framenum <= cf->count; framenum++) {
-      cur_frame = frame_data_sequence_find(cf->frames, framenum);
-      tally_frame_data(cur_frame, st);
-    }
-  }
+  /* The totals are kept up to date as frames are read, filtered and
+     marked, so there's no need to go through all the frames here. */
+  ft = cf_get_frame_tally(cf);
+  st->packet_count_ts = ft->count_ts;
+  st->start_time = ft->start_time;
+  st->stop_time = ft->stop_time;
+  st->bytes = ft->bytes;
+  st->filtered_count = ft->filtered_count;
+  st->filtered_count_ts = ft->filtered_count_ts;
+  st->filtered_start = ft->filtered_start;
+  st->filtered_stop = ft->filtered_stop;
+  st->filtered_bytes = ft->filtered_bytes;
+  st->marked_count = cf->marked_count;
+  st->marked_count_ts = ft->marked_count_ts;
+  st->marked_start = ft->marked_start;
+  st->marked_stop = ft->marked_stop;
+  st->marked_bytes = ft->marked_bytes;
+  st->ignored_count = cf->ignored_count;
 
   st->filename = cf->filename;
   st->file_length = cf->f_datalen;
@@ -0,0 +1,132 @@
+#!/bin/bash
+
+# Randpkt dissection benchmark for TShark
+#
+# This script uses Randpkt to generate a reproducible capture file for
+# each packet type, then times TShark dissecting it and reports the number
+# of packets dissected per second.  The "-flow" types, made of well-formed
+# sessions, give the most meaningful numbers.
+#
+# It then reports the same rate per protocol: the protocol hierarchy of
+# each file is used to share its dissection time between the protocols
+# found in it, in proportion to the number of packets containing them.
+#
+# Unlike randpkt-test.sh this doesn't source test-common.sh, whose memory
+# debugging settings would slow everything down.
+
+# Directory containing binaries.  Default current directory.
+WIRESHARK_BIN_DIR=.
+TMP_DIR=/tmp
+# Packets per capture file
+PKT_COUNT=100000
+# Seed, so that every run dissects the same packets
+SEED=1
+# Threads generating the packets
+THREADS=1
+# Each file is dissected this many times; the fastest run is reported
+PASSES=3
+# Build protocol trees, as when printing packet details
+TREE=0
+
+while getopts "b:c:d:j:p:s:t:V" OPTCHAR ; do
+    case $OPTCHAR in
+        b) WIRESHARK_BIN_DIR=$OPTARG ;;
+        c) PKT_COUNT=$OPTARG ;;
+        d) TMP_DIR=$OPTARG ;;
+        j) THREADS=$OPTARG ;;
+        p) PASSES=$OPTARG ;;
+        s) SEED=$OPTARG ;;
+        t) PKT_TYPES=$OPTARG ;;
+        V) TREE=1 ;;
+        *) echo "Usage: $0 [-b bin dir] [-c count] [-d tmp dir] [-j threads] [-p passes] [-s seed] [-t \"types\"] [-V]"
+           exit 1 ;;
+    esac
+done
+shift $(($OPTIND - 1))
+
+TSHARK="$WIRESHARK_BIN_DIR/tshark"
+RANDPKT="$WIRESHARK_BIN_DIR/randpkt"
+
+if [ "$WIRESHARK_BIN_DIR" = "." ]; then
+    export WIRESHARK_RUN_FROM_BUILD_DIRECTORY=1
+fi
+
+for i in "$TSHARK" "$RANDPKT" ; do
+    if [ ! -x "$i" ]; then
+        echo "Couldn't find \"$i\""
+        exit 1
+    fi
+done
+
+[[ -z "$PKT_TYPES" ]] && PKT_TYPES=$($RANDPKT -h | awk '/^\t/ {print $1}')
+
+# TShark arguments
+# n Disable network object name resolution
+# V Print a view of the details of the packet
+# r Read packet data from the following infile
+TSHARK_ARGS="-nr"
+if [ $TREE -ne 0 ]; then
+    TSHARK_ARGS="-nVr"
+fi
+
+TMP_FILE=$TMP_DIR/randpkt-bench-$$.pcap
+PROTO_FILE=$TMP_DIR/randpkt-bench-$$.proto
+trap 'rm -f $TMP_FILE $PROTO_FILE; exit 1' HUP INT TERM
+: > "$PROTO_FILE"
+
+# Prints the real time taken by a command, in seconds
+function elapsed() {
+    local TIMEFORMAT=%R
+    { time "$@" > /dev/null 2>&1 ; } 2>&1
+}
+
+echo "Generating $PKT_COUNT packets per type with $RANDPKT -s $SEED -j $THREADS"
+echo "Dissecting with $TSHARK $TSHARK_ARGS, best of $PASSES"
+echo ""
+printf "%-16s %12s %12s %14s\n" "Type" "Size (MB)" "Gen (MB/s)" "Packets/s"
+
+for PKT_TYPE in $PKT_TYPES ; do
+    GEN_TIME=$(elapsed "$RANDPKT" -c "$PKT_COUNT" -s "$SEED" -j "$THREADS" \
+        -t "$PKT_TYPE" "$TMP_FILE")
+    if [ ! -s "$TMP_FILE" ] ; then
+        printf "%-16s %12s\n" "$PKT_TYPE" "failed"
+        continue
+    fi
+    SIZE=$(wc -c < "$TMP_FILE")
+
+    BEST=""
+    PASS=0
+    while [ $PASS -lt $PASSES ] ; do
+        let PASS=$PASS+1
+        TIME=$(elapsed "$TSHARK" $TSHARK_ARGS "$TMP_FILE")
+        BEST=$(awk -v a="$BEST" -v b="$TIME" 'BEGIN { print (a == "" || b < a) ? b : a }')
+    done
+
+    awk -v type="$PKT_TYPE" -v size="$SIZE" -v gen="$GEN_TIME" \
+        -v count="$PKT_COUNT" -v best="$BEST" 'BEGIN {
+            printf "%-16s %12.1f ", type, size / 1000000
+            if (gen > 0) printf "%12.1f ", size / 1000000 / gen; else printf "%12s ", "-"
+            if (best > 0) printf "%14.0f\n", count / best; else printf "%14s\n", "-"
+        }'
+
+    # Packets containing each protocol, and their share of the time
+    "$TSHARK" -n -q -z io,phs -r "$TMP_FILE" 2> /dev/null | \
+        awk -v count="$PKT_COUNT" -v best="$BEST" '/frames:/ {
+            split($2, f, ":")
+            if (count > 0) print $1, f[2], best * f[2] / count
+        }' >> "$PROTO_FILE"
+
+    rm -f "$TMP_FILE"
+done
+
+echo ""
+printf "%-16s %12s %14s\n" "Protocol" "Packets" "Packets/s"
+awk '{ frames[$1] += $2; time[$1] += $3 }
+    END {
+        for (p in frames) {
+            printf "%-16s %12d ", p, frames[p]
+            if (time[p] > 0) printf "%14.0f\n", frames[p] / time[p]; else printf "%14s\n", "-"
+        }
+    }' "$PROTO_FILE" | sort -k2,2nr
+
+rm -f "$PROTO_FILE"
@@ -361,35 +361,43 @@ capture_input_new_file(capture_session *cap_session, gchar *new_file)
 }
 
 
+/* read records from the end of the capture file in real time mode */
+static void
+capture_continue_tail(capture_session *cap_session, int to_read)
+{
+  int  err;
+
+  switch (cf_continue_tail((capture_file *)cap_session->cf, to_read, &err)) {
+
+  case CF_READ_OK:
+  case CF_READ_ERROR:
+    /* Just because we got an error, that doesn't mean we were unable
+       to read any of the file; we handle what we could get from the
+       file.
+
+       XXX - abort on a read error? */
+    capture_callback_invoke(capture_cb_capture_update_continue, cap_session);
+    break;
+
+  case CF_READ_ABORTED:
+    /* Kill the child capture process; the user wants to exit, and we
+       shouldn't just leave it running. */
+    capture_kill_child(cap_session);
+    break;
+  }
+}
+
 /* capture child tells us we have new packets to read */
 void
 capture_input_new_packets(capture_session *cap_session, int to_read)
 {
   capture_options *capture_opts = cap_session->capture_opts;
-  int  err;
 
   g_assert(capture_opts->save_file);
 
   if(capture_opts->real_time_mode) {
     /* Read from the capture file the number of records the child told us it added. */
-    switch (cf_continue_tail((capture_file *)cap_session->cf, to_read, &err)) {
-
-    case CF_READ_OK:
-    case CF_READ_ERROR:
-      /* Just because we got an error, that doesn't mean we were unable
-         to read any of the file; we handle what we could get from the
-         file.
-
-         XXX - abort on a read error? */
-         capture_callback_invoke(capture_cb_capture_update_continue, cap_session);
-      break;
-
-    case CF_READ_ABORTED:
-      /* Kill the child capture process; the user wants to exit, and we
-         shouldn't just leave it running. */
-      capture_kill_child(cap_session);
-      break;
-    }
+    capture_continue_tail(cap_session, to_read);
   } else {
     cf_fake_continue_tail((capture_file *)cap_session->cf);
 
@@ -401,6 +409,19 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
 }
 
 
+/* read the records an earlier update left unread */
+void
+capture_read_backlog(capture_session *cap_session)
+{
+  if (cap_session->state != CAPTURE_RUNNING ||
+      !cap_session->capture_opts->real_time_mode ||
+      cf_tail_backlog((capture_file *)cap_session->cf) == 0)
+    return;
+
+  capture_continue_tail(cap_session, 0);
+}
+
+
 /* Capture child told us how many dropped packets it counted.
  */
 void
@@ -82,6 +82,16 @@ capture_restart(capture_session *cap_session);
 extern void
 capture_kill_child(capture_session *cap_session);
 
+/**
+ * Read the records an earlier update left unread (see cf_tail_backlog()).
+ * The GUI should call this soon after a capture update while there are
+ * any, as the capture child won't tell us about them again.
+ *
+ * @param cap_session a handle for the capture session
+ */
+extern void
+capture_read_backlog(capture_session *cap_session);
+
 struct if_stat_cache_s;
 typedef struct if_stat_cache_s if_stat_cache_t;
 
@@ -0,0 +1,110 @@
+/* tap-memory.c
+ * Report memory usage at the end of a tshark run
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/app_mem_usage.h>
+
+void register_tap_listener_memory(void);
+
+static int
+memory_packet(void *pms _U_, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *pmi _U_)
+{
+	return 0;
+}
+
+static void
+memory_draw(void *pms _U_)
+{
+	wmem_allocator_stats_t stats;
+	const char *name;
+	gsize value;
+	guint i;
+
+	printf("\n");
+	printf("===================================================================\n");
+	printf("Memory Usage:\n");
+	for (i = 0; (name = memory_usage_get(i, &value)) != NULL; i++)
+		printf("%-20s %20" G_GSIZE_FORMAT " bytes\n", name, value);
+
+	printf("\n");
+	printf("%-15s %14s %16s %9s %7s %16s\n",
+	       "wmem scope", "Allocations", "Requested bytes", "Free-alls", "Chunks", "Chunk bytes");
+	for (i = 0; (name = memory_usage_get_scope_stats(i, &stats)) != NULL; i++) {
+		printf("%-15s %14" G_GUINT64_FORMAT " %16" G_GUINT64_FORMAT " %9" G_GUINT64_FORMAT
+		       " %7" G_GSIZE_FORMAT " %16" G_GSIZE_FORMAT "\n",
+		       name, stats.alloc_count, stats.alloc_bytes, stats.free_all_count,
+		       stats.chunk_count, stats.chunk_bytes);
+	}
+	printf("===================================================================\n");
+}
+
+static void
+memory_init(const char *opt_arg _U_, void *userdata _U_)
+{
+	GString *error_string;
+
+	/* Nothing is collected per packet; the report is printed when drawing. */
+	error_string = register_tap_listener("frame", NULL, NULL, TL_REQUIRES_NOTHING, NULL, memory_packet, memory_draw);
+	if (error_string) {
+		fprintf(stderr, "tshark: Couldn't register memory tap: %s\n",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+}
+
+static stat_tap_ui memory_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"memory",
+	memory_init,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_memory(void)
+{
+	register_stat_tap_ui(&memory_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -1766,6 +1766,16 @@ main_cf_callback(gint event, gpointer data, gpointer user_data _U_)
 }
 
 #ifdef HAVE_LIBPCAP
+static guint capture_backlog_id;
+
+static gboolean
+main_capture_read_backlog(gpointer data)
+{
+    capture_backlog_id = 0;
+    capture_read_backlog((capture_session *)data);
+    return FALSE;
+}
+
 static void
 main_capture_callback(gint event, capture_session *cap_session, gpointer user_data _U_)
 {
@@ -1791,6 +1801,10 @@ main_capture_callback(gint event, capture_session *cap_session, gpointer user_da
         break;
     case(capture_cb_capture_update_continue):
         /*g_log(LOG_DOMAIN_MAIN, G_LOG_LEVEL_DEBUG, "Callback: capture update continue");*/
+        /* Come back for the records cf_continue_tail() didn't get to
+           once pending events have been handled. */
+        if (cf_tail_backlog((capture_file *)cap_session->cf) > 0 && capture_backlog_id == 0)
+            capture_backlog_id = g_idle_add(main_capture_read_backlog, cap_session);
         break;
     case(capture_cb_capture_update_finished):
         g_log(LOG_DOMAIN_MAIN, G_LOG_LEVEL_DEBUG, "Callback: capture update finished");
@@ -97,7 +97,7 @@ BluetoothAttServerAttributesDialog::BluetoothAttServerAttributesDialog(QWidget &
                         NULL
                         );
 
-    cap_file_.retapPackets();
+    cap_file_.delayedRetapPackets();
 }
 
 
@@ -310,19 +310,22 @@ gboolean BluetoothAttServerAttributesDialog::tapPacket(void *tapinfo_ptr, packet
 
 void BluetoothAttServerAttributesDialog::interfaceCurrentIndexChanged(int)
 {
-    cap_file_.retapPackets();
+    mark_tap_listener_for_retap(&tapinfo_);
+    cap_file_.delayedRetapPackets();
 }
 
 
 void BluetoothAttServerAttributesDialog::deviceCurrentIndexChanged(int)
 {
-    cap_file_.retapPackets();
+    mark_tap_listener_for_retap(&tapinfo_);
+    cap_file_.delayedRetapPackets();
 }
 
 
 void BluetoothAttServerAttributesDialog::removeDuplicatesStateChanged(int)
 {
-    cap_file_.retapPackets();
+    mark_tap_listener_for_retap(&tapinfo_);
+    cap_file_.delayedRetapPackets();
 }
 
 
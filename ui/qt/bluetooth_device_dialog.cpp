@@ -160,7 +160,7 @@ BluetoothDeviceDialog::BluetoothDeviceDialog(QWidget &parent, CaptureFile &cf, Q
 
     bluetooth_devices_tap(&tapinfo_);
 
-    cap_file_.retapPackets();
+    cap_file_.delayedRetapPackets();
 }
 
 
@@ -636,12 +636,14 @@ gboolean BluetoothDeviceDialog::tapPacket(void *tapinfo_ptr, packet_info *pinfo,
 
 void BluetoothDeviceDialog::interfaceCurrentIndexChanged(int)
 {
-    cap_file_.retapPackets();
+    mark_tap_listener_for_retap(&tapinfo_);
+    cap_file_.delayedRetapPackets();
 }
 
 void BluetoothDeviceDialog::showInformationStepsChanged(int)
 {
-    cap_file_.retapPackets();
+    mark_tap_listener_for_retap(&tapinfo_);
+    cap_file_.delayedRetapPackets();
 }
 
 
@@ -39,6 +39,10 @@
 #include <QPainter>
 #include <QScrollBar>
 
+#include <algorithm>
+#include <queue>
+#include <vector>
+
 // To do:
 // - Add recent settings and context menu items to show/hide the offset,
 //   and ASCII/EBCDIC.
@@ -73,7 +77,8 @@ ByteViewText::ByteViewText(QWidget *parent, tvbuff_t *tvb, proto_tree *tree, QTr
     one_em_(0),
     font_width_(0),
     line_spacing_(0),
-    margin_(0)
+    margin_(0),
+    field_index_built_(false)
 {
     QAction *action;
 
@@ -353,7 +358,10 @@ void ByteViewText::drawOffsetLine(QPainter &painter, const guint offset, const i
     }
     guint tvb_len = tvb_captured_length(tvb_);
     guint max_pos = qMin(offset + row_width_, tvb_len);
-    const guint8 *pd = tvb_get_ptr(tvb_, 0, -1);
+    // Copy out just this line. tvb_get_ptr on the whole data source would
+    // flatten a composite (reassembled) buffer.
+    guint8 pd[16]; // row_width_ is at most 16
+    tvb_memcpy(tvb_, pd, offset, max_pos - offset);
 
     static const guchar hexchars[16] = {
         '0', '1', '2', '3', '4', '5', '6', '7',
@@ -399,13 +407,13 @@ void ByteViewText::drawOffsetLine(QPainter &painter, const guint offset, const i
 
             switch (recent.gui_bytes_view) {
             case BYTES_HEX:
-                text += hexchars[(pd[tvb_pos] & 0xf0) >> 4];
-                text += hexchars[pd[tvb_pos] & 0x0f];
+                text += hexchars[(pd[tvb_pos - offset] & 0xf0) >> 4];
+                text += hexchars[pd[tvb_pos - offset] & 0x0f];
                 break;
             case BYTES_BITS:
                 /* XXX, bitmask */
                 for (int j = 7; j >= 0; j--)
-                    text += (pd[tvb_pos] & (1 << j)) ? '1' : '0';
+                    text += (pd[tvb_pos - offset] & (1 << j)) ? '1' : '0';
                 break;
             }
             if (draw_hover) {
@@ -450,8 +458,8 @@ void ByteViewText::drawOffsetLine(QPainter &painter, const guint offset, const i
             }
 
             guchar c = (encoding_ == PACKET_CHAR_ENC_CHAR_EBCDIC) ?
-                        EBCDIC_to_ASCII1(pd[tvb_pos]) :
-                        pd[tvb_pos];
+                        EBCDIC_to_ASCII1(pd[tvb_pos - offset]) :
+                        pd[tvb_pos - offset];
 
             text += g_ascii_isprint(c) ? c : '.';
             if (highlight_text) {
@@ -599,13 +607,117 @@ int ByteViewText::byteOffsetAtPixel(QPoint &pos)
     return byte;
 }
 
+typedef struct {
+    guint start;
+    guint end;
+    guint order;    // Pre-order position in the tree
+    field_info *fi;
+} field_span_t;
+
+// Later fields in pre-order win, as in proto_find_field_from_offset.
+struct FieldSpanOrderLess {
+    bool operator()(const field_span_t &a, const field_span_t &b) const { return a.order < b.order; }
+};
+
+static bool fieldSpanStartLessThan(const field_span_t &a, const field_span_t &b)
+{
+    return a.start < b.start;
+}
+
+typedef struct {
+    tvbuff_t *tvb;
+    std::vector<field_span_t> spans;
+} field_span_collect_t;
+
+static gboolean collectFieldSpan(proto_node *node, gpointer data)
+{
+    field_info *fi = PNODE_FINFO(node);
+    field_span_collect_t *collect = (field_span_collect_t *)data;
+
+    // Same criteria as check_for_offset in epan/proto.c
+    if (fi && !PROTO_ITEM_IS_HIDDEN(node) && !PROTO_ITEM_IS_GENERATED(node) && fi->ds_tvb && collect->tvb == fi->ds_tvb
+            && fi->start >= 0 && fi->length > 0) {
+        field_span_t span;
+        span.start = fi->start;
+        span.end = (guint) fi->start + fi->length;
+        span.order = (guint) collect->spans.size();
+        span.fi = fi;
+        collect->spans.push_back(span);
+    }
+    return FALSE; // Keep traversing
+}
+
+// Split the data source into runs of bytes covered by the same field,
+// which is the one proto_find_field_from_offset would return for them.
+// Traversing the tree on every mouse move gets slow for large
+// reassembled data sources with many fields.
+void ByteViewText::buildFieldIndex()
+{
+    field_index_built_ = true;
+    field_index_starts_.clear();
+    field_index_fields_.clear();
+
+    if (!tvb_ || !proto_tree_) {
+        return;
+    }
+
+    field_span_collect_t collect;
+    collect.tvb = tvb_;
+    proto_tree_traverse_pre_order(proto_tree_, collectFieldSpan, &collect);
+
+    std::vector<guint> bounds;
+    bounds.reserve(collect.spans.size() * 2);
+    for (size_t i = 0; i < collect.spans.size(); i++) {
+        bounds.push_back(collect.spans[i].start);
+        bounds.push_back(collect.spans[i].end);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    std::stable_sort(collect.spans.begin(), collect.spans.end(), fieldSpanStartLessThan);
+
+    // Sweep over the boundaries, keeping the fields covering the current
+    // one in a heap ordered by their position in the tree. Fields which
+    // have ended are only dropped once they reach the top.
+    std::priority_queue<field_span_t, std::vector<field_span_t>, FieldSpanOrderLess> covering;
+    size_t next_span = 0;
+    for (size_t i = 0; i < bounds.size(); i++) {
+        guint bound = bounds[i];
+
+        while (next_span < collect.spans.size() && collect.spans[next_span].start <= bound) {
+            covering.push(collect.spans[next_span++]);
+        }
+        while (!covering.empty() && covering.top().end <= bound) {
+            covering.pop();
+        }
+
+        field_info *fi = covering.empty() ? NULL : covering.top().fi;
+        if (field_index_fields_.isEmpty() || field_index_fields_.last() != fi) {
+            field_index_starts_.append(bound);
+            field_index_fields_.append(fi);
+        }
+    }
+}
+
+field_info *ByteViewText::fieldAtOffset(guint offset)
+{
+    if (!field_index_built_) {
+        buildFieldIndex();
+    }
+
+    QVector<guint>::const_iterator run = std::upper_bound(field_index_starts_.constBegin(), field_index_starts_.constEnd(), offset);
+    if (run == field_index_starts_.constBegin()) {
+        return NULL;
+    }
+    return field_index_fields_.at(run - field_index_starts_.constBegin() - 1);
+}
+
 field_info *ByteViewText::fieldAtPixel(QPoint &pos)
 {
     int byte = byteOffsetAtPixel(pos);
     if (byte < 0) {
         return NULL;
     }
-    return proto_find_field_from_offset(proto_tree_, byte, tvb_);
+    return fieldAtOffset(byte);
 }
 
 void ByteViewText::setHexDisplayFormat(QAction *action)
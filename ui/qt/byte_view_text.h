@@ -33,6 +33,7 @@
 
 #include <QAbstractScrollArea>
 #include <QMenu>
+#include <QVector>
 
 class QActionGroup;
 
@@ -90,6 +91,8 @@ private:
     int totalPixels();
     void updateScrollbars();
     int byteOffsetAtPixel(QPoint &pos);
+    void buildFieldIndex();
+    field_info *fieldAtOffset(guint offset);
     field_info *fieldAtPixel(QPoint &pos);
 
     static const int separator_interval_;
@@ -133,6 +136,13 @@ private:
     // Data selection
     QMap<int,int> x_pos_to_column_;
 
+    // Field lookup. The bytes of the data source are split into runs
+    // covered by the same field; field_index_fields_[i] is the field
+    // for the run starting at field_index_starts_[i].
+    bool field_index_built_;
+    QVector<guint> field_index_starts_;
+    QVector<field_info *> field_index_fields_;
+
 private slots:
     void setHexDisplayFormat(QAction *action);
     void setCharacterEncoding(QAction *action);
@@ -34,6 +34,7 @@ capture_file cfile;
 #include "log.h"
 
 #include "epan/epan_dissect.h"
+#include "epan/tap.h"
 
 #include "ui/capture.h"
 
@@ -53,7 +54,9 @@ CaptureFile::CaptureFile(QObject *parent, capture_file *cap_file) :
     QObject(parent),
     cap_file_(cap_file),
     file_name_(no_capture_file_),
-    file_state_(QString())
+    file_state_(QString()),
+    retap_pending_(false),
+    retapping_(false)
 {
 #ifdef HAVE_LIBPCAP
     capture_callback_add(captureCallback, (gpointer) this);
@@ -116,7 +119,32 @@ void CaptureFile::retapPackets()
 
 void CaptureFile::delayedRetapPackets()
 {
-    QTimer::singleShot(0, this, SLOT(retapPackets()));
+    // Coalesce the requests made until the retap runs. If a retap is in
+    // progress we're being called from its event processing; the next one
+    // is scheduled when it finishes.
+    if (retap_pending_) return;
+    retap_pending_ = true;
+    if (!retapping_) {
+        QTimer::singleShot(0, this, SLOT(runDelayedRetap()));
+    }
+}
+
+void CaptureFile::retapMarkedPackets()
+{
+    if (cap_file_) {
+        cf_retap_marked_packets(cap_file_);
+    }
+}
+
+void CaptureFile::runDelayedRetap()
+{
+    if (!retap_pending_ || retapping_) return;
+    retap_pending_ = false;
+
+    // Nothing to do if a full retap has run in the meantime.
+    if (cap_file_ && have_tap_listeners_marked_for_retap()) {
+        cf_retap_marked_packets(cap_file_);
+    }
 }
 
 void CaptureFile::reload()
@@ -177,6 +205,7 @@ void CaptureFile::captureFileEvent(int event, gpointer data)
     case(cf_cb_file_closing):
         g_log(LOG_DOMAIN_MAIN, G_LOG_LEVEL_DEBUG, "Callback: Closing");
         file_state_ = tr(" [closing]");
+        retap_pending_ = false;
         emit captureFileClosing();
         break;
     case(cf_cb_file_closed):
@@ -213,6 +242,7 @@ void CaptureFile::captureFileEvent(int event, gpointer data)
         break;
     case(cf_cb_file_retap_started):
         g_log(LOG_DOMAIN_MAIN, G_LOG_LEVEL_DEBUG, "Callback: Retap started");
+        retapping_ = true;
         emit captureFileRetapStarted();
         break;
     case(cf_cb_file_retap_finished):
@@ -220,6 +250,10 @@ void CaptureFile::captureFileEvent(int event, gpointer data)
         /* Flush any pending tapped packet before emitting captureFileRetapFinished() */
         emit captureFileFlushTapsData();
         emit captureFileRetapFinished();
+        retapping_ = false;
+        if (retap_pending_) {
+            QTimer::singleShot(0, this, SLOT(runDelayedRetap()));
+        }
         break;
     case(cf_cb_file_merge_started):
         g_log(LOG_DOMAIN_MAIN, G_LOG_LEVEL_DEBUG, "Callback: Merge started");
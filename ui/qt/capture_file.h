@@ -127,10 +127,22 @@ public slots:
      */
     void retapPackets();
 
+    /** Retap the capture file, running only the tap listeners registered or
+     * refiltered since they were last retapped (see
+     * mark_tap_listener_for_retap). Use this instead of retapPackets when the
+     * other tap listeners' data is still valid.
+     */
+    void retapMarkedPackets();
+
     /** Retap the capture file after the current batch of application events
      * is processed. If you call this instead of retapPackets or
      * cf_retap_packets in a dialog's constructor it will be displayed before
      * tapping starts.
+     *
+     * Requests made before the retap starts are handled by a single pass,
+     * which only runs the tap listeners registered or refiltered since they
+     * were last retapped (see mark_tap_listener_for_retap). Pending requests
+     * are dropped when the file is closed.
      */
     void delayedRetapPackets();
 
@@ -144,6 +156,9 @@ public slots:
      */
     void setCaptureStopFlag(bool stop_flag = true);
 
+private slots:
+    void runDelayedRetap();
+
 private:
     static void captureFileCallback(gint event, gpointer data, gpointer user_data);
 #ifdef HAVE_LIBPCAP
@@ -159,6 +174,8 @@ private:
     capture_file *cap_file_;
     QString file_name_;
     QString file_state_;
+    bool retap_pending_;
+    bool retapping_;
 };
 
 #endif // CAPTURE_FILE_H
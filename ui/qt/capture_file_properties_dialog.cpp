@@ -24,6 +24,7 @@
 #include "capture_file_properties_dialog.h"
 #include <ui_capture_file_properties_dialog.h>
 
+#include "file.h"
 #include "summary.h"
 
 #include "wsutil/str_util.h"
@@ -199,6 +200,24 @@ QString CaptureFilePropertiesDialog::summaryToHtml()
             << table_row_end;
     }
 
+    if (!file_closed_) {
+        cf_record_cache_stats_t cache_stats;
+
+        cf_get_record_cache_stats(cap_file_.capFile(), &cache_stats);
+        if (cache_stats.hits + cache_stats.misses > 0) {
+            QString cache_str = tr("%1 hits, %2 reads, %3 read ahead (%4 records, %5)")
+                    .arg(cache_stats.hits)
+                    .arg(cache_stats.misses)
+                    .arg(cache_stats.read_ahead)
+                    .arg(cache_stats.entries)
+                    .arg(file_size_to_qstring(cache_stats.bytes));
+            out << table_row_begin
+                << table_vheader_tmpl.arg(tr("Record cache"))
+                << table_data_tmpl.arg(cache_str)
+                << table_row_end;
+        }
+    }
+
     out << table_end;
 
     // Time Section
@@ -320,7 +320,7 @@ void ExpertInfoDialog::retapPackets()
         }
     }
 
-    cap_file_.retapPackets();
+    cap_file_.delayedRetapPackets();
 }
 
 void ExpertInfoDialog::retapStarted()
@@ -795,7 +795,7 @@ void LteMacStatisticsDialog::fillTree()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.retapMarkedPackets();
     tapDraw(this);
     removeTapListeners();
 }
@@ -853,7 +853,7 @@ void LteRlcStatisticsDialog::fillTree()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.retapMarkedPackets();
     tapDraw(this);
     removeTapListeners();
 
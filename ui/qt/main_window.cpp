@@ -268,6 +268,7 @@ MainWindow::MainWindow(QWidget *parent) :
 #ifdef HAVE_LIBPCAP
     , capture_interfaces_dialog_(NULL)
     , info_data_()
+    , capture_backlog_pending_(false)
 #endif
 #ifdef _WIN32
     , pipe_timer_(NULL)
@@ -500,6 +501,8 @@ MainWindow::MainWindow(QWidget *parent) :
             this, SLOT(captureCaptureFailed(capture_session *)));
     connect(&capture_file_, SIGNAL(captureCaptureUpdateContinue(capture_session*)),
             main_ui_->statusBar, SLOT(updateCaptureStatistics(capture_session*)));
+    connect(&capture_file_, SIGNAL(captureCaptureUpdateContinue(capture_session*)),
+            this, SLOT(captureCaptureUpdateContinue(capture_session*)));
 
     connect(&capture_file_, SIGNAL(captureCaptureUpdateStarted(capture_session *)),
             wsApp, SLOT(captureStarted()));
@@ -175,6 +175,7 @@ private:
     capture_session cap_session_;
     CaptureInterfacesDialog *capture_interfaces_dialog_;
     info_data_t info_data_;
+    bool capture_backlog_pending_;
 #endif
 
     // Pipe input
@@ -278,6 +279,7 @@ public slots:
 
     void captureCapturePrepared(capture_session *);
     void captureCaptureUpdateStarted(capture_session *);
+    void captureCaptureUpdateContinue(capture_session *);
     void captureCaptureUpdateFinished(capture_session *);
     void captureCaptureFixedStarted(capture_session *);
     void captureCaptureFixedFinished(capture_session *cap_session);
@@ -308,6 +310,8 @@ public slots:
 private slots:
     // Manually connected slots (no "on_<object>_<signal>").
 
+    void captureReadBacklog();
+
     void initViewColorizeMenu();
     void initConversationMenus();
     static gboolean addExportObjectsMenuItem(const void *key, void *value, void *userdata);
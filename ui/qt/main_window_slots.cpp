@@ -173,6 +173,7 @@ DIAG_ON(frame-larger-than=)
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QMetaObject>
+#include <QTimer>
 #include <QToolBar>
 #include <QDesktopServices>
 #include <QUrl>
@@ -690,6 +691,28 @@ void MainWindow::captureCaptureUpdateStarted(capture_session *session) {
     Q_UNUSED(session)
 #endif // HAVE_LIBPCAP
 }
+
+void MainWindow::captureCaptureUpdateContinue(capture_session *session) {
+#ifdef HAVE_LIBPCAP
+    // cf_continue_tail() may have stopped early to keep us responsive.
+    // Come back for the rest once pending events have been handled
+    // instead of waiting for the capture child to report more packets.
+    if (cf_tail_backlog((capture_file *)session->cf) > 0 && !capture_backlog_pending_) {
+        capture_backlog_pending_ = true;
+        QTimer::singleShot(0, this, SLOT(captureReadBacklog()));
+    }
+#else
+    Q_UNUSED(session)
+#endif // HAVE_LIBPCAP
+}
+
+void MainWindow::captureReadBacklog() {
+#ifdef HAVE_LIBPCAP
+    capture_backlog_pending_ = false;
+    capture_read_backlog(&cap_session_);
+#endif // HAVE_LIBPCAP
+}
+
 void MainWindow::captureCaptureUpdateFinished(capture_session *) {
 #ifdef HAVE_LIBPCAP
 
@@ -260,7 +260,7 @@ void ResponseTimeDelayDialog::fillTree()
 
     statsTreeWidget()->setSortingEnabled(false);
 
-    cap_file_.retapPackets();
+    cap_file_.retapMarkedPackets();
 
     tapDraw(&rtd_data);
 
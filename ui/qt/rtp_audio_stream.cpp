@@ -177,6 +177,8 @@ static const int sample_bytes_ = sizeof(SAMPLE) / sizeof(char);
  * XXX - is there a better thing to do here?
  */
 static const int max_silence_samples_ = MAX_SILENCE_FRAMES;
+// Number of packets decoded at once into decoded_samples.
+static const int decode_chunk_packets_ = 1024;
 void RtpAudioStream::decode()
 {
     if (rtp_packets_.size() < 1) return;
@@ -189,7 +191,6 @@ void RtpAudioStream::decode()
     spx_uint32_t cur_in_rate = 0, visual_out_rate = 0;
     char *write_buff = NULL;
     qint64 write_bytes = 0;
-    unsigned channels = 0;
     unsigned sample_rate = 0;
     int last_sequence = 0;
 
@@ -202,11 +203,20 @@ void RtpAudioStream::decode()
 
     size_t decoded_bytes_prev = 0;
 
+    GByteArray *decoded_samples = g_byte_array_new();
+    QVector<rtp_decoded_t> decoded(decode_chunk_packets_);
+
     for (int cur_packet = 0; cur_packet < rtp_packets_.size(); cur_packet++) {
-        SAMPLE *decode_buff = NULL;
         // XXX The GTK+ UI updates a progress bar here.
         rtp_packet_t *rtp_packet = rtp_packets_[cur_packet];
 
+        if (cur_packet % decode_chunk_packets_ == 0) {
+            // Decode the next chunk of packets, reusing the sample buffer.
+            int chunk_packets = qMin(decode_chunk_packets_, rtp_packets_.size() - cur_packet);
+            g_byte_array_set_size(decoded_samples, 0);
+            decode_rtp_packets(rtp_packets_.data() + cur_packet, chunk_packets, decoders_hash_, decoded_samples, decoded.data());
+        }
+
         stop_rel_time_ = start_rel_time_ + rtp_packet->arrive_offset;
         speex_resampler_get_rate(visual_resampler_, &cur_in_rate, &visual_out_rate);
 
@@ -227,7 +237,12 @@ void RtpAudioStream::decode()
             last_sequence = rtp_packet->info->info_seq_num - 1;
         }
 
-        size_t decoded_bytes = decode_rtp_packet(rtp_packet, &decode_buff, decoders_hash_, &channels, &sample_rate);
+        const rtp_decoded_t *packet_decoded = &decoded[cur_packet % decode_chunk_packets_];
+        SAMPLE *decode_buff = (SAMPLE *) (decoded_samples->data + packet_decoded->offset);
+        size_t decoded_bytes = packet_decoded->len;
+        if (packet_decoded->sample_rate) {
+            sample_rate = packet_decoded->sample_rate;
+        }
 
         unsigned rtp_clock_rate = sample_rate;
         if (rtp_packet->info->info_payload_type == PT_G722) {
@@ -238,7 +253,6 @@ void RtpAudioStream::decode()
         if (decoded_bytes == 0 || sample_rate == 0) {
             // We didn't decode anything. Clean up and prep for the next packet.
             last_sequence = rtp_packet->info->info_seq_num;
-            g_free(decode_buff);
             continue;
         }
 
@@ -400,10 +414,8 @@ void RtpAudioStream::decode()
             if (qAbs(resample_buff[i]) > max_sample_val_) max_sample_val_ = qAbs(resample_buff[i]);
             visual_samples_.append(resample_buff[i]);
         }
-
-        // Finally, write the resampled audio to our temp file and clean up.
-        g_free(decode_buff);
     }
+    g_byte_array_free(decoded_samples, TRUE);
     g_free(resample_buff);
 }
 
@@ -277,7 +277,7 @@ void SimpleStatisticsDialog::fillTree()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.retapMarkedPackets();
 
     // We only have one table. Move its tree items up one level.
     if (statsTreeWidget()->invisibleRootItem()->childCount() == 1) {
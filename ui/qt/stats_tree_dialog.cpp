@@ -149,7 +149,7 @@ void StatsTreeDialog::fillTree()
         return;
     }
 
-    cap_file_.retapPackets();
+    cap_file_.retapMarkedPackets();
     drawTreeItems(st_);
 
     statsTreeWidget()->setSortingEnabled(true);
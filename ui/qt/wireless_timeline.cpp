@@ -111,6 +111,100 @@ static void accumulate_rgb(float rgb[TIMELINE_HEIGHT][3], int height, int dfilte
     }
 }
 
+/* output the anti-aliased pixel left over from the previous packet, unless
+ * the next one starts in it too */
+static void flush_pixels(QPainter &p, int &last_x, float x, float rgb[TIMELINE_HEIGHT][3], float ratio)
+{
+    if (last_x >= 0 && ((int) x) != last_x) {
+        render_pixels(p, last_x, 1, rgb, ratio);
+        last_x = -1;
+    }
+}
+
+static void render_span(QPainter &p, int &last_x, float x, float width, guint height, int dfilter, float red, float green, float blue, float rgb[TIMELINE_HEIGHT][3], float ratio)
+{
+    /* does this rectangle fit within one pixel? */
+    if (((int) x) == ((int) (x+width))) {
+        /* accumulate it for later rendering together
+         * with all other sub pixels that fall within this
+         * pixel */
+        last_x = x;
+        accumulate_rgb(rgb, height, dfilter, width, red, green, blue);
+    } else {
+        /* it spans more than 1 pixel.
+         * first accumulate the part that does fit */
+        float partial = ((int) x) + 1 - x;
+        accumulate_rgb(rgb, height, dfilter, partial, red, green, blue);
+        /* and render it */
+        render_pixels(p, (int) x, 1, rgb, ratio);
+        last_x = -1;
+        x += partial;
+        width -= partial;
+        /* are there any whole pixels of width left to draw? */
+        if (width > 1.0) {
+            render_rectangle(p, x, width, height, dfilter, red, green, blue, ratio);
+            x += (int) width;
+            width -= (int) width;
+        }
+        /* is there a partial pixel left */
+        if (width > 0.0) {
+            last_x = x;
+            accumulate_rgb(rgb, height, dfilter, width, red, green, blue);
+        }
+    }
+}
+
+static guint packet_height(struct wlan_radio *ri)
+{
+    gint8 rssi = ri->aggregate ? ri->aggregate->rssi : ri->rssi;
+    guint height = (rssi+100)/2;
+
+    /* leave a margin above the packets so the selected packet can be seen */
+    if (height > TIMELINE_HEIGHT/2-6)
+        height = TIMELINE_HEIGHT/2-6;
+
+    /* ensure shortest packets are clearly visible */
+    if (height < 2)
+        height = 2;
+
+    return height;
+}
+
+static void packet_color(frame_data *fdata, float *red, float *green, float *blue)
+{
+    if (fdata->color_filter) {
+        const color_t *c = &((color_filter_t *) fdata->color_filter)->fg_color;
+        *red = c->red / 65535.0;
+        *green = c->green / 65535.0;
+        *blue = c->blue / 65535.0;
+    } else {
+        *red = *green = *blue = 0.0;
+    }
+}
+
+static void merge_span(struct timeline_span *span, const struct timeline_span *other)
+{
+    if (other->start_tsf == 0)
+        return;
+
+    if (span->start_tsf == 0) {
+        *span = *other;
+        return;
+    }
+
+    if (other->start_tsf < span->start_tsf)
+        span->start_tsf = other->start_tsf;
+    if (other->end_tsf > span->end_tsf)
+        span->end_tsf = other->end_tsf;
+    span->airtime += other->airtime;
+    if (other->packet_airtime > span->packet_airtime) {
+        span->packet = other->packet;
+        span->packet_airtime = other->packet_airtime;
+    }
+    if (other->height > span->height)
+        span->height = other->height;
+}
+
 
 void WirelessTimeline::mousePressEvent(QMouseEvent *event)
 {
@@ -242,7 +336,7 @@ void WirelessTimeline::captureFileReadStarted(capture_file *cf)
 void WirelessTimeline::captureFileReadFinished()
 {
     /* All frames must be included in packet list */
-    if (cfile.count == 0 || g_hash_table_size(radio_packet_list) != cfile.count)
+    if (cfile.count == 0 || radio_packet_count != cfile.count)
         return;
 
     /* check that all frames have start and end tsf time and are reasonable time order.
@@ -257,21 +351,21 @@ void WirelessTimeline::captureFileReadFinished()
      */
     /* TODO: update GUI to handle captures with occasional frames missing TSF data */
     /* TODO: indicate error message to the user */
-    for (guint32 n = 1; n < cfile.count; n++) {
-        struct wlan_radio *w = get_wlan_radio(n);
-        if (w->start_tsf == 0 || w->end_tsf == 0) {
-            statusbar_push_temporary_msg("Packet number %u does not include TSF timestamp, not showing timeline.", n);
-            return;
-        }
-        if (w->ifs < -15000) {
-            statusbar_push_temporary_msg("Packet number %u has large negative jump in TSF, not showing timeline. Perhaps TSF reference point is set wrong?", n);
-            return;
-        }
+    /* The packets were checked as they were tapped; the last one is exempt. */
+    if (missing_tsf_packet > 0 && missing_tsf_packet < cfile.count) {
+        statusbar_push_temporary_msg("Packet number %u does not include TSF timestamp, not showing timeline.", missing_tsf_packet);
+        return;
+    }
+    if (negative_ifs_packet > 0 && negative_ifs_packet < cfile.count) {
+        statusbar_push_temporary_msg("Packet number %u has large negative jump in TSF, not showing timeline. Perhaps TSF reference point is set wrong?", negative_ifs_packet);
+        return;
     }
 
     first = get_wlan_radio(1);
     last = get_wlan_radio(cfile.count);
 
+    build_tsf_summary();
+
     start_tsf = first->start_tsf;
     end_tsf = last->end_tsf;
 
@@ -315,7 +409,9 @@ WirelessTimeline::WirelessTimeline(QWidget *parent) : QWidget(parent)
     first_packet = 1;
     setMouseTracking(true);
 
-    radio_packet_list = NULL;
+    radio_packet_count = 0;
+    missing_tsf_packet = 0;
+    negative_ifs_packet = 0;
     connect(wsApp, SIGNAL(appInitialized()), this, SLOT(appInitialized()));
 }
 
@@ -328,13 +424,13 @@ void WirelessTimeline::tap_timeline_reset(void* tapdata)
 {
     WirelessTimeline* timeline = (WirelessTimeline*)tapdata;
 
-    if (timeline->radio_packet_list != NULL)
-    {
-        g_hash_table_destroy(timeline->radio_packet_list);
-    }
+    timeline->radio_packets.clear();
+    timeline->tsf_index.clear();
+    timeline->tsf_summary.clear();
+    timeline->radio_packet_count = 0;
+    timeline->missing_tsf_packet = 0;
+    timeline->negative_ifs_packet = 0;
     timeline->hide();
-
-    timeline->radio_packet_list = g_hash_table_new(g_direct_hash, g_direct_equal);
 }
 
 gboolean WirelessTimeline::tap_timeline_packet(void *tapdata, packet_info* pinfo, epan_dissect_t* edt _U_, const void *data)
@@ -342,14 +438,75 @@ gboolean WirelessTimeline::tap_timeline_packet(void *tapdata, packet_info* pinfo
     WirelessTimeline* timeline = (WirelessTimeline*)tapdata;
     struct wlan_radio *wlan_radio_info = (struct wlan_radio *)data;
 
-    /* Save the radio information in our own (GUI) hashtable */
-    g_hash_table_insert(timeline->radio_packet_list, GUINT_TO_POINTER(pinfo->num), wlan_radio_info);
+    guint32 num = pinfo->num;
+
+    if (num == 0 || wlan_radio_info == NULL)
+        return FALSE;
+
+    /* Save the radio information and the TSF span in our own (GUI) arrays */
+    if (num > (guint32) timeline->radio_packets.size()) {
+        timeline->radio_packets.resize(num);
+        timeline->tsf_index.resize(num);
+    }
+    if (timeline->radio_packets[num-1] == NULL)
+        timeline->radio_packet_count++;
+    timeline->radio_packets[num-1] = wlan_radio_info;
+    timeline->tsf_index[num-1].start_tsf = wlan_radio_info->start_tsf;
+    timeline->tsf_index[num-1].end_tsf = wlan_radio_info->end_tsf;
+
+    /* check that the packet has start and end tsf time and is in reasonable
+     * time order; see captureFileReadFinished() */
+    if (wlan_radio_info->start_tsf == 0 || wlan_radio_info->end_tsf == 0) {
+        if (timeline->missing_tsf_packet == 0 || num < timeline->missing_tsf_packet)
+            timeline->missing_tsf_packet = num;
+    }
+    if (wlan_radio_info->ifs < -15000) {
+        if (timeline->negative_ifs_packet == 0 || num < timeline->negative_ifs_packet)
+            timeline->negative_ifs_packet = num;
+    }
     return FALSE;
 }
 
 struct wlan_radio* WirelessTimeline::get_wlan_radio(guint32 packet_num)
 {
-    return (struct wlan_radio*)g_hash_table_lookup(radio_packet_list, GUINT_TO_POINTER(packet_num));
+    if (packet_num == 0 || packet_num > (guint32) radio_packets.size())
+        return NULL;
+
+    return radio_packets.at(packet_num-1);
+}
+
+/* Summarize the TSF index so that zoomed out views can be painted without
+ * going through every packet */
+void WirelessTimeline::build_tsf_summary()
+{
+    tsf_summary.clear();
+
+    QVector<struct timeline_span> level((tsf_index.size() + (1 << TIMELINE_SUMMARY_BASE_SHIFT) - 1) >> TIMELINE_SUMMARY_BASE_SHIFT);
+    for (int i = 0; i < tsf_index.size(); i++) {
+        const struct timeline_frame *tf = &tsf_index.at(i);
+        struct wlan_radio *ri = radio_packets.at(i);
+        struct timeline_span span;
+
+        if (ri == NULL || tf->start_tsf == 0 || tf->end_tsf < tf->start_tsf)
+            continue;
+
+        span.start_tsf = tf->start_tsf;
+        span.end_tsf = tf->end_tsf;
+        span.airtime = tf->end_tsf - tf->start_tsf;
+        span.packet = i + 1;
+        span.packet_airtime = (guint32) MIN(span.airtime, G_MAXUINT32);
+        span.height = packet_height(ri);
+        merge_span(&level[i >> TIMELINE_SUMMARY_BASE_SHIFT], &span);
+    }
+    tsf_summary.append(level);
+
+    while (level.size() > 1) {
+        QVector<struct timeline_span> next((level.size() + (1 << TIMELINE_SUMMARY_LEVEL_SHIFT) - 1) >> TIMELINE_SUMMARY_LEVEL_SHIFT);
+        for (int i = 0; i < level.size(); i++)
+            merge_span(&next[i >> TIMELINE_SUMMARY_LEVEL_SHIFT], &level.at(i));
+        tsf_summary.append(next);
+        level = next;
+    }
 }
 
 void WirelessTimeline::doToolTip(struct wlan_radio *wr, QPoint pos, int x)
@@ -433,17 +590,19 @@ void WirelessTimeline::zoom(double x_fraction)
 
 int WirelessTimeline::find_packet_tsf(guint64 tsf)
 {
-    if (cfile.count < 1)
+    guint32 count = tsf_index.size();
+
+    if (count < 1)
         return 0;
 
-    if (cfile.count < 2)
+    if (count < 2)
         return 1;
 
     guint32 min_count = 1;
-    guint32 max_count = cfile.count-1;
+    guint32 max_count = count-1;
 
-    guint64 min_tsf = get_wlan_radio(min_count)->end_tsf;
-    guint64 max_tsf = get_wlan_radio(max_count)->end_tsf;
+    guint64 min_tsf = tsf_index.at(min_count-1).end_tsf;
+    guint64 max_tsf = tsf_index.at(max_count-1).end_tsf;
 
     for (;;) {
         if (tsf >= max_tsf)
@@ -456,7 +615,7 @@ int WirelessTimeline::find_packet_tsf(guint64 tsf)
         if (middle == min_count)
             return middle+1;
 
-        guint64 middle_tsf = get_wlan_radio(middle)->end_tsf;
+        guint64 middle_tsf = tsf_index.at(middle-1).end_tsf;
 
         if (tsf >= middle_tsf) {
             min_count = middle;
@@ -468,6 +627,127 @@ int WirelessTimeline::find_packet_tsf(guint64 tsf)
     };
 }
 
+/* State shared by the packets and runs painted by one paint event */
+struct timeline_paint {
+    QPainter *p;
+    float ratio;
+    double zoom;
+    int left, right;
+    int last_x;     /* pixel being accumulated in rgb, or -1 */
+    float rgb[TIMELINE_HEIGHT][3];
+};
+
+/* Paint a single packet, and its NAV line if nav is set. Returns false
+ * once past the right edge of the window */
+bool WirelessTimeline::paint_packet(struct timeline_paint *tp, guint32 packet, QGraphicsScene *nav)
+{
+    frame_data *fdata = frame_data_sequence_find(cfile.frames, packet);
+    struct wlan_radio *ri = get_wlan_radio(fdata->num);
+    float x, width, red, green, blue;
+
+    if (ri == NULL) return true;
+
+    guint height = packet_height(ri);
+    gint end_nav;
+
+    /* skip frames we don't have start and end data for */
+    /* TODO: show something, so it's clear a frame is missing */
+    if (ri->start_tsf == 0 || ri->end_tsf == 0)
+        return true;
+
+    x = ((gint64) (ri->start_tsf - start_tsf))*tp->zoom;
+    flush_pixels(*tp->p, tp->last_x, x, tp->rgb, tp->ratio);
+
+    /* does this packet start past the right edge of the window? */
+    if (x >= tp->right) {
+        return false;
+    }
+
+    width = (ri->end_tsf - ri->start_tsf)*tp->zoom;
+    if (width < 0) {
+        return true;
+    }
+
+    /* is this packet completely to the left of the displayed area? */
+    // TODO clip NAV line properly if we are displaying it
+    if ((x + width) < tp->left)
+        return true;
+
+    /* remember the first displayed packet */
+    if (first_packet < 0)
+        first_packet = packet;
+
+    packet_color(fdata, &red, &green, &blue);
+
+    /* record NAV field at higher magnifications */
+    end_nav = x + width + ri->nav*tp->zoom;
+    if (nav && tp->zoom >= 0.01 && ri->nav && end_nav > 0) {
+        gint y = 2*(packet % (TIMELINE_HEIGHT/2));
+        nav->addLine(QLineF((x+width)/tp->ratio, y, end_nav/tp->ratio, y), QPen(pcolor(red,green,blue)));
+    }
+
+    render_span(*tp->p, tp->last_x, x, width, height, fdata->flags.passed_dfilter, red, green, blue, tp->rgb, tp->ratio);
+    return true;
+}
+
+/* Paint a run of the TSF summary. A run which falls within one pixel is
+ * drawn as its packets back to back, in the color of the longest one;
+ * otherwise (e.g. a burst followed by a long idle gap) its parts are
+ * painted separately, down to single packets, so that they show up where
+ * they happened. Returns false once past the right edge of the window */
+bool WirelessTimeline::paint_span(struct timeline_paint *tp, int level, int index)
+{
+    const struct timeline_span *span = &tsf_summary.at(level).at(index);
+    float x, width, extent, red, green, blue;
+
+    if (span->start_tsf == 0) return true;
+
+    x = ((gint64) (span->start_tsf - start_tsf))*tp->zoom;
+
+    /* does this run start past the right edge of the window? */
+    if (x >= tp->right) {
+        flush_pixels(*tp->p, tp->last_x, x, tp->rgb, tp->ratio);
+        return false;
+    }
+
+    /* is this run completely to the left of the displayed area? */
+    extent = (span->end_tsf - span->start_tsf)*tp->zoom;
+    if ((x + extent) < tp->left)
+        return true;
+
+    if (((int) x) != ((int) (x + extent))) {
+        if (level > 0) {
+            int first = index << TIMELINE_SUMMARY_LEVEL_SHIFT;
+            int last = MIN(first + (1 << TIMELINE_SUMMARY_LEVEL_SHIFT), tsf_summary.at(level-1).size());
+
+            for (int i = first; i < last; i++) {
+                if (!paint_span(tp, level-1, i))
+                    return false;
+            }
+        } else {
+            guint32 first = (index << TIMELINE_SUMMARY_BASE_SHIFT) + 1;
+            guint32 last = MIN(first + (1 << TIMELINE_SUMMARY_BASE_SHIFT), (guint32) tsf_index.size() + 1);
+
+            for (guint32 packet = first; packet < last; packet++) {
+                if (!paint_packet(tp, packet, NULL))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    flush_pixels(*tp->p, tp->last_x, x, tp->rgb, tp->ratio);
+
+    width = span->airtime*tp->zoom;
+    if (width > extent)
+        width = extent;
+
+    frame_data *fdata = frame_data_sequence_find(cfile.frames, span->packet);
+    packet_color(fdata, &red, &green, &blue);
+    render_span(*tp->p, tp->last_x, x, width, span->height, fdata->flags.passed_dfilter, red, green, blue, tp->rgb, tp->ratio);
+    return true;
+}
+
 void
 WirelessTimeline::paintEvent(QPaintEvent *qpe)
 {
@@ -478,11 +758,8 @@ WirelessTimeline::paintEvent(QPaintEvent *qpe)
 
     unsigned int packet;
     double zoom;
-    int last_x=-1;
     int left = qpe->rect().left()*ratio;
     int right = qpe->rect().right()*ratio;
-    float rgb[TIMELINE_HEIGHT][3];
-    reset_rgb(rgb);
 
     zoom = ((double) width())/(end_tsf - start_tsf) * ratio;
 
@@ -507,102 +784,39 @@ WirelessTimeline::paintEvent(QPaintEvent *qpe)
         }
     }
 
-    QGraphicsScene qs;
-    for (packet = find_packet_tsf(start_tsf + left/zoom - 40000); packet <= cfile.count; packet++) {
-        frame_data *fdata = frame_data_sequence_find(cfile.frames, packet);
-        struct wlan_radio *ri = get_wlan_radio(fdata->num);
-        float x, width, red, green, blue;
-
-        if (ri == NULL) continue;
-
-        gint8 rssi = ri->aggregate ? ri->aggregate->rssi : ri->rssi;
-        guint height = (rssi+100)/2;
-        gint end_nav;
-
-        /* leave a margin above the packets so the selected packet can be seen */
-        if (height > TIMELINE_HEIGHT/2-6)
-            height = TIMELINE_HEIGHT/2-6;
-
-        /* ensure shortest packets are clearly visible */
-        if (height < 2)
-            height = 2;
-
-        /* skip frames we don't have start and end data for */
-        /* TODO: show something, so it's clear a frame is missing */
-        if (ri->start_tsf == 0 || ri->end_tsf == 0)
-            continue;
-
-        x = ((gint64) (ri->start_tsf - start_tsf))*zoom;
-        /* is there a previous anti-aliased pixel to output */
-        if (last_x >= 0 && ((int) x) != last_x) {
-            /* write it out now */
-            render_pixels(p, last_x, 1, rgb, ratio);
-            last_x = -1;
-        }
-
-        /* does this packet start past the right edge of the window? */
-        if (x >= right) {
-            break;
-        }
-
-        width = (ri->end_tsf - ri->start_tsf)*zoom;
-        if (width < 0) {
-            continue;
-        }
+    /* With many packets to a pixel, start from the coarsest level of the
+     * TSF summary with about one run per pixel instead of every packet.
+     * Runs which don't fit within a pixel are painted from their parts */
+    guint first_visible = find_packet_tsf(start_tsf + left/zoom - 40000);
+    guint last_visible = find_packet_tsf(start_tsf + right/zoom);
+    guint64 pixels = right - left + 1;
+    int level = -1;
+    while (level + 1 < tsf_summary.size() && last_visible > first_visible &&
+           last_visible - first_visible >= pixels << (TIMELINE_SUMMARY_BASE_SHIFT + (level + 1) * TIMELINE_SUMMARY_LEVEL_SHIFT))
+        level++;
+
+    struct timeline_paint tp;
+    tp.p = &p;
+    tp.ratio = ratio;
+    tp.zoom = zoom;
+    tp.left = left;
+    tp.right = right;
+    tp.last_x = -1;
+    reset_rgb(tp.rgb);
 
-        /* is this packet completely to the left of the displayed area? */
-        // TODO clip NAV line properly if we are displaying it
-        if ((x + width) < left)
-            continue;
-
-        /* remember the first displayed packet */
-        if (first_packet < 0)
-            first_packet = packet;
-
-        if (fdata->color_filter) {
-            const color_t *c = &((color_filter_t *) fdata->color_filter)->fg_color;
-            red = c->red / 65535.0;
-            green = c->green / 65535.0;
-            blue = c->blue / 65535.0;
-        } else {
-            red = green = blue = 0.0;
-        }
+    QGraphicsScene qs;
+    if (level >= 0 && first_visible > 0) {
+        const QVector<struct timeline_span> &spans = tsf_summary.at(level);
+        int shift = TIMELINE_SUMMARY_BASE_SHIFT + level * TIMELINE_SUMMARY_LEVEL_SHIFT;
 
-        /* record NAV field at higher magnifications */
-        end_nav = x + width + ri->nav*zoom;
-        if (zoom >= 0.01 && ri->nav && end_nav > 0) {
-            gint y = 2*(packet % (TIMELINE_HEIGHT/2));
-            qs.addLine(QLineF((x+width)/ratio, y, end_nav/ratio, y), QPen(pcolor(red,green,blue)));
+        for (int i = (first_visible - 1) >> shift; i < spans.size(); i++) {
+            if (!paint_span(&tp, level, i))
+                break;
         }
-
-        /* does this rectangle fit within one pixel? */
-        if (((int) x) == ((int) (x+width))) {
-            /* accumulate it for later rendering together
-             * with all other sub pixels that fall within this
-             * pixel */
-            last_x = x;
-            accumulate_rgb(rgb, height, fdata->flags.passed_dfilter, width, red, green, blue);
-        } else {
-            /* it spans more than 1 pixel.
-             * first accumulate the part that does fit */
-            float partial = ((int) x) + 1 - x;
-            accumulate_rgb(rgb, height, fdata->flags.passed_dfilter, partial, red, green, blue);
-            /* and render it */
-            render_pixels(p, (int) x, 1, rgb, ratio);
-            last_x = -1;
-            x += partial;
-            width -= partial;
-            /* are there any whole pixels of width left to draw? */
-            if (width > 1.0) {
-                render_rectangle(p, x, width, height, fdata->flags.passed_dfilter, red, green, blue, ratio);
-                x += (int) width;
-                width -= (int) width;
-            }
-            /* is there a partial pixel left */
-            if (width > 0.0) {
-                last_x = x;
-                accumulate_rgb(rgb, height, fdata->flags.passed_dfilter, width, red, green, blue);
-            }
+    } else {
+        for (packet = first_visible; packet <= cfile.count; packet++) {
+            if (!paint_packet(&tp, packet, &qs))
+                break;
         }
     }
 
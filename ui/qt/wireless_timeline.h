@@ -45,6 +45,7 @@
 #include <epan/dissectors/packet-ieee80211-radio.h>
 
 #include <QScrollArea>
+#include <QVector>
 
 #include "cfile.h"
 
@@ -54,8 +55,31 @@
 /* Maximum zoom levels for the timeline */
 #define TIMELINE_MAX_ZOOM 25.0
 
+/* The first level of the TSF summary covers runs of 8 packets, each
+ * further level runs of 4 nodes of the level below */
+#define TIMELINE_SUMMARY_BASE_SHIFT 3
+#define TIMELINE_SUMMARY_LEVEL_SHIFT 2
+
+/* TSF span of a frame in the TSF index */
+struct timeline_frame {
+    guint64 start_tsf;
+    guint64 end_tsf;
+};
+
+/* TSF span of a run of frames in the TSF summary */
+struct timeline_span {
+    guint64 start_tsf;      /* earliest start, 0 if the run is empty */
+    guint64 end_tsf;        /* latest end */
+    guint64 airtime;        /* total duration of the frames */
+    guint32 packet;         /* the longest frame */
+    guint32 packet_airtime; /* and its duration */
+    guint height;           /* height of the tallest frame */
+};
+
 class WirelessTimeline;
 class PacketList;
+class QGraphicsScene;
+struct timeline_paint;
 
 class WirelessTimeline : public QWidget
 {
@@ -86,6 +110,9 @@ protected:
     static gboolean tap_timeline_packet(void *tapdata, packet_info* pinfo, epan_dissect_t* edt, const void *data);
 
     struct wlan_radio* get_wlan_radio(guint32 packet_num);
+    void build_tsf_summary();
+    bool paint_packet(struct timeline_paint *tp, guint32 packet, QGraphicsScene *nav);
+    bool paint_span(struct timeline_paint *tp, int level, int index);
 
     void clip_tsf();
     int position(guint64 tsf, float ratio);
@@ -104,7 +131,15 @@ protected:
     struct wlan_radio *first, *last;
     capture_file *capfile;
 
-    GHashTable* radio_packet_list;
+    /* Radio information, TSF index and TSF summary, indexed by packet
+     * number - 1. Level n of the summary covers the packets in runs of
+     * 1 << (TIMELINE_SUMMARY_BASE_SHIFT + n * TIMELINE_SUMMARY_LEVEL_SHIFT) */
+    QVector<struct wlan_radio *> radio_packets;
+    QVector<struct timeline_frame> tsf_index;
+    QVector<QVector<struct timeline_span> > tsf_summary;
+    guint32 radio_packet_count;
+    guint32 missing_tsf_packet; /* first packet without TSF, or 0 */
+    guint32 negative_ifs_packet; /* first packet with a large negative IFS, or 0 */
 };
 
 #endif // WIRELESS_TIMELINE_H
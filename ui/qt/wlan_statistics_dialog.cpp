@@ -651,7 +651,7 @@ void WlanStatisticsDialog::fillTree()
     }
 
     statsTreeWidget()->setSortingEnabled(false);
-    cap_file_.retapPackets();
+    cap_file_.retapMarkedPackets();
     tapDraw(this);
     removeTapListeners();
     statsTreeWidget()->setSortingEnabled(true);
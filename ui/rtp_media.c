@@ -44,22 +44,15 @@ typedef struct _rtp_decoder_t {
 
 /****************************************************************************/
 /*
- * Return the number of decoded bytes
+ * Return the decoder for the payload type of the packet, creating it if
+ * needed; its handle is NULL if there is no codec for this payload type.
  */
-
-size_t
-decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash, unsigned *channels_ptr, unsigned *sample_rate_ptr)
+static rtp_decoder_t *
+rtp_decoder_lookup(rtp_packet_t *rp, GHashTable *decoders_hash)
 {
     unsigned int  payload_type;
     const gchar *p;
     rtp_decoder_t *decoder;
-    SAMPLE *tmp_buff = NULL;
-    size_t tmp_buff_len;
-    size_t decoded_bytes = 0;
-
-    if ((rp->payload_data == NULL) || (rp->info->info_payload_len == 0) ) {
-        return 0;
-    }
 
     payload_type = rp->info->info_payload_type;
 
@@ -83,6 +76,28 @@ decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash
         }
         g_hash_table_insert(decoders_hash, GUINT_TO_POINTER(payload_type), decoder);
     }
+
+    return decoder;
+}
+
+/****************************************************************************/
+/*
+ * Return the number of decoded bytes
+ */
+
+size_t
+decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash, unsigned *channels_ptr, unsigned *sample_rate_ptr)
+{
+    rtp_decoder_t *decoder;
+    SAMPLE *tmp_buff = NULL;
+    size_t tmp_buff_len;
+    size_t decoded_bytes = 0;
+
+    if ((rp->payload_data == NULL) || (rp->info->info_payload_len == 0) ) {
+        return 0;
+    }
+
+    decoder = rtp_decoder_lookup(rp, decoders_hash);
     if (decoder->handle) {  /* Decode with registered codec */
         tmp_buff_len = codec_decode(decoder->handle, decoder->context, rp->payload_data, rp->info->info_payload_len, NULL, NULL);
         tmp_buff = (SAMPLE *)g_malloc(tmp_buff_len);
@@ -104,6 +119,56 @@ decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash
     return 0;
 }
 
+/****************************************************************************/
+/*
+ * Decode a run of packets, handing consecutive packets with the same
+ * payload type to the codec in one batch. Return the number of decoded bytes
+ */
+
+size_t
+decode_rtp_packets(rtp_packet_t **packets, size_t n_packets, GHashTable *decoders_hash, GByteArray *out_buff, rtp_decoded_t *decoded)
+{
+    codec_payload_t *payloads;
+    size_t decoded_bytes = 0;
+    size_t first, i;
+
+    if (n_packets == 0) {
+        return 0;
+    }
+
+    payloads = g_new(codec_payload_t, n_packets);
+    for (first = 0; first < n_packets; first = i) {
+        rtp_decoder_t *decoder = rtp_decoder_lookup(packets[first], decoders_hash);
+        unsigned channels = 0, sample_rate = 0;
+
+        for (i = first; i < n_packets; i++) {
+            rtp_packet_t *rp = packets[i];
+
+            if (rp->info->info_payload_type != packets[first]->info->info_payload_type)
+                break;
+            payloads[i].data = rp->payload_data;
+            payloads[i].data_len = rp->payload_data ? rp->info->info_payload_len : 0;
+        }
+
+        if (decoder->handle) {
+            decoded_bytes += codec_decode_batch(decoder->handle, decoder->context,
+                    &payloads[first], i - first, out_buff);
+            channels = codec_get_channels(decoder->handle, decoder->context);
+            sample_rate = codec_get_frequency(decoder->handle, decoder->context);
+        }
+
+        for (; first < i; first++) {
+            decoded[first].offset = decoder->handle ? payloads[first].decoded_offset : out_buff->len;
+            decoded[first].len = decoder->handle ? payloads[first].decoded_len : 0;
+            decoded[first].channels = channels;
+            decoded[first].sample_rate = sample_rate;
+        }
+    }
+    g_free(payloads);
+
+    return decoded_bytes;
+}
+
 /****************************************************************************/
 static void
 rtp_decoder_value_destroy(gpointer dec_arg)
@@ -71,6 +71,30 @@ GHashTable *rtp_decoder_hash_table_new(void);
  */
 size_t decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash, unsigned *channels_ptr, unsigned *sample_rate_ptr);
 
+/* Where the samples of a packet ended up after decode_rtp_packets */
+typedef struct _rtp_decoded {
+    size_t offset;          /* offset of the samples in the output buffer, in bytes */
+    size_t len;             /* number of decoded bytes, 0 on failure */
+    unsigned channels;      /* 0 if there is no codec for the packet */
+    unsigned sample_rate;   /* 0 if there is no codec for the packet */
+} rtp_decoded_t;
+
+/** Decode a sequence of RTP packets of a stream into a single buffer.
+ *
+ * Unlike decode_rtp_packet this doesn't allocate a buffer per packet, and
+ * hands runs of packets with the same payload type to the codec at once.
+ *
+ * @param packets The packets to decode, in stream order.
+ * @param n_packets The number of packets.
+ * @param decoders_hash Hash table created with rtp_decoder_hash_table_new.
+ * @param out_buff Buffer the audio samples of all packets are appended to.
+ * It can be reused for the next run of packets.
+ * @param decoded Array of n_packets entries receiving where the samples of
+ * each packet are in out_buff.
+ * @return The total number of decoded bytes.
+ */
+size_t decode_rtp_packets(rtp_packet_t **packets, size_t n_packets, GHashTable *decoders_hash, GByteArray *out_buff, rtp_decoded_t *decoded);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
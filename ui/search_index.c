@@ -0,0 +1,240 @@
+/* search_index.c
+ * Trigram index of frame data for packet searches
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <ui/search_index.h>
+
+/*
+ * Every trigram of the (case folded) frame data is hashed into one of
+ * SEARCH_INDEX_BUCKETS buckets, each holding a posting list of the frames
+ * in which one of its trigrams appears. The frame numbers are stored as
+ * deltas from the previous one in the list, seven bits per byte with the
+ * top bit set on all but the last byte of a delta; consecutive frames thus
+ * take a single byte.
+ */
+#define SEARCH_INDEX_BUCKET_BITS 20
+#define SEARCH_INDEX_BUCKETS     (1 << SEARCH_INDEX_BUCKET_BITS)
+
+typedef struct {
+    guint8  *data;
+    guint32  len;
+    guint32  alloc;
+    guint32  last_frame;    /* The last frame added to the list */
+} posting_list_t;
+
+struct _search_index_t {
+    posting_list_t **buckets;
+    gsize            size;
+};
+
+static inline guint32
+trigram_bucket(guint8 a, guint8 b, guint8 c)
+{
+    guint32 trigram = ((guint32)g_ascii_toupper(a) << 16) |
+                      ((guint32)g_ascii_toupper(b) << 8) |
+                      (guint32)g_ascii_toupper(c);
+
+    /* Fibonacci hashing */
+    return (trigram * 2654435761U) >> (32 - SEARCH_INDEX_BUCKET_BITS);
+}
+
+static void
+posting_list_append(search_index_t *index, posting_list_t *list, guint32 framenum)
+{
+    guint32 delta = framenum - list->last_frame;
+
+    if (list->len + 5 > list->alloc) {
+        guint32 alloc = list->alloc ? list->alloc * 2 : 8;
+
+        list->data = (guint8 *)g_realloc(list->data, alloc);
+        index->size += alloc - list->alloc;
+        list->alloc = alloc;
+    }
+
+    while (delta >= 0x80) {
+        list->data[list->len++] = (guint8)(delta | 0x80);
+        delta >>= 7;
+    }
+    list->data[list->len++] = (guint8)delta;
+    list->last_frame = framenum;
+}
+
+/* Decodes the next frame number of a posting list. */
+static inline guint32
+posting_list_next(const posting_list_t *list, guint32 *offset, guint32 prev)
+{
+    guint32 delta = 0;
+    guint   shift = 0;
+    guint8  byte;
+
+    do {
+        byte = list->data[(*offset)++];
+        delta |= (guint32)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return prev + delta;
+}
+
+search_index_t *
+search_index_new(void)
+{
+    search_index_t *index = g_new(search_index_t, 1);
+
+    index->buckets = g_new0(posting_list_t *, SEARCH_INDEX_BUCKETS);
+    index->size = SEARCH_INDEX_BUCKETS * sizeof(posting_list_t *);
+
+    return index;
+}
+
+void
+search_index_free(search_index_t *index)
+{
+    guint32 i;
+
+    if (!index)
+        return;
+
+    for (i = 0; i < SEARCH_INDEX_BUCKETS; i++) {
+        if (index->buckets[i]) {
+            g_free(index->buckets[i]->data);
+            g_free(index->buckets[i]);
+        }
+    }
+    g_free(index->buckets);
+    g_free(index);
+}
+
+void
+search_index_add_frame(search_index_t *index, guint32 framenum,
+                       const guint8 *pd, guint32 len)
+{
+    posting_list_t *list;
+    guint32 i, bucket;
+
+    for (i = 2; i < len; i++) {
+        bucket = trigram_bucket(pd[i - 2], pd[i - 1], pd[i]);
+        list = index->buckets[bucket];
+        if (list == NULL) {
+            list = g_new0(posting_list_t, 1);
+            index->buckets[bucket] = list;
+            index->size += sizeof(posting_list_t);
+        } else if (list->last_frame == framenum) {
+            continue;
+        }
+        posting_list_append(index, list, framenum);
+    }
+}
+
+static gint
+posting_list_compare_len(gconstpointer a, gconstpointer b)
+{
+    const posting_list_t *la = *(const posting_list_t * const *)a;
+    const posting_list_t *lb = *(const posting_list_t * const *)b;
+
+    return (la->len > lb->len) - (la->len < lb->len);
+}
+
+GArray *
+search_index_candidates(const search_index_t *index,
+                        const guint8 *pattern, size_t len)
+{
+    GPtrArray *lists;
+    GArray    *candidates;
+    posting_list_t *list;
+    guint32    frame, offset, prev;
+    guint      i, j, k;
+    size_t     n;
+
+    if (len < SEARCH_INDEX_MIN_PATTERN_LEN)
+        return NULL;
+
+    candidates = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+    /* Collect the distinct posting lists of the pattern's trigrams. */
+    lists = g_ptr_array_new();
+    for (n = 2; n < len; n++) {
+        list = index->buckets[trigram_bucket(pattern[n - 2], pattern[n - 1], pattern[n])];
+        if (list == NULL) {
+            /* Some trigram appears nowhere. */
+            g_ptr_array_free(lists, TRUE);
+            return candidates;
+        }
+        for (i = 0; i < lists->len; i++) {
+            if (g_ptr_array_index(lists, i) == list)
+                break;
+        }
+        if (i == lists->len)
+            g_ptr_array_add(lists, list);
+    }
+
+    /* Start from the shortest list and intersect it with the others. */
+    g_ptr_array_sort(lists, posting_list_compare_len);
+    list = (posting_list_t *)g_ptr_array_index(lists, 0);
+    for (offset = 0, frame = 0; offset < list->len; ) {
+        frame = posting_list_next(list, &offset, frame);
+        g_array_append_val(candidates, frame);
+    }
+
+    for (i = 1; i < lists->len && candidates->len > 0; i++) {
+        list = (posting_list_t *)g_ptr_array_index(lists, i);
+        offset = 0;
+        prev = 0;
+        frame = 0;
+        for (j = 0, k = 0; j < candidates->len; j++) {
+            guint32 candidate = g_array_index(candidates, guint32, j);
+
+            while (frame < candidate && offset < list->len)
+                frame = prev = posting_list_next(list, &offset, prev);
+            if (frame == candidate)
+                g_array_index(candidates, guint32, k++) = candidate;
+            else if (frame < candidate)
+                break;  /* The list is exhausted */
+        }
+        g_array_set_size(candidates, k);
+    }
+
+    g_ptr_array_free(lists, TRUE);
+    return candidates;
+}
+
+gsize
+search_index_size(const search_index_t *index)
+{
+    return index->size;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,106 @@
+/* search_index.h
+ * Trigram index of frame data for packet searches
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __SEARCH_INDEX_H__
+#define __SEARCH_INDEX_H__
+
+/** @file
+ *  Trigram index of the raw frame data, used to narrow down the frames
+ *  a byte or string search has to look at.
+ *  @ingroup main_ui_group
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <glib.h>
+
+/** The shortest pattern for which the index can return candidates. */
+#define SEARCH_INDEX_MIN_PATTERN_LEN 3
+
+typedef struct _search_index_t search_index_t;
+
+/** Create an empty index.
+ *
+ * @return A new index, to be freed with search_index_free().
+ */
+search_index_t *search_index_new(void);
+
+/** Free an index and its posting lists.
+ *
+ * @param index The index to free. May be NULL.
+ */
+void search_index_free(search_index_t *index);
+
+/** Add the data of a frame to the index. Frames must be added in
+ * increasing frame number order.
+ *
+ * ASCII letters are folded to upper case and trigrams are hashed into a
+ * fixed number of buckets, so the index only ever returns a superset of
+ * the frames containing a pattern; matches must still be checked.
+ *
+ * @param index The index.
+ * @param framenum The frame number.
+ * @param pd The frame data.
+ * @param len The length of the frame data.
+ */
+void search_index_add_frame(search_index_t *index, guint32 framenum,
+                            const guint8 *pd, guint32 len);
+
+/** Find the frames which may contain a byte pattern.
+ *
+ * @param index The index.
+ * @param pattern The pattern, in any case.
+ * @param len The length of the pattern.
+ * @return A sorted array of guint32 frame numbers, to be freed with
+ * g_array_free(), or NULL if the pattern is too short for the index to
+ * help (every frame is then a candidate).
+ */
+GArray *search_index_candidates(const search_index_t *index,
+                                const guint8 *pattern, size_t len);
+
+/** The amount of memory used by the posting lists, in bytes.
+ *
+ * @param index The index.
+ * @return The size of the index.
+ */
+gsize search_index_size(const search_index_t *index);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SEARCH_INDEX_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,191 @@
+/* search_index_test.c
+ * Tests for the trigram index of frame data
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <ui/search_index.h>
+
+static GArray *
+candidates_of(const search_index_t *index, const char *pattern)
+{
+    return search_index_candidates(index, (const guint8 *)pattern, strlen(pattern));
+}
+
+static void
+add_frame_str(search_index_t *index, guint32 framenum, const char *data)
+{
+    search_index_add_frame(index, framenum, (const guint8 *)data, (guint32)strlen(data));
+}
+
+/* Frame numbers whose deltas take one to five bytes must come back
+ * exactly from the posting list of a lone trigram. */
+static void
+search_index_test_posting_list(void)
+{
+    static const guint32 frames[] = {
+        1, 2, 3,                /* consecutive frames, one byte each */
+        130,                    /* delta 127, the largest one-byte delta */
+        258,                    /* delta 128, the smallest two-byte delta */
+        16642,                  /* delta 16384, three bytes */
+        2113794,                /* delta 2097152, four bytes */
+        270549250,              /* delta 268435456, five bytes */
+        G_MAXUINT32             /* the largest frame number */
+    };
+    search_index_t *index;
+    GArray *candidates;
+    guint i;
+
+    index = search_index_new();
+    for (i = 0; i < G_N_ELEMENTS(frames); i++) {
+        add_frame_str(index, frames[i], "xyz");
+    }
+
+    candidates = candidates_of(index, "xyz");
+    g_assert(candidates);
+    g_assert_cmpuint(candidates->len, ==, G_N_ELEMENTS(frames));
+    for (i = 0; i < G_N_ELEMENTS(frames); i++) {
+        g_assert_cmpuint(g_array_index(candidates, guint32, i), ==, frames[i]);
+    }
+    g_array_free(candidates, TRUE);
+
+    search_index_free(index);
+}
+
+/* A frame is only listed once however often a trigram appears in it. */
+static void
+search_index_test_repeats(void)
+{
+    search_index_t *index;
+    GArray *candidates;
+
+    index = search_index_new();
+    add_frame_str(index, 5, "abcabcabcabc");
+    add_frame_str(index, 6, "abc");
+
+    candidates = candidates_of(index, "abc");
+    g_assert(candidates);
+    g_assert_cmpuint(candidates->len, ==, 2);
+    g_assert_cmpuint(g_array_index(candidates, guint32, 0), ==, 5);
+    g_assert_cmpuint(g_array_index(candidates, guint32, 1), ==, 6);
+    g_array_free(candidates, TRUE);
+
+    search_index_free(index);
+}
+
+/* The candidates of a longer pattern are the frames having all of its
+ * trigrams; ASCII letters match in either case. */
+static void
+search_index_test_candidates(void)
+{
+    search_index_t *index;
+    GArray *candidates;
+    guint i, matches;
+
+    index = search_index_new();
+    for (i = 1; i <= 1000; i++) {
+        if (i % 3 == 0)
+            add_frame_str(index, i, "..HELLO world..");
+        else if (i % 3 == 1)
+            add_frame_str(index, i, "..hello..");
+        else
+            add_frame_str(index, i, "..world..");
+    }
+
+    candidates = candidates_of(index, "hello WORLD");
+    g_assert(candidates);
+    /* Hashing may add frames, but must never drop one that matches. */
+    for (i = 0, matches = 0; i < candidates->len; i++) {
+        if (i > 0) {
+            g_assert_cmpuint(g_array_index(candidates, guint32, i - 1), <,
+                             g_array_index(candidates, guint32, i));
+        }
+        if (g_array_index(candidates, guint32, i) % 3 == 0)
+            matches++;
+    }
+    g_assert_cmpuint(matches, ==, 333);
+    g_array_free(candidates, TRUE);
+
+    search_index_free(index);
+}
+
+/* Patterns too short for a trigram can't be looked up; patterns with a
+ * trigram found nowhere have no candidates. */
+static void
+search_index_test_edge_cases(void)
+{
+    search_index_t *index;
+    GArray *candidates;
+    gsize size;
+
+    index = search_index_new();
+    size = search_index_size(index);
+    g_assert_cmpuint(size, >, 0);
+
+    add_frame_str(index, 1, "abcdef");
+    g_assert_cmpuint(search_index_size(index), >, size);
+
+    g_assert(candidates_of(index, "ab") == NULL);
+    g_assert(candidates_of(index, "") == NULL);
+
+    candidates = candidates_of(index, "abc");
+    g_assert(candidates);
+    g_assert_cmpuint(candidates->len, ==, 1);
+    g_array_free(candidates, TRUE);
+
+    candidates = candidates_of(index, "qqq");
+    g_assert(candidates);
+    g_assert_cmpuint(candidates->len, ==, 0);
+    g_array_free(candidates, TRUE);
+
+    search_index_free(index);
+    search_index_free(NULL);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/search_index/posting_list", search_index_test_posting_list);
+    g_test_add_func("/search_index/repeats",      search_index_test_repeats);
+    g_test_add_func("/search_index/candidates",   search_index_test_candidates);
+    g_test_add_func("/search_index/edge_cases",   search_index_test_edge_cases);
+
+    return g_test_run();
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -305,6 +305,7 @@ time_shift_all(capture_file *cf, const gchar *offset_text)
             continue;   /* Shouldn't happen */
         modify_time_perform(fd, neg ? SHIFT_NEG : SHIFT_POS, &offset, SHIFT_KEEPOFFSET);
     }
+    cf->frame_tally.valid = FALSE;
     packet_list_queue_draw();
 
     return NULL;
@@ -349,7 +350,7 @@ time_shift_settime(capture_file *cf, guint packet_num, const gchar *time_text)
             continue;   /* Shouldn't happen */
         modify_time_perform(fd, SHIFT_POS, &diff_time, SHIFT_SETTOZERO);
     }
-
+    cf->frame_tally.valid = FALSE;
     packet_list_queue_draw();
     return NULL;
 }
@@ -432,7 +433,7 @@ time_shift_adjtime(capture_file *cf, guint packet1_num, const gchar *time1_text,
 
         modify_time_perform(fd, SHIFT_POS, &d3t, SHIFT_SETTOZERO);
     }
-
+    cf->frame_tally.valid = FALSE;
     packet_list_queue_draw();
     return NULL;
 }
@@ -457,6 +458,7 @@ time_shift_undo(capture_file *cf)
             continue;   /* Shouldn't happen */
         modify_time_perform(fd, SHIFT_NEG, &nulltime, SHIFT_SETTOZERO);
     }
+    cf->frame_tally.valid = FALSE;
     packet_list_queue_draw();
     return NULL;
 }
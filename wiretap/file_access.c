@@ -708,6 +708,73 @@ heuristic_uses_extension(unsigned int i, const char *extension)
 	return FALSE;	/* it's not one of them */
 }
 
+/*
+ * Magic numbers of the file types whose open routine rejects any file
+ * that doesn't start with one of them.  The start of the file is read
+ * once, and those open routines are only called if it matches one of
+ * their magic numbers, rather than each of them seeking back to the
+ * beginning and reading its own header, which is slow for compressed
+ * files.
+ *
+ * Open routines that aren't listed here, including the ones registered
+ * by plugins and Lua, are always called.
+ */
+static const struct {
+	wtap_open_routine_t open_routine;
+	guint               len;
+	const char         *magic;
+} open_magic_numbers[] = {
+	{ libpcap_open,       4, "\xa1\xb2\xc3\xd4" },
+	{ libpcap_open,       4, "\xd4\xc3\xb2\xa1" },
+	{ libpcap_open,       4, "\xa1\xb2\xcd\x34" },
+	{ libpcap_open,       4, "\x34\xcd\xb2\xa1" },
+	{ libpcap_open,       4, "\xa1\xb2\x3c\x4d" },
+	{ libpcap_open,       4, "\x4d\x3c\xb2\xa1" },
+	{ pcapng_open,        4, "\x0a\x0d\x0d\x0a" },
+	{ ngsniffer_open,    17, "TRSNIFF data    \x1a" },
+	{ snoop_open,         8, "snoop\0\0\0" },
+	{ netmon_open,        4, "RTSS" },
+	{ netmon_open,        4, "GMBU" },
+	{ netxray_open,       4, "XCP\0" },
+	{ netxray_open,       4, "VL\0\0" },
+	{ nettl_open,        12, "\x00\x00\x00\x01\x00\x00\x00\x00\x00\x07\xd0\x00" },
+	{ nettl_open,        12, "\x54\x52\x00\x64\x00\x00\x00\x00\x00\x00\x00\x80" },
+	{ visual_open,        4, "\x05VNF" },
+	{ capsa_open,         4, "cpse" },
+	{ aethra_open,        5, "V0208" },
+	{ btsnoop_open,       8, "btsnoop\0" },
+	{ eyesdn_open,        6, "EyeSDN" },
+	{ tnef_open,          4, "\x78\x9f\x3e\x22" },
+	{ mplog_open,         6, "MPCSII" }
+};
+
+/* Enough of the start of the file for the longest magic number above */
+#define OPEN_PEEK_LEN	17
+
+/*
+ * Returns FALSE if open_routine is known to reject a file starting with
+ * the "peek_len" bytes at "peek".
+ */
+static gboolean
+open_routine_may_match(wtap_open_routine_t open_routine, const guint8 *peek,
+    int peek_len)
+{
+	gboolean has_magic = FALSE;
+	size_t i;
+
+	for (i = 0; i < G_N_ELEMENTS(open_magic_numbers); i++) {
+		if (open_magic_numbers[i].open_routine != open_routine)
+			continue;
+		if ((guint)peek_len >= open_magic_numbers[i].len &&
+		    memcmp(peek, open_magic_numbers[i].magic,
+		      open_magic_numbers[i].len) == 0)
+			return TRUE;
+		has_magic = TRUE;
+	}
+
+	return !has_magic;
+}
+
 /* Opens a file and prepares a wtap struct.
    If "do_random" is TRUE, it opens the file twice; the second open
    allows the application to do random-access I/O without moving
@@ -726,6 +793,8 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 	gboolean use_stdin = FALSE;
 	gchar *extension;
 	wtap_block_t shb;
+	guint8	peek[OPEN_PEEK_LEN];
+	int	peek_len;
 
 	*err = 0;
 	*err_info = NULL;
@@ -894,8 +963,22 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 		}
 	}
 
+	/* Read the start of the file, to skip the file types whose magic
+	   numbers it doesn't match.  A short read just means a short file;
+	   the seek back to the beginning below stays within the buffer. */
+	peek_len = file_read(peek, OPEN_PEEK_LEN, wth->fh);
+	if (peek_len < 0) {
+		*err = file_error(wth->fh, err_info);
+		wtap_close(wth);
+		return NULL;
+	}
+
 	/* Try all file types that support magic numbers */
 	for (i = 0; i < heuristic_open_routine_idx; i++) {
+		if (!open_routine_may_match(open_routines[i].open_routine,
+		    peek, peek_len))
+			continue;
+
 		/* Seek back to the beginning of the file; the open routine
 		   for the previous file type may have left the file
 		   position somewhere other than the beginning, and the
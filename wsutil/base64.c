@@ -22,46 +22,176 @@
 
 #include "config.h"
 
+/* see bug 10798 and ws_mempbrk.c */
+#ifdef __APPLE__
+#if defined(__clang__) && (__clang_major__ >= 6)
+#else
+#undef HAVE_SSE4_2
+#endif
+#endif
+
 #include <string.h>
+#include <glib.h>
 #include "base64.h"
+#include "base64_int.h"
+
+#ifdef HAVE_SSE4_2
+#include "ws_cpuid.h"
+
+static int base64_use_sse42 = -1;
+
+static gboolean
+base64_sse42_ok(void)
+{
+	if (base64_use_sse42 == -1)
+		base64_use_sse42 = ws_cpuid_sse42() ? 1 : 0;
+	return base64_use_sse42 == 1;
+}
+#endif
+
+#define B64_INVALID	0xFF	/* ends the data */
+#define B64_SKIP	0xFE	/* CR and LF are allowed, but ignored */
 
-/* Decode a base64 string in-place - simple and slow algorithm.
-   Return length of result. Taken from rproxy/librsync/base64.c by
-   Andrew Tridgell. */
+/* Map from characters to their 6-bit value */
+static const guint8 b64_to_sextet[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   62, 0xFF, 0xFF, 0xFF,   63,
+	  52,   53,   54,   55,   56,   57,   58,   59,   60,   61, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+	  15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+	  41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/* Map from characters to their hex value, or -1 */
+static const gint8 b16_to_nibble[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/* Decode a base64 string in-place. Return length of result.
+ *
+ * Decoding stops at the first character that isn't part of the base64
+ * alphabet (typically the '=' padding or the terminating NUL); CR and LF
+ * are skipped. Runs of complete quantums are decoded a block at a time,
+ * with SSE4.2 where available; the output always trails the input, so
+ * this is safe in place. */
 
 size_t ws_base64_decode_inplace(char *s)
 {
-	static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/\r\n";
-	int bit_offset, byte_offset, idx, i;
-	unsigned char *d = (unsigned char *)s;
-	char *p;
-	int  cr_idx;
-
-	/* we will allow CR and LF - but ignore them */
-	cr_idx = (int) (strchr(b64, '\r') - b64);
-
-	i = 0;
-
-	while (*s && (p=strchr(b64, *s))) {
-		idx = (int)(p - b64);
-		if(idx < cr_idx) {
-			byte_offset = (i*6)/8;
-			bit_offset = (i*6)%8;
-			d[byte_offset] &= ~((1<<(8-bit_offset))-1);
-			if (bit_offset < 3) {
-				d[byte_offset] |= (idx << (2-bit_offset));
-			} else {
-				d[byte_offset] |= (idx >> (bit_offset-2));
-				d[byte_offset+1] = 0;
-				d[byte_offset+1] |= (idx << (8-(bit_offset-2))) & 0xFF;
+	const guint8 *src = (const guint8 *)s;
+	const guint8 *end = src + strlen(s);
+	guint8 *d = (guint8 *)s;
+	size_t out = 0;
+	guint32 acc = 0;
+	int n = 0;	/* sextets in acc */
+	guint8 v;
+
+	while (src < end) {
+		if (n == 0) {
+#ifdef HAVE_SSE4_2
+			if (end - src >= 16 && base64_sse42_ok()) {
+				size_t done = ws_base64_decode_sse42(src, (size_t)(end - src), d + out);
+
+				src += done;
+				out += done / 4 * 3;
+			}
+#endif
+			/* whole quantums without line breaks */
+			while (end - src >= 4) {
+				guint8 a = b64_to_sextet[src[0]];
+				guint8 b = b64_to_sextet[src[1]];
+				guint8 c = b64_to_sextet[src[2]];
+				guint8 e = b64_to_sextet[src[3]];
+
+				if ((a | b | c | e) & 0xC0)
+					break;
+				d[out++] = (guint8)(a << 2 | b >> 4);
+				d[out++] = (guint8)(b << 4 | c >> 2);
+				d[out++] = (guint8)(c << 6 | e);
+				src += 4;
 			}
-			i++;
+			if (src == end)
+				break;
 		}
-		s++;
+
+		v = b64_to_sextet[*src++];
+		if (v == B64_INVALID)
+			break;
+		if (v == B64_SKIP)
+			continue;
+		acc = acc << 6 | v;
+		if (++n == 4) {
+			d[out++] = (guint8)(acc >> 16);
+			d[out++] = (guint8)(acc >> 8);
+			d[out++] = (guint8)acc;
+			n = 0;
+		}
+	}
+
+	/* trailing partial quantum */
+	if (n == 2) {
+		d[out++] = (guint8)(acc >> 4);
+	} else if (n == 3) {
+		d[out++] = (guint8)(acc >> 10);
+		d[out++] = (guint8)(acc >> 2);
+	}
+
+	d[out] = 0;
+	return out;
+}
+
+/* Decode pairs of hex digits (base16). Return the number of bytes written;
+ * twice that many characters were consumed. */
+
+size_t ws_base16_decode(const char *s, size_t len, guint8 *d)
+{
+	const guint8 *src = (const guint8 *)s;
+	size_t out = 0;
+	gint8 hi, lo;
+
+#ifdef HAVE_SSE4_2
+	if (len >= 32 && base64_sse42_ok()) {
+		out = ws_base16_decode_sse42(src, len, d);
+		src += out * 2;
+		len -= out * 2;
+	}
+#endif
+
+	while (len >= 2) {
+		hi = b16_to_nibble[src[0]];
+		lo = b16_to_nibble[src[1]];
+		if ((hi | lo) < 0)
+			break;
+		d[out++] = (guint8)(hi << 4 | lo);
+		src += 2;
+		len -= 2;
 	}
 
-	d[i*3/4] = 0;
-	return i*3/4;
+	return out;
 }
 
 /*
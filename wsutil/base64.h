@@ -22,6 +22,7 @@
 #ifndef __BASE64_H__
 #define __BASE64_H__
 
+#include <glib.h>
 #include "ws_symbol_export.h"
 
 #ifdef __cplusplus
@@ -32,6 +33,12 @@ extern "C" {
 WS_DLL_PUBLIC
 size_t ws_base64_decode_inplace(char *s);
 
+/* Decoding of a string of hex digits (base16, without separators) into dst,
+ * which must have room for len / 2 bytes. Decoding stops at the first
+ * character that isn't a hex digit. Returns the number of bytes written. */
+WS_DLL_PUBLIC
+size_t ws_base16_decode(const char *s, size_t len, guint8 *dst);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
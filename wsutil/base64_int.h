@@ -0,0 +1,36 @@
+/* base64_int.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __BASE64_INT_H__
+#define __BASE64_INT_H__
+
+#ifdef HAVE_SSE4_2
+/* Decode whole 16-character blocks of base64 (without line breaks or
+ * padding); return the number of characters consumed. 16 bytes are stored
+ * for each 12 decoded, so this may only be used in place. */
+size_t ws_base64_decode_sse42(const guint8 *src, size_t len, guint8 *dst);
+
+/* Decode whole 32-character blocks of hex digits; return the number of
+ * bytes written. */
+size_t ws_base16_decode_sse42(const guint8 *src, size_t len, guint8 *dst);
+#endif
+
+#endif /* __BASE64_INT_H__ */
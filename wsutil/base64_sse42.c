@@ -0,0 +1,145 @@
+/* base64_sse42.c
+ * SSE4.2 base64 and base16 decoding
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <glib.h>
+
+#ifdef _WIN32
+  #include <tmmintrin.h>
+#endif
+
+#include <nmmintrin.h>
+#include "base64_int.h"
+
+/*
+ * Base64: translate 16 characters at a time to their 6-bit values with
+ * nibble lookups, then pack the sextets into 12 bytes. See Wojciech Mula,
+ * "Base64 decoding with SIMD instructions",
+ * http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html
+ */
+size_t
+ws_base64_decode_sse42(const guint8 *src, size_t len, guint8 *dst)
+{
+	const __m128i lut_lo = _mm_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lut_hi = _mm_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lut_roll = _mm_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71,
+		0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask_2f = _mm_set1_epi8(0x2f);
+	const __m128i pack_ab = _mm_set1_epi32(0x01400140);
+	const __m128i pack_abcd = _mm_set1_epi32(0x00011000);
+	const __m128i reorder = _mm_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9,
+		8, 14, 13, 12, -1, -1, -1, -1);
+	size_t done = 0;
+
+	while (len - done >= 16) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(const void *)(src + done));
+		__m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+		__m128i lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(in, mask_2f));
+		__m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+		__m128i eq_2f = _mm_cmpeq_epi8(in, mask_2f);
+		__m128i roll;
+
+		/* a character outside of the alphabet ends the fast path */
+		if (!_mm_testz_si128(lo, hi))
+			break;
+
+		roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+		in = _mm_add_epi8(in, roll);
+
+		in = _mm_maddubs_epi16(in, pack_ab);
+		in = _mm_madd_epi16(in, pack_abcd);
+		in = _mm_shuffle_epi8(in, reorder);
+
+		_mm_storeu_si128((__m128i *)(void *)(dst + done / 4 * 3), in);
+		done += 16;
+	}
+
+	return done;
+}
+
+/*
+ * Base16: check and convert 32 hex digits at a time, then merge the
+ * nibble pairs into 16 bytes.
+ */
+size_t
+ws_base16_decode_sse42(const guint8 *src, size_t len, guint8 *dst)
+{
+	const __m128i below_0 = _mm_set1_epi8('0' - 1);
+	const __m128i above_9 = _mm_set1_epi8('9' + 1);
+	const __m128i below_a = _mm_set1_epi8('a' - 1);
+	const __m128i above_f = _mm_set1_epi8('f' + 1);
+	const __m128i lower = _mm_set1_epi8(0x20);
+	const __m128i digit_base = _mm_set1_epi8('0');
+	const __m128i alpha_base = _mm_set1_epi8('a' - 10);
+	const __m128i merge = _mm_set1_epi16(0x0110);
+	size_t out = 0;
+	int i;
+
+	while (len - out * 2 >= 32) {
+		__m128i words[2];
+
+		for (i = 0; i < 2; i++) {
+			__m128i in = _mm_loadu_si128((const __m128i *)(const void *)(src + out * 2 + i * 16));
+			__m128i lc = _mm_or_si128(in, lower);
+			/* bytes >= 0x80 are negative, and so never in range */
+			__m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(in, below_0), _mm_cmplt_epi8(in, above_9));
+			__m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lc, below_a), _mm_cmplt_epi8(lc, above_f));
+
+			if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xFFFF)
+				return out;
+
+			in = _mm_or_si128(_mm_and_si128(is_digit, _mm_sub_epi8(in, digit_base)),
+					  _mm_and_si128(is_alpha, _mm_sub_epi8(lc, alpha_base)));
+			/* high nibble * 16 + low nibble */
+			words[i] = _mm_maddubs_epi16(in, merge);
+		}
+
+		_mm_storeu_si128((__m128i *)(void *)(dst + out), _mm_packus_epi16(words[0], words[1]));
+		out += 16;
+	}
+
+	return out;
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,326 @@
+/* base64_test.c
+ * Tests for the base64 and base16 decoders
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+/* see bug 10798 and ws_mempbrk.c */
+#ifdef __APPLE__
+#if defined(__clang__) && (__clang_major__ >= 6)
+#else
+#undef HAVE_SSE4_2
+#endif
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "base64.h"
+#include "base64_int.h"
+
+#ifdef HAVE_SSE4_2
+#include "ws_cpuid.h"
+#endif
+
+/* Longest input; covers several 16-character base64 blocks and
+ * 32-digit base16 blocks. */
+#define MAX_LEN 100
+
+static const char b64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char b16_alphabet[] = "0123456789abcdefABCDEF";
+
+/* Characters just outside of the ranges that make up each alphabet */
+static const char b64_invalid[] = "=*,-.:@[`{ \x7f\x80\xff";
+static const char b16_invalid[] = "/:@G`g \x7f\x80\xff";
+
+static GRand *test_rand;
+
+static void
+random_string(char *s, size_t len, const char *alphabet)
+{
+    size_t n = strlen(alphabet);
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        s[i] = alphabet[g_rand_int_range(test_rand, 0, (gint32)n)];
+    }
+    s[len] = '\0';
+}
+
+/* Decode the first len characters one sextet at a time, the way the
+ * decoder did before it was table driven. */
+static size_t
+ref_base64_decode(const char *s, size_t len, guint8 *d)
+{
+    size_t i, out = 0;
+    guint32 acc = 0;
+    int n = 0;
+
+    for (i = 0; i < len; i++) {
+        const char *p = s[i] ? strchr(b64_alphabet, s[i]) : NULL;
+
+        if (!p)
+            break;
+        acc = acc << 6 | (guint32)(p - b64_alphabet);
+        if (++n == 4) {
+            d[out++] = (guint8)(acc >> 16);
+            d[out++] = (guint8)(acc >> 8);
+            d[out++] = (guint8)acc;
+            n = 0;
+        }
+    }
+    if (n == 2) {
+        d[out++] = (guint8)(acc >> 4);
+    } else if (n == 3) {
+        d[out++] = (guint8)(acc >> 10);
+        d[out++] = (guint8)(acc >> 2);
+    }
+    return out;
+}
+
+static size_t
+ref_base16_decode(const char *s, size_t len, guint8 *d)
+{
+    size_t out = 0;
+
+    for (; len >= 2 && g_ascii_isxdigit(s[0]) && g_ascii_isxdigit(s[1]); s += 2, len -= 2) {
+        d[out++] = (guint8)(g_ascii_xdigit_value(s[0]) << 4 | g_ascii_xdigit_value(s[1]));
+    }
+    return out;
+}
+
+/* Insert a CRLF after every 15 characters. The line breaks are skipped
+ * by the scalar decoder, but stop every SIMD block, so this decodes all
+ * of s without SSE4.2. */
+static char *
+with_line_breaks(const char *s)
+{
+    GString *str = g_string_new(NULL);
+    size_t i;
+
+    for (i = 0; s[i]; i++) {
+        if (i > 0 && i % 15 == 0)
+            g_string_append(str, "\r\n");
+        g_string_append_c(str, s[i]);
+    }
+    return g_string_free(str, FALSE);
+}
+
+/* Decode s with the decoder, and with the decoder kept to its scalar
+ * path, and check both against the reference. */
+static void
+check_base64(const char *s, size_t len)
+{
+    guint8 expected[MAX_LEN];
+    size_t expected_len;
+    char *buf, *broken;
+
+    expected_len = ref_base64_decode(s, len, expected);
+
+    buf = g_strdup(s);
+    g_assert_cmpuint(ws_base64_decode_inplace(buf), ==, expected_len);
+    g_assert(memcmp(buf, expected, expected_len) == 0);
+    g_assert_cmpint(buf[expected_len], ==, '\0');
+    g_free(buf);
+
+    broken = with_line_breaks(s);
+    g_assert_cmpuint(ws_base64_decode_inplace(broken), ==, expected_len);
+    g_assert(memcmp(broken, expected, expected_len) == 0);
+    g_free(broken);
+}
+
+static void
+check_base16(const char *s, size_t len)
+{
+    guint8 expected[MAX_LEN], out[MAX_LEN];
+    size_t expected_len, out_len, chunk, n;
+
+    expected_len = ref_base16_decode(s, len, expected);
+
+    g_assert_cmpuint(ws_base16_decode(s, len, out), ==, expected_len);
+    g_assert(memcmp(out, expected, expected_len) == 0);
+
+    /* Pieces shorter than a SIMD block are decoded by the scalar path */
+    for (out_len = 0; len - out_len * 2 >= 2; out_len += n) {
+        chunk = MIN(len - out_len * 2, 30);
+        n = ws_base16_decode(s + out_len * 2, chunk, out + out_len);
+        if (n < chunk / 2) {
+            out_len += n;
+            break;
+        }
+    }
+    g_assert_cmpuint(out_len, ==, expected_len);
+    g_assert(memcmp(out, expected, expected_len) == 0);
+}
+
+static void
+base64_test_valid(void)
+{
+    char s[MAX_LEN + 2];
+    size_t len;
+
+    for (len = 0; len <= MAX_LEN; len++) {
+        random_string(s, len, b64_alphabet);
+        check_base64(s, len);
+
+        /* padding ends the data */
+        s[len] = '=';
+        s[len + 1] = '\0';
+        check_base64(s, len + 1);
+    }
+}
+
+static void
+base64_test_invalid(void)
+{
+    static const size_t lengths[] = { 15, 16, 17, 31, 32, 33, 47, 48, 49, 63, 64, 65 };
+    char s[MAX_LEN + 1];
+    size_t i, j, pos;
+
+    for (i = 0; i < G_N_ELEMENTS(lengths); i++) {
+        for (j = 0; b64_invalid[j]; j++) {
+            for (pos = 0; pos < lengths[i]; pos++) {
+                random_string(s, lengths[i], b64_alphabet);
+                s[pos] = b64_invalid[j];
+                check_base64(s, lengths[i]);
+            }
+        }
+    }
+}
+
+static void
+base16_test_valid(void)
+{
+    char s[MAX_LEN + 1];
+    size_t len;
+
+    for (len = 0; len <= MAX_LEN; len++) {
+        random_string(s, len, b16_alphabet);
+        check_base16(s, len);
+    }
+}
+
+static void
+base16_test_invalid(void)
+{
+    static const size_t lengths[] = { 31, 32, 33, 34, 63, 64, 65, 66, 96, 98 };
+    char s[MAX_LEN + 1];
+    size_t i, j, pos;
+
+    for (i = 0; i < G_N_ELEMENTS(lengths); i++) {
+        for (j = 0; b16_invalid[j]; j++) {
+            for (pos = 0; pos < lengths[i]; pos++) {
+                random_string(s, lengths[i], b16_alphabet);
+                s[pos] = b16_invalid[j];
+                check_base16(s, lengths[i]);
+            }
+        }
+    }
+}
+
+#ifdef HAVE_SSE4_2
+/* The SIMD block decoders must stop at the block holding the first
+ * character outside of the alphabet, and agree with the reference on
+ * everything before it. */
+static void
+base64_test_sse42_blocks(void)
+{
+    guint8 expected[MAX_LEN], buf[MAX_LEN + 16];
+    char s[MAX_LEN + 1];
+    size_t len, pos, done;
+
+    for (len = 0; len <= MAX_LEN; len++) {
+        for (pos = 0; pos <= len; pos++) {
+            random_string(s, len, b64_alphabet);
+            if (pos < len)
+                s[pos] = b64_invalid[pos % (sizeof b64_invalid - 1)];
+
+            memcpy(buf, s, len);
+            done = ws_base64_decode_sse42(buf, len, buf);
+            g_assert_cmpuint(done, ==, pos / 16 * 16);
+            g_assert_cmpuint(ref_base64_decode(s, done, expected), ==, done / 4 * 3);
+            g_assert(memcmp(buf, expected, done / 4 * 3) == 0);
+        }
+    }
+}
+
+static void
+base16_test_sse42_blocks(void)
+{
+    guint8 expected[MAX_LEN], out[MAX_LEN];
+    char s[MAX_LEN + 1];
+    size_t len, pos, n;
+
+    for (len = 0; len <= MAX_LEN; len++) {
+        for (pos = 0; pos <= len; pos++) {
+            random_string(s, len, b16_alphabet);
+            if (pos < len)
+                s[pos] = b16_invalid[pos % (sizeof b16_invalid - 1)];
+
+            n = ws_base16_decode_sse42((const guint8 *)s, len, out);
+            g_assert_cmpuint(n, ==, pos / 32 * 16);
+            g_assert_cmpuint(ref_base16_decode(s, n * 2, expected), ==, n);
+            g_assert(memcmp(out, expected, n) == 0);
+        }
+    }
+}
+#endif
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    g_test_init(&argc, &argv, NULL);
+    test_rand = g_rand_new_with_seed(42);
+
+    g_test_add_func("/base64/valid",   base64_test_valid);
+    g_test_add_func("/base64/invalid", base64_test_invalid);
+    g_test_add_func("/base16/valid",   base16_test_valid);
+    g_test_add_func("/base16/invalid", base16_test_invalid);
+#ifdef HAVE_SSE4_2
+    if (ws_cpuid_sse42()) {
+        g_test_add_func("/base64/sse42_blocks", base64_test_sse42_blocks);
+        g_test_add_func("/base16/sse42_blocks", base16_test_sse42_blocks);
+    }
+#endif
+
+    ret = g_test_run();
+
+    g_rand_free(test_rand);
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */